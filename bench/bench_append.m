@@ -0,0 +1,35 @@
+## Benchmark: sustained append throughput of small blocks
+## (a data logger at a fixed block size), h5append vs. h5write
+## extending the dataset by one block per call.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_append.m
+
+nch = 8;          # channels
+nblocks = 5000;   # blocks per run
+printf("%8s %-8s %10s %12s\n", "block", "method", "blocks/s", "MB/s");
+for bs = [1 10 100]
+  x = rand(nch, bs*nblocks);
+  nbytes = numel(x)*8;
+  for method = {"h5write", "h5append"}
+    fname = [tempname() ".h5"];
+    h5create(fname,'/D',[nch Inf],'ChunkSize',[nch 1024]);
+    h5open(fname,'r+');
+    tic;
+    for k = 1:nblocks
+      blk = x(:, (k-1)*bs+1 : k*bs);
+      if strcmp(method{1}, "h5write")
+        h5write(fname,'/D',blk,[1 (k-1)*bs+1],[nch bs]);
+      else
+        h5append(fname,'/D',blk);
+      endif
+    endfor
+    h5flush(fname);
+    t = toc;
+    h5close(fname);
+    assert (isequal (h5read(fname,'/D'), x));
+    delete(fname);
+    printf("%8d %-8s %10.0f %12.2f\n", bs, method{1}, nblocks/t, nbytes/t/2^20);
+  endfor
+endfor
@@ -0,0 +1,38 @@
+## Benchmark: acquisition loop computing frames and writing them to a
+## compressed dataset, with synchronous and asynchronous h5write.
+## With 'Async' the compression and I/O run in the background,
+## overlapping with the computation of the next frame.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_async.m
+
+n = 512; nframes = 100;
+[X,Y] = meshgrid(1:n);
+
+function f = compute_frame(X, Y, k)
+  # some work per frame, comparable to writing it
+  f = single(sin(X/(10+k)) .* cos(Y/(20+k)) + 0.1*randn(size(X)));
+  f = f + single(conv2(double(f), ones(5)/25, 'same'));
+endfunction
+
+printf("%-8s %10s %10s %10s\n", "mode", "total s", "compute s", "frames/s");
+modes = {"sync", "async"};
+for async = [false true]
+  fname = [tempname() ".h5"];
+  h5create(fname,'/D',[n Inf],'Datatype','single','ChunkSize',[n n],'Deflate',6);
+  h5open(fname,'r+');
+  tc = 0;
+  tic;
+  for k = 1:nframes
+    t0 = tic;
+    f = compute_frame(X, Y, k);
+    tc += toc(t0);
+    h5write(fname,'/D',f,[1 (k-1)*n+1],[n n],'Async',async);
+  endfor
+  h5flush(fname);
+  t = toc;
+  h5close(fname);
+  delete(fname);
+  printf("%-8s %10.2f %10.2f %10.1f\n", modes{async+1}, t, tc, nframes/t);
+endfor
@@ -0,0 +1,55 @@
+## Benchmark: read throughput of hyperslabs for automatically selected
+## chunk shapes ('ChunkSize','auto') against naive ones.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_autochunk.m
+
+n = 4096;
+x = rand(n,'single');
+nrd = 64;
+idx = randperm(n, nrd);
+
+shapes = {"contiguous", {}; ...
+          "[1 n]", {'ChunkSize',[1 n]}; ...
+          "[n 1]", {'ChunkSize',[n 1]}; ...
+          "[16 16]", {'ChunkSize',[16 16]}; ...
+          "auto", {'ChunkSize','auto'}; ...
+          "auto, row", {'ChunkAccess','row'}; ...
+          "auto, column", {'ChunkAccess','column'}; ...
+          "auto, 4 MiB", {'ChunkBytes',2^22}};
+
+printf("%-14s %-12s %10s %10s %10s\n", "chunks", "ChunkSize", ...
+       "rows MB/s", "cols MB/s", "tiles MB/s");
+for i = 1:rows(shapes)
+  fname = [tempname() ".h5"];
+  h5create(fname,'/D',size(x),'Datatype','single',shapes{i,2}{:});
+  h5write(fname,'/D',x);
+  cs = h5info(fname,'/D').ChunkSize;
+  h5close(fname);
+
+  # rows x(i,:)
+  tic;
+  for k = 1:nrd, y = h5read(fname,'/D',[idx(k) 1],[1 n]); endfor
+  tr = toc;
+  h5close(fname);
+  # columns x(:,j)
+  tic;
+  for k = 1:nrd, y = h5read(fname,'/D',[1 idx(k)],[n 1]); endfor
+  tc = toc;
+  h5close(fname);
+  # 256x256 tiles
+  tic;
+  for k = 1:nrd
+    s = 1 + 256*floor((idx(k)-1)/256);
+    y = h5read(fname,'/D',[s s],[256 256]);
+  endfor
+  tt = toc;
+  h5close(fname);
+  delete(fname);
+
+  lbl = "-";
+  if !isempty(cs), lbl = mat2str(double(cs)); endif
+  printf("%-14s %-12s %10.1f %10.1f %10.1f\n", shapes{i,1}, lbl, ...
+         nrd*n*4/tr/1e6, nrd*n*4/tc/1e6, nrd*256*256*4/tt/1e6);
+endfor
@@ -0,0 +1,47 @@
+## Benchmark: full scan of a compressed dataset, reducing each block,
+## with h5blocks (chunk-aligned, prefetched) vs. a loop of h5read calls
+## on hand-computed hyperslabs that are not aligned to the chunks.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_blocks.m
+
+n = 1000; m = 20000;           # 160 MB of doubles
+fname = [tempname() ".h5"];
+h5create(fname,'/D',[n m],'ChunkSize',[n 256],'Deflate',4);
+for k = 1:2000:m
+  h5write(fname,'/D',rand(n, 2000),[1 k],[n 2000]);
+endfor
+h5close(fname);
+nbytes = n*m*8;
+
+function s = work(x)
+  # per-block processing, comparable to reading it
+  s = sum(sort(x, 1)(end, :));
+endfunction
+
+# naive loop: blocks of 1000 columns
+tic;
+s0 = 0;
+for k = 1:1000:m
+  s0 += work(h5read(fname,'/D',[1 k],[n min(1000, m-k+1)]));
+endfor
+t0 = toc;
+
+# h5blocks: 4 chunks = 1024 columns per block
+tic;
+s1 = 0;
+it = h5blocks(fname,'/D',2,1000);
+while it.hasNext()
+  s1 += work(it.next());
+endwhile
+t1 = toc;
+assert (abs(s1 - s0) < 1e-6*abs(s0));
+
+h5close(fname);
+delete(fname);
+
+printf("scan of a %d x %d deflate-compressed dataset (%.0f MB)\n", n, m, nbytes/2^20);
+printf("  h5read loop : %6.2f s  %8.1f MB/s\n", t0, nbytes/t0/2^20);
+printf("  h5blocks    : %6.2f s  %8.1f MB/s\n", t1, nbytes/t1/2^20);
+printf("  speedup     : %6.2f x\n", t0/t1);
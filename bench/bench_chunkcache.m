@@ -0,0 +1,35 @@
+## Benchmark: reading rows of a compressed, chunked dataset one at a time,
+## with the default HDF5 chunk cache (1 MiB) and with 'ChunkCache','auto'.
+##
+## Each row crosses 16 chunks of 256 KiB. With the default cache only
+## 4 of them fit, so each row read decompresses all 16 chunks again.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_chunkcache.m
+
+fname = [tempname() ".h5"];
+n = 4096;
+x = single(reshape(1:n*n, n, n));
+h5create(fname,'/D',size(x),'Datatype','single','ChunkSize',[256 256],'Deflate',4);
+h5write(fname,'/D',x);
+h5close(fname);
+
+nrows = 256;
+printf("%-22s %12s\n", "ChunkCache", "ms/row");
+for cache = {[], 'auto', [64*2^20]}
+  c = cache{1};
+  h5close(fname); # start with a fresh dataset handle
+  tic;
+  for i=1:nrows
+    y = h5read(fname,'/D',[i 1],[1 n],'ChunkCache',c);
+  endfor
+  t = toc;
+  info = h5info(fname,'/D');
+  if isempty(c), lbl = "default"; elseif ischar(c), lbl = c; else lbl = num2str(c); endif
+  printf("%-22s %12.3f   (cache: %d bytes, %d slots)\n", lbl, 1e3*t/nrows, ...
+         info.ChunkCache.Size, info.ChunkCache.Slots);
+endfor
+
+h5close(fname);
+delete(fname);
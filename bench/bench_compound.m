@@ -0,0 +1,42 @@
+## Benchmark: reading a wide compound table (64 double columns) in
+## full and with the 'Fields' option selecting a few columns.
+##
+## hdf5oct does not write compound datasets; the table is created
+## with h5py, which must be importable by python3.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_compound.m
+
+fname = [tempname() ".h5"];
+nrows = 1e6;
+ncols = 64;
+pyfile = [tempname() ".py"];
+fid = fopen(pyfile, "w");
+fprintf(fid, "import h5py, numpy as np\n");
+fprintf(fid, "dt = np.dtype([('c' + str(k), 'f8') for k in range(%d)])\n", ncols);
+fprintf(fid, "a = np.zeros(%d, dtype=dt)\n", nrows);
+fprintf(fid, "for k in range(%d): a['c' + str(k)] = np.arange(%d) + k\n", ncols, nrows);
+fprintf(fid, "h5py.File('%s', 'w').create_dataset('T', data=a)\n", fname);
+fclose(fid);
+[st, out] = system(["python3 " pyfile]);
+delete(pyfile);
+if st
+  error("bench_compound: cannot create the table with h5py:\n%s", out);
+endif
+
+printf("%d rows x %d columns, %.0f MB\n", nrows, ncols, nrows*ncols*8/2^20);
+printf("%10s %12s %12s\n", "columns", "time", "MB/s");
+for k = [ncols 16 4 1]
+  fields = arrayfun(@(j) sprintf("c%d", j), 0:k-1, 'UniformOutput', false);
+  if k == ncols
+    tic; s = h5read(fname,'/T'); t = toc;
+  else
+    tic; s = h5read(fname,'/T','Fields',fields); t = toc;
+  endif
+  assert (s.(fields{end})(end), nrows - 1 + k - 1);
+  printf("%10d %10.3f s %12.1f\n", k, t, nrows*k*8/2^20/t);
+endfor
+
+h5close(fname);
+delete(fname);
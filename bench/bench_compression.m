@@ -0,0 +1,32 @@
+## Benchmark: write throughput vs. compression ratio for the
+## Deflate/Shuffle filters of h5create.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_compression.m
+
+# detector-like data: smooth background + noise, stored as int16
+n = 2048;
+[X,Y] = meshgrid(1:n);
+x = int16(1000*exp(-((X-n/2).^2+(Y-n/2).^2)/(n/4)^2) + 20*randn(n));
+nbytes = numel(x)*2;
+
+printf("%-22s %10s %10s %8s\n", "filters", "write MB/s", "read MB/s", "ratio");
+for shuffle = [false true]
+  for level = [0 1 4 6 9]
+    if level==0 && shuffle, continue; endif
+    fname = [tempname() ".h5"];
+    h5create(fname,'/D',size(x),'Datatype','int16','ChunkSize',[n 64],...
+             'Deflate',level,'Shuffle',shuffle);
+    tic; h5write(fname,'/D',x); tw = toc;
+    h5close(fname); # measure the read from disk, not from the HDF5 cache
+    tic; y = h5read(fname,'/D'); tr = toc;
+    assert(isequal(x,y));
+    h5close(fname);
+    s = stat(fname);
+    delete(fname);
+    lbl = sprintf("deflate=%d%s", level, {"", " +shuffle"}{shuffle+1});
+    printf("%-22s %10.1f %10.1f %8.2f\n", lbl, nbytes/tw/1e6, nbytes/tr/1e6, nbytes/s.size);
+  endfor
+endfor
+
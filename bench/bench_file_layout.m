@@ -0,0 +1,50 @@
+## Benchmark: h5info and random small reads on a file with many small
+## datasets, created with the default file properties and with paged
+## aggregation, the latest file format and larger metadata blocks.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_file_layout.m
+
+ngroups = 20;
+nper = 500;     # datasets per group
+nreads = 2000;
+layouts = {"default", {};
+           "tuned",   {'FileSpaceStrategy', 'page', 'FileSpacePageSize', 65536, ...
+                       'LatestFormat', true, 'MetadataBlockSize', 65536}};
+names = cell(ngroups*nper, 1);
+for g = 1:ngroups
+  for d = 1:nper
+    names{(g-1)*nper+d} = sprintf('/G%03d/D%04d', g, d);
+  endfor
+endfor
+order = randi(numel(names), nreads, 1);
+
+printf("%d datasets in %d groups\n", numel(names), ngroups);
+printf("%10s %10s %10s %10s %10s\n", "layout", "create", "h5info", "reads", "file MB");
+for k = 1:rows(layouts)
+  fname = [tempname() ".h5"];
+  tic;
+  props = layouts{k,2};
+  h5create(fname, names{1}, [1 16], props{:});
+  h5open(fname, 'r+');
+  h5write(fname, names{1}, rand(1,16));
+  for i = 2:numel(names)
+    h5create(fname, names{i}, [1 16]);
+    h5write(fname, names{i}, rand(1,16));
+  endfor
+  h5close(fname);
+  tc = toc;
+
+  tic; info = h5info(fname); ti = toc;
+  h5close(fname);
+  tic;
+  for i = order'
+    x = h5read(fname, names{i});
+  endfor
+  tr = toc;
+  h5close(fname);
+  d = dir(fname);
+  printf("%10s %8.2f s %8.3f s %8.3f s %10.1f\n", layouts{k,1}, tc, ti, tr, d.bytes/2^20);
+  delete(fname);
+endfor
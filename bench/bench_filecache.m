@@ -0,0 +1,40 @@
+## Benchmark: per-call latency of many small reads from the same file,
+## with and without the hdf5oct file cache.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_filecache.m
+
+fname = [tempname() ".h5"];
+N = 10000;
+x = reshape(1:1e6, 1000, 1000);
+h5create(fname,'/D1',size(x));
+h5write(fname,'/D1',x);
+
+# random 1x10 hyperslabs
+idx = randi(size(x,1), N, 1);
+count = [1; 10];
+
+function t = time_reads(fname, idx, count)
+  tic;
+  for i=1:numel(idx)
+    __h5read__(fname,'/D1',[idx(i); 1],count,[],struct());
+  endfor
+  t = toc;
+endfunction
+
+n = h5filecache ();
+
+h5filecache (0); # no caching: open & close on every call
+t0 = time_reads(fname, idx, count);
+
+h5filecache (n); # default: files stay open
+t1 = time_reads(fname, idx, count);
+
+h5close(fname);
+delete(fname);
+
+printf("%d __h5read__ calls of 10 elements each\n", N);
+printf("  without file cache: %8.1f us/call\n", 1e6*t0/N);
+printf("  with file cache   : %8.1f us/call\n", 1e6*t1/N);
+printf("  speedup           : %8.1f x\n", t0/t1);
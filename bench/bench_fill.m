@@ -0,0 +1,33 @@
+## Benchmark: creating large contiguous and chunked datasets under the
+## allocation ('AllocTime') and fill ('FillTime') policies of h5create,
+## and the file size that results.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_fill.m
+
+n = 2^14;   # an n x n double dataset, 2 GiB
+policies = {'late',        'ifset';
+            'early',       'never';
+            'early',       'alloc';
+            'incremental', 'alloc'};
+printf("%12s %8s %12s %12s %12s\n", "AllocTime", "FillTime", "layout", "create", "file size");
+for chunked = [false true]
+  for k = 1:rows(policies)
+    fname = [tempname() ".h5"];
+    args = {'FillValue', -1, 'AllocTime', policies{k,1}, 'FillTime', policies{k,2}};
+    if chunked
+      args(end+1:end+2) = {'ChunkSize', [1024 1024]};
+      layout = "chunked";
+    else
+      layout = "contiguous";
+    endif
+    tic;
+    h5create(fname,'/D',[n n],args{:});
+    h5close(fname);
+    t = toc;
+    d = dir(fname);
+    printf("%12s %8s %12s %10.3f s %9.0f MB\n", policies{k,:}, layout, t, d.bytes/2^20);
+    delete(fname);
+  endfor
+endfor
@@ -0,0 +1,26 @@
+## Benchmark: h5info and h5ls time for groups with 1k, 10k and 100k
+## members. The time per member should stay constant.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_groupscaling.m
+## Creating the 100k member group takes a few minutes.
+
+printf("%-8s %12s %14s %12s %14s\n", "members", "h5info (s)", "per member (us)", ...
+       "h5ls (s)", "per member (us)");
+for n = [1e3 1e4 1e5]
+  fname = [tempname() ".h5"];
+  for i=1:n
+    h5create(fname,sprintf('/g/d%06d',i),[1 4]);
+  endfor
+  h5close(fname);
+
+  tic; info = h5info(fname,'/g','Attributes','none'); t1 = toc;
+  assert(numel(info.Datasets), n);
+  h5close(fname);
+  tic; names = h5ls(fname,'/g'); t2 = toc;
+  assert(numel(names), n);
+  h5close(fname);
+  delete(fname);
+  printf("%-8d %12.3f %14.1f %12.3f %14.1f\n", n, t1, t1/n*1e6, t2, t2/n*1e6);
+endfor
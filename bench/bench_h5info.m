@@ -0,0 +1,38 @@
+## Benchmark: h5info with the 'Depth', 'Attributes' and 'Datasets'
+## options and h5ls on a file with many groups, datasets and attributes.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_h5info.m
+
+ng = 50;  # groups
+nd = 40;  # datasets per group
+na = 5;   # attributes per object
+fname = [tempname() ".h5"];
+for i=1:ng
+  for j=1:nd
+    loc = sprintf('/g%03d/d%03d', i, j);
+    h5create(fname,loc,[16 16],'ChunkSize',[4 4],'Deflate',1);
+    for k=1:na
+      h5writeatt(fname,loc,sprintf('a%d',k),rand(1,8));
+    endfor
+  endfor
+endfor
+h5close(fname);
+
+cases = {"full", {}; ...
+         "Attributes names", {'Attributes','names'}; ...
+         "Attributes none", {'Attributes','none'}; ...
+         "Datasets names", {'Attributes','none','Datasets','names'}; ...
+         "Depth 1", {'Depth',1,'Attributes','none','Datasets','names'}};
+printf("%-20s %10s\n", "h5info", "time (s)");
+for i=1:rows(cases)
+  h5close(fname);
+  tic; info = h5info(fname,'/',cases{i,2}{:}); t = toc;
+  printf("%-20s %10.3f\n", cases{i,1}, t);
+endfor
+h5close(fname);
+tic; [names, types] = h5ls(fname,'/g001'); t = toc;
+printf("%-20s %10.3f\n", "h5ls", t);
+h5close(fname);
+delete(fname);
@@ -0,0 +1,67 @@
+## Benchmark: loading a wide and deep file with the compiled h5load
+## against the previous script implementation (h5info + h5read per dataset).
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_h5load.m
+
+1; # script file
+
+# the previous h5load, in Octave script
+function dataout = script_h5load(filename, info, datain)
+  if isfield(info,"Groups"),
+    g = struct();
+    for i=1:size(info.Datasets,1)
+      g = script_h5load(filename,info.Datasets(i),g);
+    endfor
+    for i=1:size(info.Groups,1)
+      g = script_h5load(filename,info.Groups(i),g);
+    endfor
+    if nargin==3,
+      dataout = datain;
+      dataout.(strsplit(info.Name,"/"){end}) = g;
+    else
+      dataout = g;
+    endif
+  else
+    dset = h5read(filename,info.Name);
+    if nargin==3,
+      dataout = datain;
+      dataout.(strsplit(info.Name,"/"){end}) = dset;
+    else
+      dataout = dset;
+    endif
+  endif
+endfunction
+
+function make_tree(fname, path, depth, width, nds)
+  for i=1:nds
+    loc = sprintf("%s/d%02d", path, i);
+    h5create(fname,loc,[1 16]);
+    h5write(fname,loc,rand(1,16));
+  endfor
+  if depth > 0
+    for i=1:width
+      make_tree(fname, sprintf("%s/g%02d", path, i), depth-1, width, nds);
+    endfor
+  endif
+endfunction
+
+printf("%-8s %-8s %10s %12s %12s %8s\n", "groups", "datasets", "", ...
+       "script (s)", "native (s)", "speedup");
+for cfg = [2 4 5; 3 5 10; 4 6 5]'
+  [depth, width, nds] = num2cell(cfg){:};
+  fname = [tempname() ".h5"];
+  make_tree(fname, "", depth, width, nds);
+  ngroups = sum(width.^(1:depth));
+  h5close(fname);
+
+  tic; d1 = script_h5load(fname, h5info(fname,"/")); t1 = toc;
+  h5close(fname);
+  tic; d2 = h5load(fname); t2 = toc;
+  h5close(fname);
+  assert(isequal(d1,d2));
+  delete(fname);
+  printf("%-8d %-8d %10s %12.3f %12.3f %8.1f\n", ngroups, (ngroups+1)*nds, ...
+         sprintf("d=%d w=%d", depth, width), t1, t2, t1/t2);
+endfor
@@ -0,0 +1,70 @@
+## Benchmark: round trip of a small HDF5 payload, built with h5create and
+## h5write, turned into bytes (as for a message queue) and read back on
+## the receiving side: through a temporary file, and through a memory
+## file with h5serialize/h5deserialize.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_memory_file.m
+
+nmsg = 200;
+x = rand(64, 16);
+t = int64(1:16);
+
+function bytes = read_bytes(fname)
+  fid = fopen(fname, "r");
+  bytes = fread(fid, Inf, "uint8=>uint8")';
+  fclose(fid);
+endfunction
+
+function write_bytes(fname, bytes)
+  fid = fopen(fname, "w");
+  fwrite(fid, bytes);
+  fclose(fid);
+endfunction
+
+## temporary file
+tic;
+for i = 1:nmsg
+  f = [tempname() ".h5"];
+  h5create(f, '/x', size(x));
+  h5create(f, '/t', size(t), 'Datatype', 'int64');
+  h5write(f, '/x', x);
+  h5write(f, '/t', t);
+  h5close(f);
+  bytes = read_bytes(f);
+  delete(f);
+  ## receiver
+  g = [tempname() ".h5"];
+  write_bytes(g, bytes);
+  y = h5read(g, '/x');
+  u = h5read(g, '/t');
+  h5close(g);
+  delete(g);
+endfor
+t_file = toc;
+assert (y, x);
+
+## memory file
+tic;
+for i = 1:nmsg
+  f = "mem://msg";
+  h5create(f, '/x', size(x));
+  h5create(f, '/t', size(t), 'Datatype', 'int64');
+  h5write(f, '/x', x);
+  h5write(f, '/t', t);
+  bytes = h5serialize(f);
+  h5close(f);
+  ## receiver
+  g = h5deserialize(bytes);
+  y = h5read(g, '/x');
+  u = h5read(g, '/t');
+  h5close(g);
+endfor
+t_mem = toc;
+assert (y, x);
+
+printf("%d messages of %d bytes\n", nmsg, numel(bytes));
+printf("%14s %12s\n", "", "per message");
+printf("%14s %9.3f ms\n", "temp file", 1e3 * t_file / nmsg);
+printf("%14s %9.3f ms\n", "memory file", 1e3 * t_mem / nmsg);
@@ -0,0 +1,35 @@
+## Benchmark: latency of random slice reads from a contiguous dataset,
+## with 'MMap' against the default H5Dread path.
+## The file is small enough to stay in the page cache.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_mmap.m
+
+sz = [512 512 64];
+fname = [tempname() ".h5"];
+h5create(fname,'/D',sz,'Datatype','single');
+h5write(fname,'/D',rand(sz,'single'));
+N = 2000; # reads per case
+
+printf("%-22s %14s %14s %8s\n", "slice", "H5Dread us", "MMap us", "speedup");
+slices = {"1 element", [1 1 1]; "row of 512", [1 512 1]; ...
+          "column of 512", [512 1 1]; "64x64 tile", [64 64 1]; ...
+          "frame 512x512", [512 512 1]; "4 frames", [512 512 4]};
+for i = 1:rows(slices)
+  count = slices{i,2};
+  starts = floor(rand(N,3) .* (sz - count)) + 1;
+  t = zeros(1,2);
+  for mode = 1:2
+    mmap = mode == 2;
+    h5read(fname,'/D',starts(1,:),count,'MMap',mmap); # warm up
+    tic;
+    for k = 1:N
+      y = h5read(fname,'/D',starts(k,:),count,'MMap',mmap);
+    endfor
+    t(mode) = toc/N*1e6;
+  endfor
+  printf("%-22s %14.1f %14.1f %8.2f\n", slices{i,1}, t(1), t(2), t(1)/t(2));
+endfor
+h5close(fname);
+delete(fname);
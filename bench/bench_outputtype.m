@@ -0,0 +1,37 @@
+## Benchmark: integer to floating-point conversion while reading
+## ('OutputType') against reading the native class and casting in Octave.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_outputtype.m
+
+n = 2^25; # elements
+types = {"int16", "uint16", "int32", "uint8"};
+outs = {"single", "double"};
+bufs = [0 2^16 2^24];
+
+printf("%-8s %-8s %10s %12s %12s\n", "file", "output", "buffer", "native+cast", "OutputType");
+for i = 1:numel(types)
+  fname = [tempname() ".h5"];
+  x = cast(randi(100, [n 1]), types{i});
+  h5create(fname,'/D',size(x),'Datatype',types{i});
+  h5write(fname,'/D',x);
+  clear x;
+  for j = 1:numel(outs)
+    for b = bufs
+      h5close(fname);
+      tic; y = cast(h5read(fname,'/D'), outs{j}); t1 = toc;
+      clear y;
+      h5close(fname);
+      tic; y = h5read(fname,'/D','OutputType',outs{j},'ConversionBuffer',b); t2 = toc;
+      clear y;
+      lbl = "default";
+      if b > 0, lbl = sprintf("%d KiB", b/1024); endif
+      printf("%-8s %-8s %10s %10.1f/s %10.1f/s\n", types{i}, outs{j}, lbl, ...
+             n/t1/1e6, n/t2/1e6);
+    endfor
+  endfor
+  h5close(fname);
+  delete(fname);
+endfor
+printf("(rates in million elements per second)\n");
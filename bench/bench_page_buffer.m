@@ -0,0 +1,45 @@
+## Benchmark: random small reads from a paged-aggregation file with
+## many small datasets, without and with a page buffer, and the hit
+## rates reported by h5filestats. The effect is largest on network
+## file systems, where each small read is a round trip.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_page_buffer.m
+
+ndsets = 5000;
+nreads = 5000;
+fname = [tempname() ".h5"];
+names = arrayfun(@(k) sprintf('/G%02d/D%04d', mod(k,50), k), 1:ndsets, 'UniformOutput', false);
+h5create(fname, names{1}, [1 32], 'FileSpaceStrategy', 'page', 'FileSpacePageSize', 65536);
+h5open(fname, 'r+');
+for i = 1:ndsets
+  if i > 1
+    h5create(fname, names{i}, [1 32]);
+  endif
+  h5write(fname, names{i}, rand(1,32));
+endfor
+h5close(fname);
+order = randi(ndsets, nreads, 1);
+
+old = h5fileaccess ();
+printf("%d datasets, %d random reads\n", ndsets, nreads);
+printf("%14s %10s %10s %14s\n", "page buffer", "time", "mdc hits", "page hits");
+for pb = [0 2^20 2^24]
+  h5fileaccess('PageBufferSize', pb);
+  tic;
+  for i = order'
+    x = h5read(fname, names{i});
+  endfor
+  t = toc;
+  s = h5filestats(fname);
+  if isempty(s.PageBuffer)
+    hits = "-";
+  else
+    hits = sprintf("%.1f%%", 100*sum(s.PageBuffer.Hits)/max(1,sum(s.PageBuffer.Accesses)));
+  endif
+  printf("%12d B %8.3f s %9.1f%% %14s\n", pb, t, 100*s.MetadataCache.HitRate, hits);
+  h5close(fname);
+endfor
+h5fileaccess('PageBufferSize', old.PageBufferSize);
+delete(fname);
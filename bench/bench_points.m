@@ -0,0 +1,43 @@
+## Benchmark: reading scattered samples with a point list or a logical
+## mask, against a loop of single-element hyperslab reads (__h5read__)
+## and against reading the whole dataset and indexing in Octave.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_points.m
+
+sz = [1000 1000 20];
+fname = [tempname() ".h5"];
+h5create(fname,'/D',sz,'ChunkSize',[100 100 1]);
+h5write(fname,'/D',rand(sz));
+x = h5read(fname,'/D');
+
+printf("%8s %12s %12s %12s %12s\n", "samples", "loop", "points", "mask", "full+index");
+for n = [100 1000 10000 50000]
+  idx = randperm(prod(sz), n)';
+  [i,j,k] = ind2sub(sz, idx);
+  P = [i j k];
+  m = false(sz); m(idx) = true;
+  opts = struct();
+
+  tloop = NaN;
+  if n <= 10000
+    tic;
+    y = zeros(n,1);
+    for r = 1:n
+      y(r) = __h5read__(fname,'/D',P(r,:)',[1;1;1],[],opts);
+    endfor
+    tloop = toc;
+    assert (y, x(idx));
+  endif
+
+  tic; y = h5read(fname,'/D',P); tp = toc;
+  assert (y, x(idx));
+  tic; y = h5read(fname,'/D',m); tm = toc;
+  assert (y, x(m));
+  tic; y = h5read(fname,'/D'); y = y(m); tf = toc;
+
+  printf("%8d %10.3f s %10.3f s %10.3f s %10.3f s\n", n, tloop, tp, tm, tf);
+endfor
+h5close(fname);
+delete(fname);
@@ -0,0 +1,37 @@
+## Benchmark: reading the same frame from many datasets with
+## h5readmulti against a loop of h5read calls.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_readmulti.m
+
+nch = 500;  # sensor channels
+nt = 1000;  # samples per frame
+nf = 20;    # frames
+fname = [tempname() ".h5"];
+locs = cell(1,nch);
+for i=1:nch
+  locs{i} = sprintf('/sensors/group%d/ch%03d', mod(i,10), i);
+  h5create(fname,locs{i},[nt nf],'Datatype','single');
+  h5write(fname,locs{i},rand(nt,nf,'single'));
+endfor
+h5close(fname);
+
+printf("%-24s %10s %12s\n", "method", "time (s)", "datasets/s");
+for f = [1 nf]
+  tic;
+  y1 = cell(1,nch);
+  for i=1:nch
+    y1{i} = h5read(fname,locs{i},[1 f],[nt 1]);
+  endfor
+  t1 = toc;
+  h5close(fname);
+  tic;
+  y2 = h5readmulti(fname,locs,[1 f],[nt 1]);
+  t2 = toc;
+  h5close(fname);
+  assert(isequal(y1,y2));
+  printf("%-24s %10.3f %12.0f\n", sprintf("h5read loop, frame %d",f), t1, nch/t1);
+  printf("%-24s %10.3f %12.0f\n", sprintf("h5readmulti, frame %d",f), t2, nch/t2);
+endfor
+delete(fname);
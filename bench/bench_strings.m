@@ -0,0 +1,25 @@
+## Benchmark: reading columns of short variable-length strings as a
+## cellstr and as a padded char matrix ('TextType','char'), for
+## increasing numbers of rows.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_strings.m
+
+fname = [tempname() ".h5"];
+printf("%10s %14s %14s %14s\n", "rows", "cellstr", "char", "strings/s char");
+for n = [1e4 1e5 1e6 4e6]
+  c = arrayfun(@(k) sprintf("id-%07d", k), (1:n)', 'UniformOutput', false);
+  loc = sprintf('/S%d', n);
+  h5create(fname,loc,[n 1],'Datatype','string');
+  h5write(fname,loc,c);
+  clear c
+
+  tic; x = h5read(fname,loc); t0 = toc;
+  tic; y = h5read(fname,loc,'TextType','char'); t1 = toc;
+  assert (char(x), y);
+  printf("%10d %12.3f s %12.3f s %14.3g\n", n, t0, t1, n/t1);
+endfor
+
+h5close(fname);
+delete(fname);
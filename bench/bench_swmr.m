@@ -0,0 +1,59 @@
+## Benchmark: latency between an h5append of an SWMR writer and the
+## moment the data are seen by a reader in another Octave process, and
+## the cost of the per-call flush on the writer side.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_swmr.m
+
+nblocks = 200;
+blocksize = 1024;
+fname = [tempname() ".h5"];
+h5create(fname, '/D1', [blocksize Inf], 'ChunkSize', [blocksize 4], 'LatestFormat', true);
+h5close(fname);
+
+## the reader polls the extent and records when each block appears
+reader = [tempname() ".m"];
+result = [tempname() ".txt"];
+fid = fopen(reader, "w");
+fprintf(fid, "addpath('%s', '%s');\n", fileparts(which("h5append")), fileparts(which("__h5append__")));
+fprintf(fid, "while !exist('%s.ready', 'file'), pause(0.001); end\n", fname);
+fprintf(fid, "h5open('%s', 'r', 'SWMR', true);\n", fname);
+fprintf(fid, "t = zeros(1, %d); n = 0;\n", nblocks);
+fprintf(fid, "while n < %d\n", nblocks);
+fprintf(fid, "  m = h5info('%s', '/D1').Dataspace.Size(2);\n", fname);
+fprintf(fid, "  t(n+1:m) = time(); n = m;\n");
+fprintf(fid, "end\n");
+fprintf(fid, "h5close('%s');\n", fname);
+fprintf(fid, "save('-ascii', '-double', '%s', 't');\n", result);
+fclose(fid);
+system(sprintf('"%s" -q --no-gui "%s" &', fullfile(OCTAVE_HOME(), "bin", "octave-cli"), reader));
+
+h5open(fname, 'r+', 'SWMR', true);
+fclose(fopen([fname ".ready"], "w"));
+pause(1);
+sent = zeros(1, nblocks);
+tw = 0;
+for i = 1:nblocks
+  x = rand(blocksize, 1);
+  sent(i) = time();
+  tic;
+  h5append(fname, '/D1', x);
+  tw += toc;
+  pause(0.005);
+endfor
+h5close(fname);
+
+while !exist(result, "file")
+  pause(0.1);
+endwhile
+pause(0.5);
+seen = load(result);
+lat = 1e3 * (seen - sent);
+printf("%d appends of %d doubles\n", nblocks, blocksize);
+printf("writer: %8.3f ms per h5append (including flush)\n", 1e3 * tw / nblocks);
+printf("reader latency: median %.3f ms, max %.3f ms\n", median(lat), max(lat));
+delete(reader);
+delete(result);
+delete([fname ".ready"]);
+delete(fname);
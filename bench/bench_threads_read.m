@@ -0,0 +1,40 @@
+## Benchmark: read throughput of a deflate-compressed dataset
+## vs. the number of decompression threads (h5read 'Threads').
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_threads_read.m
+
+# detector-like frames: smooth background + noise, stored as int16
+n = 1024; nframes = 64;
+[X,Y] = meshgrid(1:n);
+frame = 1000*exp(-((X-n/2).^2+(Y-n/2).^2)/(n/4)^2);
+x = zeros(n, n, nframes, 'int16');
+for k = 1:nframes
+  x(:,:,k) = int16(frame + 20*randn(n));
+endfor
+nbytes = numel(x)*2;
+clear X Y frame
+
+threads = unique([1 2 4 8 16 nproc()]);
+printf("%-14s %8s %10s %8s\n", "filters", "threads", "read MB/s", "speedup");
+for level = [1 6]
+  for shuffle = [false true]
+    fname = [tempname() ".h5"];
+    h5create(fname,'/D',size(x),'Datatype','int16','ChunkSize',[n 64 1],...
+             'Deflate',level,'Shuffle',shuffle);
+    h5write(fname,'/D',x);
+    lbl = sprintf("deflate %d%s", level, repmat("+shuf", 1, shuffle));
+    t1 = 0;
+    for t = threads
+      h5close(fname);
+      tic; y = h5read(fname,'/D','Threads',t); tr = toc;
+      assert (isequal (y, x));
+      clear y;
+      if t == 1, t1 = tr; endif
+      printf("%-14s %8d %10.1f %8.2f\n", lbl, t, nbytes/tr/2^20, t1/tr);
+    endfor
+    h5close(fname);
+    delete(fname);
+  endfor
+endfor
@@ -0,0 +1,43 @@
+## Benchmark: write throughput of a deflate-compressed dataset
+## vs. the number of compression threads (h5write 'Threads').
+## Frames are written in pairs, each pair covering whole chunks.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_threads_write.m
+
+# detector-like frames: smooth background + noise, stored as int16
+n = 1024; nframes = 64;
+[X,Y] = meshgrid(1:n);
+frame = 1000*exp(-((X-n/2).^2+(Y-n/2).^2)/(n/4)^2);
+x = zeros(n, n, nframes, 'int16');
+for k = 1:nframes
+  x(:,:,k) = int16(frame + 20*randn(n));
+endfor
+nbytes = numel(x)*2;
+clear X Y frame
+
+threads = unique([1 2 4 8 16 nproc()]);
+printf("%-14s %8s %11s %8s\n", "filters", "threads", "write MB/s", "speedup");
+for level = [1 6]
+  for shuffle = [false true]
+    lbl = sprintf("deflate %d%s", level, repmat("+shuf", 1, shuffle));
+    t1 = 0;
+    for t = threads
+      fname = [tempname() ".h5"];
+      h5create(fname,'/D',[n n Inf],'Datatype','int16','ChunkSize',[n 64 1],...
+               'Deflate',level,'Shuffle',shuffle);
+      tic;
+      for k = 1:2:nframes
+        h5write(fname,'/D',x(:,:,k:k+1),[1 1 k],[n n 2],'Threads',t);
+      endfor
+      h5flush(fname);
+      tw = toc;
+      assert (isequal (h5read(fname,'/D',[1 1 nframes-1],[n n 2]), x(:,:,end-1:end)));
+      h5close(fname);
+      delete(fname);
+      if t == 1, t1 = tw; endif
+      printf("%-14s %8d %11.1f %8.2f\n", lbl, t, nbytes/tw/2^20, t1/tw);
+    endfor
+  endfor
+endfor
@@ -0,0 +1,50 @@
+## Benchmark: reading and writing arrays in the row-major order of the
+## file, with the 'Transpose' option vs. h5read/h5write and permute,
+## for 2-D to 4-D single and double arrays of 64 MB. The last column
+## reads a compressed dataset with 4 threads, where the chunks are
+## stored transposed as they are decoded.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_transpose.m
+
+shapes = {[2048 4096], [128 256 256], [32 64 64 64]};
+types = {'double', 'single'};
+nrep = 3;
+fname = [tempname() ".h5"];
+
+function t = best(f, nrep)
+  t = Inf;
+  for k = 1:nrep
+    tic; f(); t = min(t, toc);
+  endfor
+endfunction
+
+printf("%-14s %-7s %12s %12s %12s %12s %12s\n", "shape", "class", ...
+       "read+permute", "read T", "permute+write", "write T", "read T deflate");
+for i = 1:numel(shapes)
+  sz = shapes{i};
+  nd = numel(sz);
+  for j = 1:numel(types)
+    x = rand(sz, types{j});
+    loc = sprintf('/D%d%s', nd, types{j});
+    h5create(fname,loc,sz,'Datatype',types{j},'Transpose',true);
+    h5create(fname,[loc 'z'],sz,'Datatype',types{j},'Transpose',true,'Deflate',1);
+    h5write(fname,[loc 'z'],x,'Transpose',true);
+
+    tw0 = best(@() h5write(fname,loc,permute(x,nd:-1:1)), nrep);
+    tw1 = best(@() h5write(fname,loc,x,'Transpose',true), nrep);
+    tr0 = best(@() permute(h5read(fname,loc),nd:-1:1), nrep);
+    tr1 = best(@() h5read(fname,loc,'Transpose',true), nrep);
+    tz = best(@() h5read(fname,[loc 'z'],'Transpose',true,'Threads',4), nrep);
+    assert (h5read(fname,loc,'Transpose',true), x);
+    assert (h5read(fname,[loc 'z'],'Transpose',true,'Threads',4), x);
+
+    mb = numel(x)*sizeof(x(1))/2^20;
+    printf("%-14s %-7s %7.0f MB/s %7.0f MB/s %7.0f MB/s %7.0f MB/s %7.0f MB/s\n", ...
+           mat2str(sz), types{j}, mb/tr0, mb/tr1, mb/tw0, mb/tw1, mb/tz);
+  endfor
+endfor
+
+h5close(fname);
+delete(fname);
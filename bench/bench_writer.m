@@ -0,0 +1,38 @@
+## Benchmark: per-call latency of many small equal-sized block writes
+## to one dataset, h5write vs. a h5writer handle.
+##
+## Run from the Octave prompt with the package loaded:
+##   pkg load hdf5oct
+##   run bench/bench_writer.m
+
+N = 20000;     # blocks
+nch = 16;      # block = one sample of nch channels
+x = rand(nch, N);
+
+fname = [tempname() ".h5"];
+h5create(fname,'/D1',[nch N]);
+h5create(fname,'/D2',[nch N]);
+h5open(fname,'r+'); # no flush after each h5write
+
+tic;
+for k = 1:N
+  h5write(fname,'/D1',x(:,k),[1 k],[nch 1]);
+endfor
+t0 = toc;
+
+tic;
+w = h5writer(fname,'/D2');
+for k = 1:N
+  w.write(x(:,k),[1 k]);
+endfor
+w.close();
+t1 = toc;
+
+assert (isequal (h5read(fname,'/D1'), x) && isequal (h5read(fname,'/D2'), x));
+h5close(fname);
+delete(fname);
+
+printf("%d writes of %d doubles each\n", N, nch);
+printf("  h5write      : %8.1f us/call\n", 1e6*t0/N);
+printf("  h5writer     : %8.1f us/call\n", 1e6*t1/N);
+printf("  speedup      : %8.1f x\n", t0/t1);
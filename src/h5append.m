@@ -0,0 +1,74 @@
+##
+##    Copyright (C) 2024 George Apostolopoulos
+##
+##    This file is part of hdf5oct.
+##
+##    hdf5oct is free software: you can redistribute it and/or modify
+##    it under the terms of the GNU Lesser General Public License as published by
+##    the Free Software Foundation, either version 3 of the License, or
+##    (at your option) any later version.
+##
+##    hdf5oct is distributed in the hope that it will be useful,
+##    but WITHOUT ANY WARRANTY; without even the implied warranty of
+##    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+##    GNU Lesser General Public License for more details.
+##
+##    You should have received a copy of the GNU Lesser General Public License
+##    along with hdf5oct.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+# -*- texinfo -*-
+# @deftypefn  {Function File} { } h5append (@var{filename}, @var{dsetname}, @var{data})
+# @deftypefnx {Function File} { } h5append (@var{filename}, @var{dsetname}, @var{data}, @var{dim})
+#
+# Append data to the end of an extendable HDF5 dataset.
+#
+# @code{h5append(filename,dsetname,data,dim)} writes @var{data} after the
+# last element of the dataset along dimension @var{dim}, which must be
+# extendable. The size of @var{data} must match the size of the dataset
+# along all other dimensions. If @var{dim} is omitted, the data are
+# appended along the last dimension of the dataset. For 1-D datasets
+# @var{data} is a vector and @var{dim} is ignored.
+#
+# Unlike @code{h5write} with an explicit @var{start}, the extent of the
+# dataset is not grown by the size of each block, but geometrically, so
+# that a long series of small appends resizes the dataset only a few times.
+# The number of elements written so far, the logical size of the dataset,
+# is stored in the attribute @samp{HDF5OCT_APPEND_SIZE}.
+# @code{h5read}, @code{h5info}, @code{h5write} and @code{h5append} use
+# the logical size and do not list the attribute.
+#
+# The dataset is trimmed to its logical size and the attribute removed
+# when the file is flushed or closed (@code{h5flush}, @code{h5close},
+# or on leaving Octave). For sustained appends, keep the file open with
+# @code{h5open}; otherwise the dataset is trimmed after each call.
+#
+# @seealso{h5write, h5create, h5open, h5flush}
+# @end deftypefn
+
+function h5append(filename,location,data,dim)
+
+# check number and types of arguments
+if nargin < 3 || nargin > 4,
+    print_usage();
+endif
+if (!ischar(filename))
+  error("h5append: 1st argument must be a string holding the hdf5 file name");
+endif
+if (!isfile(filename) && !strncmp(filename, "mem://", 6))
+  error("h5append: filename does not exist");
+endif
+if (!ischar(location))
+  error("h5append: 2nd argument must be a string holding the dataset location");
+endif
+if nargin < 4,
+  dim = 0;
+elseif !(isscalar(dim) && isindex(dim)),
+  error("h5append: dim must be a positive integer");
+endif
+
+if ischar(data), data = cellstr(data); endif
+
+__h5append__(filename,location,data,double(dim));
+
+endfunction
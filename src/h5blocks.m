@@ -0,0 +1,98 @@
+##
+##    Copyright (C) 2024 George Apostolopoulos
+##
+##    This file is part of hdf5oct.
+##
+##    hdf5oct is free software: you can redistribute it and/or modify
+##    it under the terms of the GNU Lesser General Public License as published by
+##    the Free Software Foundation, either version 3 of the License, or
+##    (at your option) any later version.
+##
+##    hdf5oct is distributed in the hope that it will be useful,
+##    but WITHOUT ANY WARRANTY; without even the implied warranty of
+##    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+##    GNU Lesser General Public License for more details.
+##
+##    You should have received a copy of the GNU Lesser General Public License
+##    along with hdf5oct.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+# -*- texinfo -*-
+# @deftypefn  {Function File} {@var{it} =} h5blocks (@var{filename}, @var{dsetname})
+# @deftypefnx {Function File} {@var{it} =} h5blocks (@var{filename}, @var{dsetname}, @var{dim})
+# @deftypefnx {Function File} {@var{it} =} h5blocks (@var{filename}, @var{dsetname}, @var{dim}, @var{blocksize})
+#
+# Iterate over a HDF5 dataset in consecutive blocks.
+#
+# @code{h5blocks} returns an iterator @var{it} that splits the dataset
+# @var{dsetname} along dimension @var{dim} (default: the last one)
+# into blocks of @var{blocksize} elements, each spanning the whole
+# dataset along the other dimensions. It has the following methods:
+#
+# @table @code
+# @item @var{it}.hasNext ()
+# True if there are more blocks to read.
+#
+# @item [@var{x}, @var{start}] = @var{it}.next ()
+# Return the next block @var{x} and the 1-based indices @var{start}
+# of its first element in the dataset.
+#
+# @item @var{it}.close ()
+# Stop the iteration and release the dataset.
+# @end table
+#
+# For chunked datasets @var{blocksize} is rounded up to a multiple of
+# the chunk size along @var{dim}, so that each chunk is read once; the
+# default is a single chunk. For contiguous datasets the default block
+# is about 1 MiB.
+#
+# While a block is processed, the next one is read by a background
+# thread, so that datasets larger than the available memory can be
+# streamed through with I/O overlapping the computation.
+# As for @code{h5write (@dots{}, 'Async', true)}, other users of the
+# HDF5 library in the same process, such as @code{save -hdf5}, do not
+# wait for this read, and must be preceded by @code{h5wait ()}.
+#
+# Example:
+# @example
+# @group
+# it = h5blocks ('data.h5', '/D', 2, 1000);
+# s = 0;
+# while (it.hasNext ())
+#   x = it.next ();
+#   s += sum (x(:));
+# endwhile
+# @end group
+# @end example
+#
+# @seealso{h5read, h5info}
+# @end deftypefn
+
+function it = h5blocks(filename,location,dim,blocksize)
+
+if nargin < 2 || nargin > 4,
+    print_usage();
+endif
+if (!ischar(filename))
+  error("h5blocks: 1st argument must be a string holding the hdf5 file name");
+endif
+if (!isfile(filename) && !strncmp(filename, "mem://", 6))
+  error("h5blocks: filename does not exist");
+endif
+if (!ischar(location))
+  error("h5blocks: 2nd argument must be a string holding the dataset location");
+endif
+if nargin < 3 || isempty(dim),
+  dim = 0;
+elseif !(isscalar(dim) && isindex(dim)),
+  error("h5blocks: dim must be a positive integer");
+endif
+if nargin < 4,
+  blocksize = 0;
+elseif !(isscalar(blocksize) && isindex(blocksize)),
+  error("h5blocks: blocksize must be a positive integer");
+endif
+
+it = __h5blocks__(filename,location,double(dim),double(blocksize));
+
+endfunction
@@ -0,0 +1,977 @@
+/*
+ *
+ *    Copyright (C) 2024 George Apostolopoulos
+ *
+ *    This file is part of hdf5oct.
+ *
+ *    hdf5oct is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    hdf5oct is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public License
+ *    along with hdf5oct.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#include "h5chunks.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <zlib.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+unsigned &hdf5oct::defaultThreads()
+{
+    static unsigned nthreads = 1;
+    return nthreads;
+}
+
+namespace
+{
+    // Geometry of a chunked dataset and of a regular hyperslab selection,
+    // all in HDF5 dimension order
+    struct layout_t
+    {
+        int ndim{0};
+        size_t elem_size{0};
+        hsize_t dims[H5S_MAX_RANK], chunk[H5S_MAX_RANK];
+        hsize_t start[H5S_MAX_RANK], stride[H5S_MAX_RANK], count[H5S_MAX_RANK];
+        vector<H5Z_filter_t> filters; // in the order applied when writing
+        unsigned deflate_level{0};
+        bool filter_edge_chunks{true};
+        bool reversed{false}; // the selection buffer is in Fortran order
+
+        bool assign(hid_t dset, hid_t mem_type, hid_t file_space);
+        // all elements or a regular hyperslab of file_space, ndim dimensions
+        bool assignSelection(hid_t file_space);
+        size_t chunkBytes() const
+        {
+            size_t n = elem_size;
+            for (int d = 0; d < ndim; d++)
+                n *= chunk[d];
+            return n;
+        }
+        hsize_t selectionEnd(int d) const
+        {
+            return start[d] + (count[d] - 1) * stride[d];
+        }
+        // Range [lo, hi] of the selection indices along dimension d
+        // that fall in the chunk at offset. False if there are none
+        bool range(int d, hsize_t offset, hsize_t &lo, hsize_t &hi) const
+        {
+            hsize_t last = offset + chunk[d] - 1;
+            if (last < start[d] || offset > selectionEnd(d))
+                return false;
+            lo = offset > start[d] ? (offset - start[d] + stride[d] - 1) / stride[d] : 0;
+            hi = std::min(count[d] - 1, (last - start[d]) / stride[d]);
+            return lo <= hi;
+        }
+        // True if the selection consists of whole chunks, the edge
+        // chunks of the dataset possibly extending beyond its size
+        bool chunkAligned() const
+        {
+            for (int d = 0; d < ndim; d++)
+            {
+                hsize_t end = start[d] + count[d];
+                if ((stride[d] != 1 && count[d] > 1) || start[d] % chunk[d] ||
+                    (end % chunk[d] && end != dims[d]))
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    bool layout_t::assign(hid_t dset, hid_t mem_type, hid_t file_space)
+    {
+        // the dataset must be chunked, with supported filters only
+        hid_t dcpl = H5Dget_create_plist(dset);
+        if (dcpl < 0)
+            return false;
+        bool ok = H5Pget_layout(dcpl) == H5D_CHUNKED;
+        if (ok)
+        {
+            ndim = H5Pget_chunk(dcpl, H5S_MAX_RANK, chunk);
+            int nfilters = H5Pget_nfilters(dcpl);
+            ok = ndim > 0 && nfilters > 0;
+            for (int i = 0; ok && i < nfilters; i++)
+            {
+                unsigned flags, cd_values[8];
+                size_t ncd = 8;
+                H5Z_filter_t f = H5Pget_filter2(dcpl, i, &flags, &ncd, cd_values,
+                                                0, nullptr, nullptr);
+                ok = f == H5Z_FILTER_DEFLATE || f == H5Z_FILTER_SHUFFLE ||
+                     f == H5Z_FILTER_FLETCHER32;
+                if (f == H5Z_FILTER_DEFLATE)
+                    deflate_level = ncd > 0 ? cd_values[0] : Z_DEFAULT_COMPRESSION;
+                filters.push_back(f);
+            }
+            unsigned opts = 0;
+            if (ok && H5Pget_chunk_opts(dcpl, &opts) >= 0)
+                filter_edge_chunks = !(opts & H5D_CHUNK_DONT_FILTER_PARTIAL_CHUNKS);
+        }
+        H5Pclose(dcpl);
+        if (!ok)
+            return false;
+
+        // no type conversion
+        hid_t ftype = H5Dget_type(dset);
+        if (ftype < 0)
+            return false;
+        ok = H5Tequal(ftype, mem_type) > 0 && !H5Tdetect_class(ftype, H5T_VLEN) &&
+             !H5Tis_variable_str(ftype);
+        elem_size = H5Tget_size(ftype);
+        H5Tclose(ftype);
+        if (!ok)
+            return false;
+
+        return H5Sget_simple_extent_ndims(file_space) == ndim && assignSelection(file_space);
+    }
+
+    bool layout_t::assignSelection(hid_t file_space)
+    {
+        hsize_t block[H5S_MAX_RANK];
+        H5Sget_simple_extent_dims(file_space, dims, nullptr);
+        switch (H5Sget_select_type(file_space))
+        {
+        case H5S_SEL_ALL:
+            for (int d = 0; d < ndim; d++)
+            {
+                start[d] = 0;
+                stride[d] = 1;
+                count[d] = dims[d];
+            }
+            break;
+        case H5S_SEL_HYPERSLABS:
+            if (H5Sis_regular_hyperslab(file_space) <= 0 ||
+                H5Sget_regular_hyperslab(file_space, start, stride, count, block) < 0)
+                return false;
+            for (int d = 0; d < ndim; d++)
+            {
+                if (block[d] == 1)
+                    continue;
+                if (count[d] != 1)
+                    return false;
+                count[d] = block[d];
+                stride[d] = 1;
+            }
+            break;
+        default:
+            return false;
+        }
+        for (int d = 0; d < ndim; d++)
+            if (count[d] == 0 || stride[d] == 0)
+                return false;
+        return true;
+    }
+
+    // Same as H5_checksum_fletcher32 of the HDF5 library
+    uint32_t fletcher32(const unsigned char *data, size_t nbytes)
+    {
+        size_t len = nbytes / 2;
+        uint32_t sum1 = 0, sum2 = 0;
+        while (len)
+        {
+            size_t tlen = len > 360 ? 360 : len;
+            len -= tlen;
+            do
+            {
+                sum1 += (uint32_t(data[0]) << 8) | uint32_t(data[1]);
+                data += 2;
+                sum2 += sum1;
+            } while (--tlen);
+            sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+            sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+        }
+        if (nbytes % 2)
+        {
+            sum1 += uint32_t(*data) << 8;
+            sum2 += sum1;
+            sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+            sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+        }
+        sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+        sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+        return (sum2 << 16) | sum1;
+    }
+
+    // Undo the shuffle filter: byte j of all elements is stored in block j
+    void unshuffle(const unsigned char *src, unsigned char *dst, size_t nbytes, size_t elem_size)
+    {
+        size_t n = nbytes / elem_size;
+        for (size_t j = 0; j < elem_size; j++)
+        {
+            const unsigned char *b = src + j * n;
+            for (size_t i = 0; i < n; i++)
+                dst[i * elem_size + j] = b[i];
+        }
+        // leftover bytes are not shuffled
+        std::memcpy(dst + n * elem_size, src + n * elem_size, nbytes - n * elem_size);
+    }
+
+    // Run the filter pipeline backwards on a raw chunk.
+    // Bit i of mask is set if filter i was skipped for this chunk
+    bool decode(const layout_t &L, uint32_t mask, vector<unsigned char> &data,
+                vector<unsigned char> &tmp)
+    {
+        size_t nbytes = L.chunkBytes();
+        for (int i = int(L.filters.size()) - 1; i >= 0; i--)
+        {
+            if (mask & (1u << i))
+                continue;
+            switch (L.filters[i])
+            {
+            case H5Z_FILTER_FLETCHER32:
+            {
+                if (data.size() < 4)
+                    return false;
+                size_t n = data.size() - 4;
+                const unsigned char *p = data.data() + n;
+                uint32_t stored = uint32_t(p[0]) | (uint32_t(p[1]) << 8) |
+                                  (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+                uint32_t sum = fletcher32(data.data(), n);
+                // older versions of the library stored the bytes reversed
+                uint32_t reversed = ((sum & 0xff) << 24) | ((sum & 0xff00) << 8) |
+                                    ((sum >> 8) & 0xff00) | (sum >> 24);
+                if (stored != sum && stored != reversed)
+                    return false;
+                data.resize(n);
+            }
+            break;
+            case H5Z_FILTER_DEFLATE:
+            {
+                tmp.resize(nbytes);
+                uLongf n = nbytes;
+                if (uncompress(tmp.data(), &n, data.data(), data.size()) != Z_OK || n != nbytes)
+                    return false;
+                data.swap(tmp);
+            }
+            break;
+            case H5Z_FILTER_SHUFFLE:
+                tmp.resize(data.size());
+                unshuffle(data.data(), tmp.data(), data.size(), L.elem_size);
+                data.swap(tmp);
+                break;
+            default:
+                return false;
+            }
+        }
+        return data.size() == nbytes;
+    }
+
+    void shuffle(const unsigned char *src, unsigned char *dst, size_t nbytes, size_t elem_size)
+    {
+        size_t n = nbytes / elem_size;
+        for (size_t j = 0; j < elem_size; j++)
+        {
+            unsigned char *b = dst + j * n;
+            for (size_t i = 0; i < n; i++)
+                b[i] = src[i * elem_size + j];
+        }
+        std::memcpy(dst + n * elem_size, src + n * elem_size, nbytes - n * elem_size);
+    }
+
+    // Run the filter pipeline on a chunk, as the HDF5 library does
+    bool encode(const layout_t &L, vector<unsigned char> &data, vector<unsigned char> &tmp)
+    {
+        for (H5Z_filter_t f : L.filters)
+        {
+            switch (f)
+            {
+            case H5Z_FILTER_SHUFFLE:
+                tmp.resize(data.size());
+                shuffle(data.data(), tmp.data(), data.size(), L.elem_size);
+                data.swap(tmp);
+                break;
+            case H5Z_FILTER_DEFLATE:
+            {
+                uLongf n = compressBound(data.size());
+                tmp.resize(n);
+                if (compress2(tmp.data(), &n, data.data(), data.size(), L.deflate_level) != Z_OK)
+                    return false;
+                tmp.resize(n);
+                data.swap(tmp);
+            }
+            break;
+            case H5Z_FILTER_FLETCHER32:
+            {
+                uint32_t sum = fletcher32(data.data(), data.size());
+                for (int k = 0; k < 4; k++)
+                    data.push_back((sum >> (8 * k)) & 0xff);
+            }
+            break;
+            default:
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Copy n elements of size s, src_step and dst_step bytes apart
+    template <class T>
+    void copyStrided(unsigned char *dst, size_t dst_step, const unsigned char *src,
+                     size_t src_step, size_t n)
+    {
+        for (size_t k = 0; k < n; k++)
+        {
+            T v;
+            std::memcpy(&v, src + k * src_step, sizeof(T));
+            std::memcpy(dst + k * dst_step, &v, sizeof(T));
+        }
+    }
+
+    void copyStrided(unsigned char *dst, size_t dst_step, const unsigned char *src,
+                     size_t src_step, size_t n, size_t s)
+    {
+        switch (s)
+        {
+        case 1:
+            copyStrided<uint8_t>(dst, dst_step, src, src_step, n);
+            break;
+        case 2:
+            copyStrided<uint16_t>(dst, dst_step, src, src_step, n);
+            break;
+        case 4:
+            copyStrided<uint32_t>(dst, dst_step, src, src_step, n);
+            break;
+        case 8:
+            copyStrided<uint64_t>(dst, dst_step, src, src_step, n);
+            break;
+        default:
+            for (size_t k = 0; k < n; k++)
+                std::memcpy(dst + k * dst_step, src + k * src_step, s);
+        }
+    }
+
+    // Copy the selected elements of a decoded chunk to the selection
+    // buffer sel or, if to_chunk is true, the other way around
+    void copySelection(const layout_t &L, const hsize_t *offset, unsigned char *chunk,
+                       unsigned char *sel, bool to_chunk)
+    {
+        int n = L.ndim;
+        hsize_t lo[H5S_MAX_RANK] = {}, hi[H5S_MAX_RANK] = {}, idx[H5S_MAX_RANK];
+        for (int d = 0; d < n; d++)
+            if (!L.range(d, offset[d], lo[d], hi[d]))
+                return;
+
+        // strides in bytes of the chunk and of the selection
+        size_t s = L.elem_size, cstr[H5S_MAX_RANK], ostr[H5S_MAX_RANK];
+        cstr[n - 1] = s;
+        for (int d = n - 2; d >= 0; d--)
+            cstr[d] = cstr[d + 1] * L.chunk[d + 1];
+        if (L.reversed)
+        {
+            ostr[0] = s;
+            for (int d = 1; d < n; d++)
+                ostr[d] = ostr[d - 1] * L.count[d - 1];
+        }
+        else
+        {
+            ostr[n - 1] = s;
+            for (int d = n - 2; d >= 0; d--)
+                ostr[d] = ostr[d + 1] * L.count[d + 1];
+        }
+
+        // copy runs along the dimension that is contiguous in the selection
+        int run = L.reversed ? 0 : n - 1;
+        size_t nrun = hi[run] - lo[run] + 1;
+        size_t src_step = L.stride[run] * cstr[run];
+        std::copy(lo, lo + n, idx);
+        for (;;)
+        {
+            size_t src = 0, dst = 0;
+            for (int d = 0; d < n; d++)
+            {
+                src += (L.start[d] + idx[d] * L.stride[d] - offset[d]) * cstr[d];
+                dst += idx[d] * ostr[d];
+            }
+            if (src_step == s)
+            {
+                if (to_chunk)
+                    std::memcpy(chunk + src, sel + dst, nrun * s);
+                else
+                    std::memcpy(sel + dst, chunk + src, nrun * s);
+            }
+            else if (to_chunk)
+                copyStrided(chunk + src, src_step, sel + dst, s, nrun, s);
+            else
+                copyStrided(sel + dst, s, chunk + src, src_step, nrun, s);
+
+            int d = n - 1;
+            for (; d >= 0; d--)
+            {
+                if (d == run)
+                    continue;
+                if (++idx[d] <= hi[d])
+                    break;
+                idx[d] = lo[d];
+            }
+            if (d < 0)
+                break;
+        }
+    }
+
+    // Offsets of the chunks with selected elements, in C order
+    vector<hsize_t> selectedChunks(const layout_t &L)
+    {
+        int ndim = L.ndim;
+        vector<vector<hsize_t>> dim_offsets(ndim);
+        for (int d = 0; d < ndim; d++)
+        {
+            hsize_t first = L.start[d] / L.chunk[d] * L.chunk[d], lo, hi;
+            for (hsize_t o = first; o <= L.selectionEnd(d); o += L.chunk[d])
+                if (L.range(d, o, lo, hi))
+                    dim_offsets[d].push_back(o);
+        }
+
+        // all their combinations
+        vector<hsize_t> offsets;
+        vector<size_t> k(ndim, 0);
+        for (;;)
+        {
+            for (int d = 0; d < ndim; d++)
+                offsets.push_back(dim_offsets[d][k[d]]);
+            int d = ndim - 1;
+            for (; d >= 0; d--)
+            {
+                if (++k[d] < dim_offsets[d].size())
+                    break;
+                k[d] = 0;
+            }
+            if (d < 0)
+                break;
+        }
+        return offsets;
+    }
+
+    // A chunk filled with the fill value of the dataset, which pads the
+    // partial edge chunks as in HDF5. Empty if the fill value is zero
+    vector<unsigned char> fillChunk(hid_t dset, const layout_t &L)
+    {
+        vector<unsigned char> value(L.elem_size, 0), chunk;
+        hid_t dcpl = H5Dget_create_plist(dset);
+        hid_t ftype = H5Dget_type(dset);
+        H5D_fill_value_t status;
+        bool user_defined = dcpl >= 0 && ftype >= 0 &&
+                            H5Pfill_value_defined(dcpl, &status) >= 0 &&
+                            status == H5D_FILL_VALUE_USER_DEFINED &&
+                            H5Pget_fill_value(dcpl, ftype, value.data()) >= 0;
+        if (ftype >= 0)
+            H5Tclose(ftype);
+        if (dcpl >= 0)
+            H5Pclose(dcpl);
+        if (!user_defined || std::all_of(value.begin(), value.end(),
+                                         [](unsigned char c)
+                                         { return c == 0; }))
+            return chunk;
+        chunk.resize(L.chunkBytes());
+        for (size_t i = 0; i < chunk.size(); i += L.elem_size)
+            memcpy(&chunk[i], value.data(), L.elem_size);
+        return chunk;
+    }
+
+    // A contiguous dataset as a single chunk
+    bool contiguousLayout(hid_t dset, hid_t file_space, layout_t &L)
+    {
+        hid_t dcpl = H5Dget_create_plist(dset);
+        if (dcpl < 0)
+            return false;
+        bool ok = H5Pget_layout(dcpl) == H5D_CONTIGUOUS && H5Pget_nfilters(dcpl) == 0 &&
+                  H5Pget_external_count(dcpl) == 0;
+        H5Pclose(dcpl);
+        L.ndim = H5Sget_simple_extent_ndims(file_space);
+        if (!ok || L.ndim < 1)
+            return false;
+        H5Sget_simple_extent_dims(file_space, L.dims, nullptr);
+        std::copy(L.dims, L.dims + L.ndim, L.chunk);
+        return L.assignSelection(file_space);
+    }
+} // namespace
+
+bool hdf5oct::readChunksParallel(hid_t dset, hid_t mem_type, hid_t file_space, void *buf,
+                                 unsigned nthreads, bool reversed)
+{
+#if H5_VERSION_GE(1, 10, 5)
+    layout_t L;
+    if (nthreads < 2 || !L.assign(dset, mem_type, file_space))
+        return false;
+    L.reversed = reversed;
+    int ndim = L.ndim;
+
+    // All chunks must be allocated, otherwise the fill value would have to be applied
+    vector<hsize_t> offsets = selectedChunks(L);
+    size_t nchunks = offsets.size() / ndim;
+    // partial edge chunks may be stored unfiltered
+    if (!L.filter_edge_chunks)
+        for (size_t i = 0; i < nchunks * ndim; i++)
+            if (offsets[i] + L.chunk[i % ndim] > L.dims[i % ndim])
+                return false;
+    vector<size_t> sizes(nchunks);
+    for (size_t i = 0; i < nchunks; i++)
+    {
+        unsigned filter_mask;
+        haddr_t addr;
+        hsize_t size;
+        herr_t err;
+        H5E_BEGIN_TRY
+        {
+            err = H5Dget_chunk_info_by_coord(dset, &offsets[i * ndim], &filter_mask, &addr, &size);
+        }
+        H5E_END_TRY;
+        if (err < 0 || addr == HADDR_UNDEF || size == 0)
+            return false;
+        sizes[i] = size;
+    }
+
+    // Worker threads decode the chunks and copy them to the output.
+    // The raw chunks are read on this thread, at most max_queued ahead
+    struct work_t
+    {
+        size_t index;
+        uint32_t mask;
+        vector<unsigned char> data;
+    };
+    unsigned char *out = static_cast<unsigned char *>(buf);
+    mutex mtx;
+    condition_variable cv_work, cv_space;
+    deque<work_t> queue;
+    bool done = false;
+    atomic<bool> failed{false};
+    size_t max_queued = 2 * nthreads;
+
+    auto worker = [&]()
+    {
+        vector<unsigned char> tmp;
+        for (;;)
+        {
+            work_t w;
+            {
+                unique_lock<mutex> lock(mtx);
+                cv_work.wait(lock, [&]
+                             { return !queue.empty() || done; });
+                if (queue.empty())
+                    return;
+                w = std::move(queue.front());
+                queue.pop_front();
+            }
+            cv_space.notify_one();
+            if (failed)
+                continue;
+            if (!decode(L, w.mask, w.data, tmp))
+            {
+                failed = true;
+                continue;
+            }
+            copySelection(L, &offsets[w.index * ndim], w.data.data(), out, false);
+        }
+    };
+
+    vector<thread> pool;
+    try
+    {
+        for (unsigned i = 0; i < std::min<size_t>(nthreads, nchunks); i++)
+            pool.emplace_back(worker);
+    }
+    catch (const std::system_error &)
+    {
+        failed = true;
+    }
+
+    for (size_t i = 0; i < nchunks && !failed && !pool.empty(); i++)
+    {
+        work_t w{i, 0, vector<unsigned char>(sizes[i])};
+        herr_t err;
+        H5E_BEGIN_TRY
+        {
+            err = H5Dread_chunk(dset, H5P_DEFAULT, &offsets[i * ndim], &w.mask, w.data.data());
+        }
+        H5E_END_TRY;
+        if (err < 0)
+        {
+            failed = true;
+            break;
+        }
+        {
+            unique_lock<mutex> lock(mtx);
+            cv_space.wait(lock, [&]
+                          { return queue.size() < max_queued; });
+            queue.push_back(std::move(w));
+        }
+        cv_work.notify_one();
+    }
+    {
+        lock_guard<mutex> lock(mtx);
+        done = true;
+    }
+    cv_work.notify_all();
+    for (auto &t : pool)
+        t.join();
+    return !failed && !pool.empty();
+#else
+    return false;
+#endif
+}
+
+bool hdf5oct::writeChunksParallel(hid_t dset, hid_t mem_type, hid_t file_space, const void *buf,
+                                  unsigned nthreads)
+{
+#if H5_VERSION_GE(1, 10, 3)
+    layout_t L;
+    if (nthreads < 2 || !L.assign(dset, mem_type, file_space) || !L.chunkAligned())
+        return false;
+    int ndim = L.ndim;
+    vector<hsize_t> offsets = selectedChunks(L);
+    size_t nchunks = offsets.size() / ndim;
+    bool partial = false;
+    for (int d = 0; d < ndim; d++)
+        partial = partial || L.dims[d] % L.chunk[d];
+    // partial edge chunks are stored unfiltered
+    if (partial && !L.filter_edge_chunks)
+        return false;
+    // the elements of partial edge chunks beyond the dataset
+    vector<unsigned char> fill;
+    if (partial)
+        fill = fillChunk(dset, L);
+
+    // Worker threads copy the chunks out of the input and encode them,
+    // at most window chunks ahead of the one being written.
+    // The chunks are written in order on this thread
+    struct slot_t
+    {
+        size_t index;
+        bool ready{false};
+        vector<unsigned char> data;
+    };
+    unsigned char *in = static_cast<unsigned char *>(const_cast<void *>(buf));
+    size_t window = 2 * nthreads;
+    vector<slot_t> slots(window);
+    mutex mtx;
+    condition_variable cv_ready, cv_space;
+    size_t next = 0, written = 0;
+    bool failed = false;
+
+    auto worker = [&]()
+    {
+        vector<unsigned char> tmp;
+        for (;;)
+        {
+            size_t i;
+            {
+                unique_lock<mutex> lock(mtx);
+                cv_space.wait(lock, [&]
+                              { return failed || next >= nchunks || next < written + window; });
+                if (failed || next >= nchunks)
+                    return;
+                i = next++;
+            }
+            slot_t &slot = slots[i % window];
+            if (fill.empty())
+                slot.data.assign(L.chunkBytes(), 0);
+            else
+                slot.data = fill;
+            copySelection(L, &offsets[i * ndim], slot.data.data(), in, true);
+            bool ok = encode(L, slot.data, tmp);
+            {
+                lock_guard<mutex> lock(mtx);
+                failed = failed || !ok;
+                slot.index = i;
+                slot.ready = true;
+            }
+            cv_ready.notify_all();
+        }
+    };
+
+    vector<thread> pool;
+    try
+    {
+        for (unsigned i = 0; i < std::min<size_t>(nthreads, nchunks); i++)
+            pool.emplace_back(worker);
+    }
+    catch (const std::system_error &)
+    {
+        lock_guard<mutex> lock(mtx);
+        failed = true;
+    }
+
+    for (size_t i = 0; i < nchunks && !pool.empty(); i++)
+    {
+        slot_t &slot = slots[i % window];
+        {
+            unique_lock<mutex> lock(mtx);
+            cv_ready.wait(lock, [&]
+                          { return failed || (slot.ready && slot.index == i); });
+            if (failed)
+                break;
+        }
+        herr_t err;
+        H5E_BEGIN_TRY
+        {
+            err = H5Dwrite_chunk(dset, H5P_DEFAULT, 0, &offsets[i * ndim],
+                                 slot.data.size(), slot.data.data());
+        }
+        H5E_END_TRY;
+        {
+            lock_guard<mutex> lock(mtx);
+            slot.ready = false;
+            written++;
+            failed = failed || err < 0;
+        }
+        cv_space.notify_all();
+    }
+    {
+        // wake up the workers if the loop ended early
+        lock_guard<mutex> lock(mtx);
+        if (written < nchunks)
+            failed = true;
+    }
+    cv_space.notify_all();
+    for (auto &t : pool)
+        t.join();
+    return !failed && !pool.empty();
+#else
+    return false;
+#endif
+}
+
+namespace
+{
+    struct elem16_t
+    {
+        uint64_t lo, hi;
+    };
+
+    // Tiled transpose of the rows [r0, r1) of a matrix with ncol columns:
+    // dst[r + c * dstr] = src[r * sstr + c]
+    template <class T>
+    void transposeRows(const T *src, T *dst, size_t r0, size_t r1, size_t ncol,
+                       size_t sstr, size_t dstr)
+    {
+        const size_t tile = sizeof(T) > 8 ? 16 : 32;
+        for (size_t rb = r0; rb < r1; rb += tile)
+        {
+            size_t re = std::min(rb + tile, r1);
+            for (size_t cb = 0; cb < ncol; cb += tile)
+            {
+                size_t ce = std::min(cb + tile, ncol);
+                for (size_t c = cb; c < ce; c++)
+                {
+                    const T *s = src + c;
+                    T *d = dst + c * dstr;
+                    for (size_t r = rb; r < re; r++)
+                        d[r] = s[r * sstr];
+                }
+            }
+        }
+    }
+
+    template <class T>
+    void reverseDims(const T *src, T *dst, int n, const hsize_t *dims, unsigned nthreads)
+    {
+        // element strides of src (C order) and dst (Fortran order)
+        size_t sstr[H5S_MAX_RANK], dstr[H5S_MAX_RANK];
+        sstr[n - 1] = 1;
+        for (int d = n - 2; d >= 0; d--)
+            sstr[d] = sstr[d + 1] * dims[d + 1];
+        dstr[0] = 1;
+        for (int d = 1; d < n; d++)
+            dstr[d] = dstr[d - 1] * dims[d - 1];
+
+        // The outermost and innermost dimensions are transposed in tiles,
+        // for each index of the middle ones. A task is a band of rows
+        // at one middle index
+        size_t nrow = dims[0], ncol = dims[n - 1], nmid = 1;
+        for (int d = 1; d < n - 1; d++)
+            nmid *= dims[d];
+        const size_t band = 256;
+        size_t nband = (nrow + band - 1) / band, ntasks = nmid * nband;
+        auto task = [&](size_t t)
+        {
+            size_t m = t / nband, r0 = t % nband * band, so = 0, doff = 0;
+            for (int d = n - 2; d >= 1; d--)
+            {
+                size_t i = m % dims[d];
+                m /= dims[d];
+                so += i * sstr[d];
+                doff += i * dstr[d];
+            }
+            transposeRows(src + so, dst + doff, r0, std::min(r0 + band, nrow), ncol,
+                          sstr[0], dstr[n - 1]);
+        };
+
+        // threads pay off for arrays larger than the caches
+        atomic<size_t> next{0};
+        auto worker = [&]()
+        {
+            for (size_t t; (t = next++) < ntasks;)
+                task(t);
+        };
+        size_t nt = nrow * nmid * ncol * sizeof(T) < (size_t(8) << 20)
+                        ? 1
+                        : std::min<size_t>(nthreads, ntasks);
+        vector<thread> pool;
+        try
+        {
+            for (size_t i = 1; i < nt; i++)
+                pool.emplace_back(worker);
+        }
+        catch (const std::system_error &)
+        {
+            // the remaining tasks are done on this thread
+        }
+        worker();
+        for (auto &t : pool)
+            t.join();
+    }
+} // namespace
+
+bool hdf5oct::reverseDims(const void *src, void *dst, int ndim, const hsize_t *dims,
+                          size_t elem_size, unsigned nthreads)
+{
+    // with at most one dimension > 1 the order is the same
+    size_t n = 1;
+    int nontrivial = 0;
+    for (int d = 0; d < ndim; d++)
+    {
+        n *= dims[d];
+        nontrivial += dims[d] > 1;
+    }
+    if (nontrivial < 2)
+    {
+        if (n)
+            std::memcpy(dst, src, n * elem_size);
+        return true;
+    }
+    switch (elem_size)
+    {
+    case 1:
+        ::reverseDims(static_cast<const uint8_t *>(src), static_cast<uint8_t *>(dst),
+                      ndim, dims, nthreads);
+        break;
+    case 2:
+        ::reverseDims(static_cast<const uint16_t *>(src), static_cast<uint16_t *>(dst),
+                      ndim, dims, nthreads);
+        break;
+    case 4:
+        ::reverseDims(static_cast<const uint32_t *>(src), static_cast<uint32_t *>(dst),
+                      ndim, dims, nthreads);
+        break;
+    case 8:
+        ::reverseDims(static_cast<const uint64_t *>(src), static_cast<uint64_t *>(dst),
+                      ndim, dims, nthreads);
+        break;
+    case 16:
+        ::reverseDims(static_cast<const elem16_t *>(src), static_cast<elem16_t *>(dst),
+                      ndim, dims, nthreads);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+hdf5oct::file_mapping::file_mapping(const std::string &path)
+{
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED)
+        {
+            addr = static_cast<unsigned char *>(p);
+            len = st.st_size;
+        }
+    }
+    ::close(fd); // the mapping stays valid
+#endif
+}
+
+hdf5oct::file_mapping::~file_mapping()
+{
+#ifndef _WIN32
+    if (addr)
+        munmap(addr, len);
+#endif
+}
+
+bool hdf5oct::readMapped(hid_t dset, hid_t mem_type, hid_t file_space, void *buf,
+                         const file_mapping &map)
+{
+    layout_t L;
+    if (!map.isValid() || !contiguousLayout(dset, file_space, L))
+        return false;
+
+    // the file must be accessed with the default driver,
+    // so that addresses are offsets in the file on disk
+    hid_t file = H5Iget_file_id(dset);
+    hid_t fapl = file < 0 ? -1 : H5Fget_access_plist(file);
+    bool ok = fapl >= 0 && H5Pget_driver(fapl) == H5FD_SEC2;
+    if (fapl >= 0)
+        H5Pclose(fapl);
+    if (file >= 0)
+        H5Fclose(file);
+    if (!ok)
+        return false;
+
+    // integer and floating point types are converted, others must match
+    hid_t ftype = H5Dget_type(dset);
+    if (ftype < 0)
+        return false;
+    bool same = H5Tequal(ftype, mem_type) > 0;
+    H5T_class_t fclass = H5Tget_class(ftype), mclass = H5Tget_class(mem_type);
+    ok = same || ((fclass == H5T_INTEGER || fclass == H5T_FLOAT) &&
+                  (mclass == H5T_INTEGER || mclass == H5T_FLOAT));
+    L.elem_size = H5Tget_size(ftype);
+    haddr_t offset = H5Dget_offset(dset);
+    ok = ok && offset != HADDR_UNDEF && offset + L.chunkBytes() <= map.size();
+    if (ok)
+    {
+        size_t n = 1, mem_size = H5Tget_size(mem_type);
+        for (int d = 0; d < L.ndim; d++)
+            n *= L.count[d];
+        unsigned char *out = static_cast<unsigned char *>(buf);
+        // conversion is done in place, in a buffer that fits both types
+        vector<unsigned char> tmp;
+        unsigned char *dst = out;
+        if (!same && mem_size < L.elem_size)
+        {
+            tmp.resize(n * L.elem_size);
+            dst = tmp.data();
+        }
+        hsize_t origin[H5S_MAX_RANK] = {};
+        // copySelection does not write to the chunk when to_chunk is false
+        copySelection(L, origin, const_cast<unsigned char *>(map.data() + offset), dst, false);
+        if (!same)
+        {
+            ok = H5Tconvert(ftype, mem_type, n, dst, nullptr, H5P_DEFAULT) >= 0;
+            if (ok && dst != out)
+                std::memcpy(out, dst, n * mem_size);
+        }
+    }
+    H5Tclose(ftype);
+    return ok;
+}
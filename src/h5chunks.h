@@ -0,0 +1,160 @@
+/*
+ *
+ *    Copyright (C) 2024 George Apostolopoulos
+ *
+ *    This file is part of hdf5oct.
+ *
+ *    hdf5oct is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU Lesser General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    hdf5oct is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public License
+ *    along with hdf5oct.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifndef _h5chunks_h_
+#define _h5chunks_h_
+
+#include <hdf5.h>
+
+#include <string>
+
+/*
+ * Direct access to raw dataset storage
+ *
+ * The HDF5 library runs the filter pipeline of a chunked dataset serially.
+ * The chunk functions below bypass the pipeline for the filters that hdf5oct
+ * creates (shuffle, deflate, fletcher32): the raw chunks are read or
+ * written with H5Dread_chunk/H5Dwrite_chunk on the calling thread, which
+ * is the only one calling the HDF5 library, while the chunks are
+ * decoded or encoded by a number of worker threads.
+ *
+ * Contiguous datasets can be read from a memory mapping of the file,
+ * skipping the HDF5 I/O layers altogether.
+ *
+ * Decoded chunks can also be stored with the dimensions reversed, for
+ * callers that want the data in the logical (C) order of the file.
+ */
+
+namespace hdf5oct
+{
+    /**
+     * @brief The default number of threads for chunk (de)compression
+     *
+     * A value of 1 (the default) leaves the filters to the HDF5 library.
+     */
+    unsigned &defaultThreads();
+
+    /**
+     * @brief Read a selection of a filtered, chunked dataset, decompressing the chunks in parallel
+     *
+     * Applies if all filters of the dataset are supported, all chunks
+     * touched by the selection are allocated and the memory type is the
+     * same as the dataset type, so that no conversion is needed.
+     * The selected elements are copied from the decoded chunks directly to @p buf.
+     *
+     * @param dset The dataset
+     * @param mem_type The memory datatype
+     * @param file_space The file dataspace, with all elements or a regular hyperslab selected
+     * @param buf The output buffer, the selection in C order
+     * @param nthreads The number of worker threads
+     * @param reversed Store the selection in Fortran instead of C order,
+     * i.e., with its dimensions reversed
+     * @return false If the dataset or selection is not supported, or
+     * a chunk could not be decoded. The data must then be read with H5Dread.
+     */
+    bool readChunksParallel(hid_t dset, hid_t mem_type, hid_t file_space, void *buf,
+                            unsigned nthreads, bool reversed = false);
+
+    /**
+     * @brief Write a chunk-aligned selection of a filtered, chunked dataset, compressing the chunks in parallel
+     *
+     * Applies if all filters of the dataset are supported, the memory
+     * type is the same as the dataset type and the selection consists of
+     * whole chunks, except for the edge chunks of the dataset. The chunks
+     * are encoded exactly as by the HDF5 library and written in order
+     * with H5Dwrite_chunk.
+     *
+     * @param dset The dataset
+     * @param mem_type The memory datatype
+     * @param file_space The file dataspace, with all elements or a regular hyperslab selected
+     * @param buf The input buffer, the selection in C order
+     * @param nthreads The number of worker threads
+     * @return false If the dataset or selection is not supported, or
+     * a chunk could not be encoded or written. The data must then be written with H5Dwrite.
+     */
+    bool writeChunksParallel(hid_t dset, hid_t mem_type, hid_t file_space, const void *buf,
+                             unsigned nthreads);
+
+    /**
+     * @brief Reverse the order of the dimensions of an array
+     *
+     * Copies an array from C to Fortran order, which transposes a matrix
+     * and permutes higher dimensional arrays as permute(x, ndim:-1:1).
+     * The outermost and innermost dimensions are copied in cache-sized
+     * tiles; arrays larger than the caches are split among @p nthreads threads.
+     *
+     * @param src The input, in C order
+     * @param dst The output, in Fortran order. It must not overlap @p src
+     * @param ndim The number of dimensions
+     * @param dims The dimensions, the slowest varying in @p src first
+     * @param elem_size The element size in bytes
+     * @param nthreads The maximum number of threads
+     * @return false If the element size is not 1, 2, 4, 8 or 16 bytes
+     */
+    bool reverseDims(const void *src, void *dst, int ndim, const hsize_t *dims,
+                     size_t elem_size, unsigned nthreads);
+
+    /**
+     * @brief A read-only memory mapping of an entire file
+     *
+     * Not available on Windows, where isValid() always returns false.
+     */
+    class file_mapping
+    {
+    public:
+        explicit file_mapping(const std::string &path);
+        ~file_mapping();
+        file_mapping(const file_mapping &) = delete;
+        file_mapping &operator=(const file_mapping &) = delete;
+
+        bool isValid() const { return addr != nullptr; }
+        const unsigned char *data() const { return addr; }
+        size_t size() const { return len; }
+
+    private:
+        unsigned char *addr{nullptr};
+        size_t len{0};
+    };
+
+    /**
+     * @brief Read a selection of a contiguous dataset from a memory mapping of its file
+     *
+     * Applies to allocated, contiguous datasets without external storage,
+     * in files opened with the default (sec2) driver. Integer and
+     * floating-point data are converted to @p mem_type with H5Tconvert,
+     * other types must match exactly. The mapping must be up to date, i.e.,
+     * the file must have been flushed after any writes.
+     *
+     * @param dset The dataset
+     * @param mem_type The memory datatype
+     * @param file_space The file dataspace, with all elements or a regular hyperslab selected
+     * @param buf The output buffer, the selection in C order
+     * @param map A mapping of the dataset's file
+     * @return false If the dataset, selection or type is not supported.
+     * The data must then be read with H5Dread.
+     */
+    bool readMapped(hid_t dset, hid_t mem_type, hid_t file_space, void *buf,
+                    const file_mapping &map);
+
+} // namespace hdf5oct
+
+#endif
@@ -0,0 +1,56 @@
+##
+##    Copyright (C) 2012 Tom Mullins
+##    Copyright (C) 2015 Tom Mullins, Thorsten Liebig, Anton Starikov, Stefan Großhauser
+##    Copyright (C) 2008-2013 Andrew Collette
+##    Copyright (C) 2024 George Apostolopoulos
+##
+##    This file is part of hdf5oct.
+##
+##    hdf5oct is free software: you can redistribute it and/or modify
+##    it under the terms of the GNU Lesser General Public License as published by
+##    the Free Software Foundation, either version 3 of the License, or
+##    (at your option) any later version.
+##
+##    hdf5oct is distributed in the hope that it will be useful,
+##    but WITHOUT ANY WARRANTY; without even the implied warranty of
+##    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+##    GNU Lesser General Public License for more details.
+##
+##    You should have received a copy of the GNU Lesser General Public License
+##    along with hdf5oct.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+
+# -*- texinfo -*-
+# @deftypefn  {Function File} { } h5close (@var{filename})
+# @deftypefnx {Function File} { } h5close ()
+#
+# Close a HDF5 file.
+#
+# @code{h5close (@var{filename})} closes the file @var{filename}
+# if it has been opened with @code{h5open} or if it is held open
+# in the hdf5oct file cache. All pending data are written to disk.
+#
+# @code{h5close ()} closes all open files.
+#
+# Files held in memory, @qcode{"mem://name"}, are discarded when closed.
+#
+# @seealso{h5open, h5flush, h5filecache}
+# @end deftypefn
+
+function h5close(filename)
+
+if nargin>1,
+    print_usage();
+endif
+
+if nargin==0,
+  __h5close__();
+else
+  if (!ischar(filename))
+    error("h5close: 1st argument must be a string holding the hdf5 file name");
+  endif
+  __h5close__(filename);
+endif
+
+endfunction
@@ -38,7 +38,9 @@
 # @table @asis
 # @item @var{filename}
 # The path of the HDF5 file as a string. If the file does not exist it
-# will be created.
+# will be created. A name of the form @qcode{"mem://name"} creates a file
+# held only in memory, which can be accessed by all hdf5oct functions
+# until it is closed with @code{h5close} (see also @code{h5serialize}).
 # @item @var{dsetname}
 # A string specifying the complete path to the dataset starting
 # from the root group "/". Intermediate groups
@@ -48,7 +50,8 @@
 # @var{size} may contain one or several Inf values.
 # This will lead to unlimited maximum extent of the dataset in the
 # respective dimensions and 0 initial extent.
-# Datasets with at least one unlimited dimension must be chunked.
+# Datasets with at least one unlimited dimension must be chunked;
+# if no @option{ChunkSize} is given, a chunk size is selected automatically.
 # Chunking is generally recommended for large datasets.
 #
 # @code{size==1} or @code{size==[1 1]} results in a scalar (0-dimensional)
@@ -84,9 +87,112 @@
 #
 # @item @option{ChunkSize}
 # The value may be either a vector specifying the chunk size,
-# or an empty vector [], which means no chunking (this is the default).
+# an empty vector [], which means no chunking (this is the default),
+# or @samp{auto}. In the latter case a chunk shape is selected
+# from the element size and the dimensions of the dataset,
+# taking into account @option{ChunkAccess} and @option{ChunkBytes}.
+# The selected chunk size is reported by @code{h5info}.
+#
+# @item @option{ChunkAccess}
+# The expected access pattern for @samp{auto} chunking:
+# @samp{row} | @samp{column} | @samp{frame}.
+# The chunk starts out one element thick across the dimensions that
+# a single row, @code{x(i,:,...)}, column, @code{x(:,j,...)}, or frame,
+# @code{x(:,...,:,k)}, does not span, and the other dimensions are halved
+# until the chunk fits the target size. If the chunk then falls short of
+# the target size, the restricted dimensions grow again until it reaches
+# the target size, so that a chunk may hold several rows, columns or
+# frames. Default is no preference.
+#
+# @item @option{ChunkBytes}
+# The target chunk size in bytes for @samp{auto} chunking.
+# The default is between 8 KiB and 1 MiB, depending on the size of
+# the dataset.
+#
+# @item @option{Deflate}
+# gzip compression level, an integer between 0 and 9.
+# The default is 0, i.e., no compression.
+#
+# @item @option{Shuffle}
+# If true, the shuffle filter is applied before compression.
+# Shuffling rearranges the bytes of the data elements and
+# often improves the compression ratio. Default is false.
+#
+# @item @option{Fletcher32}
+# If true, a Fletcher32 checksum is stored with each chunk
+# and verified on reading. Default is false.
+#
+# @item @option{FillValue}
+# The value of the elements that have not been written, a scalar
+# converted to @option{Datatype}, or a string for @samp{string} datasets.
+# The default is 0, or the empty string.
+# The fill value is reported by @code{h5info}.
+#
+# @item @option{AllocTime}
+# When the storage of the dataset is allocated in the file:
+# @samp{early}, when the dataset is created,
+# @samp{incremental}, chunk by chunk as the data are written, or
+# @samp{late}, when the dataset is first written.
+# The default is @samp{late} for contiguous and @samp{incremental}
+# for chunked datasets.
+#
+# @item @option{FillTime}
+# When the fill value is written to the allocated storage:
+# @samp{ifset}, if a @option{FillValue} was given (the default),
+# @samp{alloc}, always, or @samp{never}.
+# With @samp{never} the elements that have not been written
+# have undefined values. Together with @samp{late} allocation this
+# makes creating a large dataset instantaneous, when all of it will be
+# written anyway, while @samp{early} with @samp{never} reserves the
+# space in the file without writing to it.
+# @samp{never} cannot be used with @samp{string} datasets.
+#
+# @item @option{Transpose}
+# If true, @var{size} and @option{ChunkSize} are given in the row-major
+# order of the file, as in C and @code{h5py}, for data written and read
+# with the @option{Transpose} option of @code{h5write} and @code{h5read}.
+# @option{ChunkAccess} still refers to the octave dimensions.
+# Default is false.
+# @end table
+#
+# The following options set properties of the file, and are used only
+# when @code{h5create} creates it. They help with files holding many
+# small datasets, whose metadata would otherwise be scattered over the
+# file, making @code{h5info} and the first access to each dataset slow.
+#
+# @table @asis
+# @item @option{FileSpaceStrategy}
+# How file space is allocated: @samp{fsm_aggr} (the HDF5 default),
+# @samp{page}, @samp{aggr} or @samp{none}. With @samp{page} (paged
+# aggregation) metadata and raw data are allocated in separate pages,
+# so that the metadata of many objects are stored together.
+#
+# @item @option{FileSpacePageSize}
+# The page size in bytes for @samp{page} aggregation, at least 512.
+# The HDF5 default is 4096.
+#
+# @item @option{LatestFormat}
+# If true, objects are stored in the latest HDF5 file format, e.g.
+# large groups are indexed by B-trees. Such files cannot be read by
+# HDF5 versions before 1.10. Objects added to the file later in the
+# same session, by any hdf5oct function, also use the latest format.
+# Default is false.
+#
+# @item @option{MetadataBlockSize}
+# The minimum size in bytes of the blocks in which metadata is
+# allocated while the file stays open. The HDF5 default is 2048.
+#
+# @item @option{LinkCreationOrder}
+# If true, the root group, and the groups created by @code{h5create},
+# track and index the creation order of their members.
+# Default is false.
 # @end table
 #
+# Filters (@option{Deflate}, @option{Shuffle}, @option{Fletcher32}) require
+# a chunked dataset. If a filter, @option{ChunkAccess} or @option{ChunkBytes}
+# is requested without a @option{ChunkSize}, @samp{auto} chunking is used.
+# The filter pipeline of a dataset is reported by @code{h5info}.
+#
 # @seealso{h5write}
 # @end deftypefn
 
@@ -120,10 +226,26 @@ for i=1:length(sz),
 endfor
 
 ## check options
-[reg, datatype, chunksize, fillvalue] = parseparams (varargin, ...
+[reg, datatype, chunksize, chunkaccess, chunkbytes, fillvalue, ...
+  alloctime, filltime, deflate, shuffle, fletcher32, transpose, ...
+  fspacestrategy, fspacepagesize, latestformat, metablocksize, ...
+  linkorder] = parseparams (varargin, ...
   'Datatype', 'double',...
   'ChunkSize',[],...
-  'FillValue',0);
+  'ChunkAccess','',...
+  'ChunkBytes',0,...
+  'FillValue',[],...
+  'AllocTime','',...
+  'FillTime','',...
+  'Deflate',0,...
+  'Shuffle',false,...
+  'Fletcher32',false,...
+  'Transpose',false,...
+  'FileSpaceStrategy','',...
+  'FileSpacePageSize',0,...
+  'LatestFormat',false,...
+  'MetadataBlockSize',0,...
+  'LinkCreationOrder',false);
 
 # check datatype
 if !(strcmp(datatype,'double') || ...
@@ -142,28 +264,122 @@ if !(strcmp(datatype,'double') || ...
   strcmp(datatype,'string'))
   error("h5create: invalid 'Datatype'");
 endif
-# check
-if !isindex(sz) && isempty(chunksize)
-  error("h5create: chunksize must be defined for inf size datasets");
+# check the fill value and the allocation policy
+if strcmp(datatype,'string')
+  if !(isempty(fillvalue) || (ischar(fillvalue) && rows(fillvalue)<=1))
+    error("h5create: 'FillValue' of a string dataset must be a string");
+  endif
+elseif !(isempty(fillvalue) || (isscalar(fillvalue) && (isnumeric(fillvalue) || islogical(fillvalue))))
+  error("h5create: 'FillValue' must be a numeric scalar");
+elseif !isempty(fillvalue) && iscomplex(fillvalue) && isempty(strfind(datatype,'complex'))
+  error("h5create: complex 'FillValue' requires a complex 'Datatype'");
+endif
+if !(isempty(alloctime) || any(strcmp(alloctime,{'early','incremental','late'})))
+  error("h5create: 'AllocTime' must be one of 'early', 'incremental' or 'late'");
+endif
+if !(isempty(filltime) || any(strcmp(filltime,{'never','alloc','ifset'})))
+  error("h5create: 'FillTime' must be one of 'never', 'alloc' or 'ifset'");
+endif
+if strcmp(filltime,'never') && strcmp(datatype,'string')
+  error("h5create: 'FillTime' 'never' cannot be used with string datasets");
 endif
-if !isempty(chunksize)
+
+# check the file creation options
+if !(isempty(fspacestrategy) || any(strcmp(fspacestrategy,{'fsm_aggr','page','aggr','none'})))
+  error("h5create: 'FileSpaceStrategy' must be one of 'fsm_aggr', 'page', 'aggr' or 'none'");
+endif
+if !(isscalar(fspacepagesize) && (fspacepagesize==0 || (isindex(fspacepagesize) && fspacepagesize>=512)))
+  error("h5create: 'FileSpacePageSize' must be an integer of at least 512");
+endif
+if fspacepagesize>0 && !strcmp(fspacestrategy,'page')
+  error("h5create: 'FileSpacePageSize' requires 'FileSpaceStrategy' 'page'");
+endif
+if !(isscalar(latestformat) && (islogical(latestformat) || isreal(latestformat)))
+  error("h5create: 'LatestFormat' must be true or false");
+endif
+if !(isscalar(metablocksize) && (metablocksize==0 || isindex(metablocksize)))
+  error("h5create: 'MetadataBlockSize' must be a positive integer");
+endif
+if !(isscalar(linkorder) && (islogical(linkorder) || isreal(linkorder)))
+  error("h5create: 'LinkCreationOrder' must be true or false");
+endif
+
+# check filters
+if !(isscalar(deflate) && (deflate==0 || isindex(deflate)) && deflate<=9)
+  error("h5create: 'Deflate' must be an integer between 0 and 9");
+endif
+if !(isscalar(shuffle) && (islogical(shuffle) || isreal(shuffle)))
+  error("h5create: 'Shuffle' must be true or false");
+endif
+if !(isscalar(fletcher32) && (islogical(fletcher32) || isreal(fletcher32)))
+  error("h5create: 'Fletcher32' must be true or false");
+endif
+if !(isscalar(transpose) && (islogical(transpose) || isreal(transpose)))
+  error("h5create: 'Transpose' must be true or false");
+endif
+if (deflate>0 || shuffle || fletcher32) && (isequal(sz,1) || isequal(sz,[1;1]))
+  error("h5create: filters cannot be applied to a scalar dataset");
+endif
+
+# check chunking
+if !(isempty(chunkaccess) || any(strcmp(chunkaccess,{'row','column','frame'})))
+  error("h5create: 'ChunkAccess' must be one of 'row', 'column' or 'frame'");
+endif
+if !(isscalar(chunkbytes) && (chunkbytes==0 || isindex(chunkbytes)) && chunkbytes<2^32)
+  error("h5create: 'ChunkBytes' must be a positive integer less than 4 GiB");
+endif
+if isempty(chunksize) && (!isindex(sz) || deflate>0 || shuffle || fletcher32 || ...
+    !isempty(chunkaccess) || chunkbytes>0)
+  chunksize = 'auto';
+endif
+if ischar(chunksize)
+  if !strcmp(chunksize,'auto')
+    error("h5create: 'ChunkSize' must be a vector or 'auto'");
+  endif
+  if isequal(sz,1) || isequal(sz,[1;1])
+    error("h5create: a scalar dataset cannot be chunked");
+  endif
+elseif !isempty(chunksize)
   if size(chunksize(:))!=size(sz),
     error("h5create: chunksize is different size from 3rd argument");
   endif
   if !isindex(chunksize),
     error("h5create: invalid chunksize");
   endif
+  if !isempty(chunkaccess) || chunkbytes>0
+    error("h5create: 'ChunkAccess' and 'ChunkBytes' require 'ChunkSize' 'auto'");
+  endif
   chunksize = chunksize(:);
 endif
 
 if size(sz,1)==1, # convert [n] to [1xn]
   sz = [sz; 1];
-  if !isempty(chunksize)
+  if isnumeric(chunksize) && !isempty(chunksize)
     chunksize = [chunksize; 1];
   endif
 endif
+if transpose, # file order to octave order
+  sz = flipud(sz);
+  if isnumeric(chunksize) && !isempty(chunksize)
+    chunksize = flipud(chunksize);
+  endif
+endif
 
-__h5create__(filename,create_file,location,sz,datatype,chunksize,fillvalue);
+opts.ChunkSize = chunksize;
+opts.ChunkAccess = chunkaccess;
+opts.ChunkBytes = chunkbytes;
+opts.FillValue = fillvalue;
+opts.AllocTime = alloctime;
+opts.FillTime = filltime;
+opts.FileSpaceStrategy = fspacestrategy;
+opts.FileSpacePageSize = fspacepagesize;
+opts.LatestFormat = logical(latestformat);
+opts.MetadataBlockSize = metablocksize;
+opts.LinkCreationOrder = logical(linkorder);
+opts.Deflate = deflate;
+opts.Shuffle = logical(shuffle);
+opts.Fletcher32 = logical(fletcher32);
+__h5create__(filename,create_file,location,sz,datatype,opts);
 
 # tests for all functions in package
 
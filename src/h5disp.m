@@ -24,6 +24,7 @@
 # @deftypefn  {Function File} { } h5disp (@var{filename})
 # @deftypefnx {Function File} { } h5disp (@var{filename},@var{location})
 # @deftypefnx {Function File} { } h5disp (@var{filename},@var{location},@var{mode})
+# @deftypefnx {Function File} { } h5disp (@dots{},@var{key},@var{val},@dots{})
 #
 # Display the contents of a HDF5 file.
 #
@@ -36,24 +37,41 @@
 # @code{h5disp(@var{filename},@var{location},@var{mode})}, where @var{mode} is 'min', 
 # displays only the group and
 # dataset names. The default for mode is 'simple', which displays the dataset
-# metadata and attribute values.
+# metadata and the attribute names.
 #
-# @seealso{h5info}
+# The following @var{key}, @var{val} options are passed to @code{h5info}:
+#
+# @table @asis
+# @item @option{Attributes}
+# @samp{names} (default in 'simple' mode) displays the attribute names,
+# @samp{values} also reads and displays their values,
+# @samp{none} omits the attributes.
+# @item @option{Depth}
+# Number of group levels below @var{location} to display. The default is @code{Inf}.
+# @end table
+#
+# Reading the attribute values of a large file may take a long time,
+# thus by default only their names are displayed.
+#
+# @seealso{h5info, h5ls}
 # @end deftypefn
 
 
-function h5disp(filename,location,mode)
+function h5disp(filename,varargin)
 
-if nargin<1 || nargin>3,
+if nargin<1,
     print_usage();
 endif
 
-if nargin == 1
-    location = "/";
+location = "/";
+mode = 'simple';
+if numel(varargin)>0 && ischar(varargin{1}) && strncmp(varargin{1},'/',1),
+  location = varargin{1};
+  varargin(1) = [];
 endif
-
-if nargin < 3,
-  mode = 'simple';
+if numel(varargin)>0 && any(strcmpi(varargin{1},{'simple','min'})),
+  mode = varargin{1};
+  varargin(1) = [];
 endif
 
 mode = tolower(mode);
@@ -61,11 +79,22 @@ if !(strcmp(mode,'simple') || strcmp(mode,'min')),
   error("Invalid 'mode' option. Valid values: 'simple' or 'min'");
 endif
 
-info = h5info(filename,location);
+[reg, attributes, depth] = parseparams (varargin, ...
+  'Attributes', 'names', ...
+  'Depth', Inf);
+if !isempty(reg),
+  print_usage();
+endif
+
+if strcmp(mode,'simple'),
+  info = h5info(filename,location,'Attributes',attributes,'Depth',depth);
+else
+  info = h5info(filename,location,'Attributes','none','Datasets','names','Depth',depth);
+endif
 
 disp(["HDF5 " filename]);
 if strcmp(mode,'simple'),
-  __disph5__(info,0);
+  __disph5__(info,0,!strcmp(attributes,'names'));
 else
   __disph5_min__(info,0);
 endif
@@ -94,38 +123,60 @@ function s = disp_size(sz)
   endif
 endfunction
 
-function __dispAttr__(info, depth)
+function __dispAttr__(info, depth, values)
 n=numfields(info);
 if n==0, return; endif
 indent = blanks(2*depth);
 disp([indent "Attributes (" num2str(n) "):"]);
 names = fieldnames(info);
 for i=1:n
-    disp_indented(names{i},getfield(info,names{i}),depth+1)
+    if values,
+        disp_indented(names{i},getfield(info,names{i}),depth+1)
+    else
+        disp([blanks(2*depth+2) "'" names{i} "'"]);
+    endif
 endfor
 endfunction
 
-function __disph5__(info, depth)
+function __disph5__(info, depth, values)
 
 indent = blanks(2*depth);
 
 if isfield(info,"Groups"), # info is a group
     disp([indent "Group '" info.Name "'"]);
-    __dispAttr__(info.Attributes, depth+1);
+    __dispAttr__(info.Attributes, depth+1, values);
     datasets = info.Datasets;
-    for i=1:size(datasets,1) __disph5__(datasets(i),depth+1); endfor
+    for i=1:size(datasets,1) __disph5__(datasets(i),depth+1,values); endfor
     groups = info.Groups;
-    for i=1:size(groups,1) __disph5__(groups(i),depth+1); endfor
+    for i=1:size(groups,1) __disph5__(groups(i),depth+1,values); endfor
 elseif isfield(info,"Dataspace"), # info is a dataset
     disp([indent "Dataset '" info.Name "'"]);
-    __dispAttr__(info.Attributes, depth+1);
+    __dispAttr__(info.Attributes, depth+1, values);
     disp([indent "  Extent: " num2str(info.Dataspace.ExtentType)]);
     if !isempty(info.Dataspace.Size), disp([indent "  Size: " disp_size(info.Dataspace.Size)]); endif
     if !isempty(info.Dataspace.MaxSize), disp([indent "  MaxSize: " disp_size(double(info.Dataspace.MaxSize))]); endif
-    __disph5__(info.Datatype,depth+1);
+    __disph5__(info.Datatype,depth+1,values);
     if !isempty(info.ChunkSize)
         disp([indent "  ChunkSize: [" num2str(info.ChunkSize) "]"]);
     endif
+    if isfield(info,"FillValue") && !isempty(info.FillValue)
+        if ischar(info.FillValue)
+            disp([indent "  FillValue: '" info.FillValue "'"]);
+        else
+            disp([indent "  FillValue: " num2str(info.FillValue)]);
+        endif
+    endif
+    if isfield(info,"Filters") && !isempty(info.Filters)
+        names = cell(1,numel(info.Filters));
+        for i=1:numel(info.Filters)
+            f = info.Filters(i);
+            names{i} = f.Name;
+            if strcmp(f.Name,"deflate") && !isempty(f.Data)
+                names{i} = [f.Name "(" num2str(f.Data(1)) ")"];
+            endif
+        endfor
+        disp([indent "  Filters: " strjoin(names, ", ")]);
+    endif
 elseif isfield(info,"Class"), # info is a datatype
     disp([indent "Datatype"]);
     disp([indent "  Class: '" info.Class "'"]);
@@ -134,6 +185,7 @@ elseif isfield(info,"Class"), # info is a datatype
     if isfield(info,"Sign"), disp([indent "  Sign: " info.Sign]); endif
     if isfield(info,"charSet"), disp([indent "  charSet: " info.charSet]); endif
     if isfield(info,"Pading"), disp([indent "  Pading: " info.Pading]); endif
+    if isfield(info,"Fields"), disp([indent "  Fields: " strjoin(info.Fields, ", ")]); endif
 endif
 
 endfunction
@@ -0,0 +1,57 @@
+##
+##    Copyright (C) 2012 Tom Mullins
+##    Copyright (C) 2015 Tom Mullins, Thorsten Liebig, Anton Starikov, Stefan Großhauser
+##    Copyright (C) 2008-2013 Andrew Collette
+##    Copyright (C) 2024 George Apostolopoulos
+##
+##    This file is part of hdf5oct.
+##
+##    hdf5oct is free software: you can redistribute it and/or modify
+##    it under the terms of the GNU Lesser General Public License as published by
+##    the Free Software Foundation, either version 3 of the License, or
+##    (at your option) any later version.
+##
+##    hdf5oct is distributed in the hope that it will be useful,
+##    but WITHOUT ANY WARRANTY; without even the implied warranty of
+##    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+##    GNU Lesser General Public License for more details.
+##
+##    You should have received a copy of the GNU Lesser General Public License
+##    along with hdf5oct.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+
+# -*- texinfo -*-
+# @deftypefn  {Function File} { } h5flush (@var{filename})
+# @deftypefnx {Function File} { } h5flush ()
+#
+# Write to disk all pending data of an open HDF5 file.
+#
+# @code{h5flush (@var{filename})} flushes the file @var{filename}
+# which has been opened with @code{h5open}. The file stays open.
+#
+# @code{h5flush ()} flushes all open files.
+#
+# Asynchronous writes (@code{h5write (@dots{}, 'Async', true)}) to the
+# file, or to any file, are completed first. If any of them failed,
+# @code{h5flush} raises an error.
+#
+# @seealso{h5open, h5close, h5wait}
+# @end deftypefn
+
+function h5flush(filename)
+
+if nargin>1,
+    print_usage();
+endif
+
+if nargin==0,
+  __h5flush__();
+else
+  if (!ischar(filename))
+    error("h5flush: 1st argument must be a string holding the hdf5 file name");
+  endif
+  __h5flush__(filename);
+endif
+
+endfunction
@@ -23,25 +23,33 @@
 # -*- texinfo -*-
 # @deftypefn  {Function File} { @var{data} = } h5load (@var{filename})
 # @deftypefnx {Function File} { @var{data} = } h5load (@var{filename},@var{location})
+# @deftypefnx {Function File} { [@var{data}, @var{attr}] = } h5load (@dots{})
 #
 # Load an entire HDF5 file or a portion of it as a struct.
 #
 # @code{h5load(@var{filename})} loads all datasets in @var{filename} and returns
 # the struct @var{data}. Datasets and Groups become fields of the structure reproducting
-# the internal hierarchy of the HDF5 file. Attributes, datatypes and other components are
+# the internal hierarchy of the HDF5 file. Datatypes and other components are
 # not loaded.
 #  
-# @code{h5disp(@var{filename},@var{location})} loads all datasets in @var{filename} below
+# @code{h5load(@var{filename},@var{location})} loads all datasets in @var{filename} below
 # the node specified by @var{location}. If @var{location} is a group, then all datasets
 # and groups below it are returned in @var{data}. If @var{location} is a dataset, then only this
 # dataset will be returned.
 #
+# Attributes are read only if the second output @var{attr} is requested.
+# @var{attr} is a struct array with fields @samp{Name}, the path of a group or
+# dataset, and @samp{Attributes}, a struct holding its attributes, as returned
+# by @code{h5info}. Objects without attributes are not included.
+#
+# The file is traversed once, reading each dataset as it is found.
+#
 # This function is not provided by the MATLAB high-level HDF5 interface.
 #
 # @seealso{h5read}
 # @end deftypefn
 
-function data = h5load(filename,location)
+function [data, attr] = h5load(filename,location)
 
 if nargin<1 || nargin>2,
     print_usage();
@@ -51,50 +59,16 @@ if nargin == 1
     location = "/";
 endif
 
-info = h5info(filename,location);
-
-
-data = __h5load__(filename,info);
+if (!ischar(filename))
+  error("h5load: 1st argument must be a string holding the hdf5 file name");
+endif
+if (!isfile(filename) && !strncmp(filename, "mem://", 6))
+  error("h5load: filename does not exist");
+endif
+if (!ischar(location))
+  error("h5load: 2nd argument must be a string holding the location");
+endif
 
-endfunction
+[data, attr] = __h5load__(filename,location,nargout>1);
 
-function s = __dispAttr__(info, s)
-n=numfields(info);
-if n==0, return; endif
-names = fieldnames(info);
-for i=1:n
-    disp_indented(names{i},getfield(info,names{i}),depth+1)
-endfor
 endfunction
-
-function dataout = __h5load__(filename, info, datain)
-
-if isfield(info,"Groups"), # info is a group
-    g = struct(); # create a struct for the group
-    datasets = info.Datasets;
-    for i=1:size(datasets,1) # load all datasets as fields of the group
-      g = __h5load__(filename,datasets(i),g);
-    endfor
-    groups = info.Groups; # load all groups as fields of the group
-    for i=1:size(groups,1)
-      g = __h5load__(filename,groups(i),g);
-    endfor
-    if nargin==3,  # means that this group is a child of another group
-      dataout = datain;
-      name = strsplit(info.Name,"/"){end};
-      dataout.(name) = g; # store this group as a field of the parent struct
-    else
-      dataout = g; # else return the group directly
-    endif
-elseif isfield(info,"Dataspace"), # info is a dataset
-    dset = h5read(filename,info.Name); # read the dataset
-    if nargin==3, # means that this dataset is a child of a group
-      dataout = datain;
-      name = strsplit(info.Name,"/"){end}; # get just the name
-      dataout.(name) = dset; # return as a field of the parent struct
-    else
-      dataout = dset; # else return the dataset directly
-    endif
-endif
-
-endfunction
\ No newline at end of file
@@ -0,0 +1,107 @@
+##
+##    Copyright (C) 2012 Tom Mullins
+##    Copyright (C) 2015 Tom Mullins, Thorsten Liebig, Anton Starikov, Stefan Großhauser
+##    Copyright (C) 2008-2013 Andrew Collette
+##    Copyright (C) 2024 George Apostolopoulos
+##
+##    This file is part of hdf5oct.
+##
+##    hdf5oct is free software: you can redistribute it and/or modify
+##    it under the terms of the GNU Lesser General Public License as published by
+##    the Free Software Foundation, either version 3 of the License, or
+##    (at your option) any later version.
+##
+##    hdf5oct is distributed in the hope that it will be useful,
+##    but WITHOUT ANY WARRANTY; without even the implied warranty of
+##    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+##    GNU Lesser General Public License for more details.
+##
+##    You should have received a copy of the GNU Lesser General Public License
+##    along with hdf5oct.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+
+# -*- texinfo -*-
+# @deftypefn  {Function File} { } h5open (@var{filename})
+# @deftypefnx {Function File} { } h5open (@var{filename}, @var{mode})
+# @deftypefnx {Function File} { } h5open (@var{filename}, @var{mode}, @var{key}, @var{val}, ...)
+#
+# Open a HDF5 file and keep it open for subsequent calls.
+#
+# All hdf5oct functions keep recently accessed files open in a
+# cache (see @code{h5filecache}), so that repeated calls on the same file
+# do not pay the cost of opening and closing it.
+# @code{h5open} opens @var{filename} and pins it in the cache:
+# the file is not closed until @code{h5close} is called.
+#
+# @var{mode} is either @samp{r} (default), to open the file read-only, or
+# @samp{r+}, to open it for reading and writing.
+# A file opened read-only is re-opened automatically
+# when write access is requested, e.g., by @code{h5write}.
+#
+# Data written to a file opened with @code{h5open} may be kept
+# in memory by the HDF5 library. Use @code{h5flush} to write it to disk
+# or @code{h5close} to close the file.
+# Files that are not opened with @code{h5open} are flushed
+# after each write operation.
+#
+# The @var{key}, @var{val} arguments set the access properties used when
+# the file is opened read-only, @option{PageBufferSize},
+# @option{MetadataCacheSize}, @option{EvictOnClose}, @option{SWMR} and
+# @option{Core}, as described in @code{h5fileaccess}. They override the settings of
+# @code{h5fileaccess} for this file until it is closed with @code{h5close}.
+#
+# @code{h5open (@var{filename}, 'r+', 'SWMR', true)} opens the file for
+# writing in SWMR (single writer, multiple readers) mode, while other
+# processes read it with @code{h5open (@var{filename}, 'r', 'SWMR', true)}.
+# The writer may only write to, or append to, existing chunked datasets:
+# no datasets, groups or attributes can be created until @code{h5close}.
+# The file must have been created with
+# @code{h5create (..., 'LatestFormat', true)}.
+# After each @code{h5write} or @code{h5append} the file is flushed, so that
+# the readers see the new data, and @code{h5append} extends the dataset
+# exactly to the data written. The readers refresh the extent and the
+# data of a dataset on each @code{h5read} or @code{h5info}.
+#
+# @code{h5open (@var{filename}, 'r+', 'Core', true)} reads the whole file
+# into memory, with the HDF5 core driver. Reads and writes are made in
+# memory, and the file is written back to disk by @code{h5flush} and
+# @code{h5close}.
+#
+# @seealso{h5close, h5flush, h5filecache, h5fileaccess}
+# @end deftypefn
+
+function h5open(filename,mode,varargin)
+
+if nargin<1 || (nargin>2 && mod(nargin,2)!=0),
+    print_usage();
+endif
+if (!ischar(filename))
+  error("h5open: 1st argument must be a string holding the hdf5 file name");
+endif
+if (!isfile(filename) && !strncmp(filename, "mem://", 6))
+  error("h5open: filename does not exist");
+endif
+if nargin<2,
+  mode = 'r';
+endif
+if !(strcmp(mode,'r') || strcmp(mode,'r+'))
+  error("h5open: invalid mode. Valid values: 'r' or 'r+'");
+endif
+
+opts = struct();
+keys = {'PageBufferSize', 'MetadataCacheSize', 'EvictOnClose', 'SWMR', 'Core'};
+for i=1:2:numel(varargin)
+  k = [];
+  if ischar(varargin{i})
+    k = find(strcmpi(varargin{i}, keys));
+  endif
+  if isempty(k)
+    error("h5open: invalid option. Valid options: %s", strjoin(keys, ", "));
+  endif
+  opts.(keys{k}) = varargin{i+1};
+endfor
+
+__h5open__(filename,strcmp(mode,'r+'),opts);
+
+endfunction
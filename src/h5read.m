@@ -24,6 +24,9 @@
 # @deftypefn {Function File} {@var{data}=} h5read (@var{filename}, @var{dsetname})
 # @deftypefnx {Function File} {@var{data}=} h5read (@var{filename}, @var{dsetname}, @var{start}, @var{count})
 # @deftypefnx {Function File} {@var{data}=} h5read (@var{filename}, @var{dsetname}, @var{start}, @var{count}, @var{stride})
+# @deftypefnx {Function File} {@var{data}=} h5read (@var{filename}, @var{dsetname}, @var{points})
+# @deftypefnx {Function File} {@var{data}=} h5read (@var{filename}, @var{dsetname}, @var{mask})
+# @deftypefnx {Function File} {@var{data}=} h5read (@dots{}, @var{key}, @var{val}, @dots{})
 #
 # Read data from a HDF5 dataset.
 #
@@ -40,6 +43,17 @@
 # returns a subset of data with
 # the interval between the indices of each dimension of the dataset specified by stride.
 #
+# @code{data = h5read(@var{filename}, @var{dsetname}, @var{points})}
+# reads the elements at the coordinates in the rows of the
+# N-by-ndim matrix @var{points}, returning an N-by-1 vector
+# with the values in the same order.
+#
+# @code{data = h5read(@var{filename}, @var{dsetname}, @var{mask})}
+# reads the elements where the logical array @var{mask}, of the same size
+# as the dataset, is true. The result is a column vector, equal to
+# @code{x(@var{mask})} if @code{x} is the entire dataset, but only the selected
+# elements are read from the file.
+#
 # Input arguments:
 #
 # @table @asis
@@ -67,49 +81,182 @@
 # dataset, stride is a vector of length n. A value of 1 reads without 
 # skipping elements in the corresponding dimension, a value of 
 # 2 reads every other element, and so on.
+# @item @var{points}
+# Coordinates of the elements to read, specified as an N-by-ndim
+# matrix of 1-based indices. For a 1-D dataset, one or two columns
+# are accepted.
+# @item @var{mask}
+# Logical array of the same size as the dataset, selecting the elements to read.
+# @end table
+#
+# The following @var{key}, @var{val} options are supported:
+#
+# @table @asis
+# @item @option{ChunkCache}
+# Size of the HDF5 chunk cache of a chunked dataset.
+# The value is either a vector @code{[@var{nbytes} @var{nslots} @var{w0}]},
+# where @var{nslots} and @var{w0} are optional, or the string @samp{auto}.
+# @samp{auto} sizes the cache so that all chunks touched by the
+# selection fit in it (up to 256 MiB).
+# The dataset is kept open with this cache while the file is open,
+# so that subsequent calls on the same dataset can use the cached chunks.
+# The cache settings of a dataset are reported by @code{h5info}.
+# The default is the HDF5 chunk cache of 1 MiB.
+#
+# @item @option{OutputType}
+# Class of the returned array: @samp{native} (default), i.e., the class
+# corresponding to the dataset datatype, or one of
+# @samp{double} | @samp{single} | @samp{uint64} | @samp{int64} |
+# @samp{uint32} | @samp{int32} | @samp{uint16} | @samp{int16} |
+# @samp{uint8} | @samp{int8}.
+# The conversion is done by the HDF5 library while reading, so
+# no intermediate array of the native class is allocated.
+# Only numeric datasets can be converted; complex datasets
+# are returned as complex arrays of the requested precision.
+# HDF5 conversion rules apply: floating-point values are truncated
+# towards zero when converted to integers and
+# out-of-range values saturate.
+#
+# @item @option{ConversionBuffer}
+# Size in bytes of the buffer used by HDF5 for type conversion.
+# The default is 1 MiB.
+#
+# @item @option{Threads}
+# Number of threads decompressing the chunks of a dataset with
+# the @samp{deflate}, @samp{shuffle} or @samp{fletcher32} filters.
+# The default is the value set by @code{h5threads}.
+# See @code{h5threads} for when the parallel path applies.
+#
+# @item @option{MMap}
+# If true, a contiguous (not chunked) dataset is read from a memory
+# mapping of the file, copying the selected elements directly into the
+# result. This is much faster for repeated reads of small slices of a
+# file in the page cache. The mapping is kept while the file is open
+# (see @code{h5filecache}). Integer and floating-point data are converted
+# as needed. Chunked datasets, files opened with special drivers and
+# other datatypes are read by the HDF5 library. Not available on Windows.
+# The default is false.
+#
+# @item @option{Transpose}
+# If true, the data are returned in the row-major order of the file,
+# as seen by C programs and @code{h5py}: the result has the dimensions
+# of the dataset in the file instead of reversed, as
+# @code{permute(h5read(@dots{}), ndims:-1:1)}.
+# @var{start}, @var{count}, @var{stride}, the columns of @var{points}
+# and @var{mask} are then also given in this order.
+# The elements are reordered by a cache-blocked kernel, or directly
+# while the chunks are decompressed in parallel (see @option{Threads}).
+# 1-D datasets are not affected. The default is false.
+#
+# @item @option{TextType}
+# Class of the result for string datasets: @samp{cellstr} (default),
+# a cell array of the size of the selection, or @samp{char}, a char
+# matrix with one string per row, padded with blanks as by @code{char}.
+# Both are built from a single buffer holding all the strings, and
+# variable-length strings are read in batches of 65536, so that the
+# memory allocated for them by the HDF5 library stays bounded.
+# A @samp{char} matrix is much faster to create for many short strings.
+# Trailing null padding of fixed-length strings is removed.
+#
+# @item @option{Fields}
+# For a compound dataset, a table whose members are numeric, logical,
+# complex or strings, the result is a struct with one field per member,
+# each an array of the size of the selection. @option{Fields}, a string
+# or a cell array of strings, lists the members to read, in the order of
+# the fields of the result; the other members are not read at all.
+# The member names are listed by @code{h5info} in the @samp{Fields} of
+# the datatype. The default is all members.
 # @end table
 #
-# @seealso{h5create, h5write}
+# @seealso{h5create, h5write, h5threads}
 # @end deftypefn
 #
 
-function data = h5read(filename,location,start_pos,count,stride)
+function data = h5read(filename,location,varargin)
 
 # check number and types of arguments
-if !((nargin == 2) || (nargin==4) || (nargin==5))
+if nargin < 2,
     print_usage();
 endif
 if (!ischar(filename))
   error("h5read: 1st argument must be a string holding the hdf5 file name");
 endif
-if (!isfile(filename))
+if (!isfile(filename) && !strncmp(filename, "mem://", 6))
   error("h5read: filename does not exist");
 endif
 if (!ischar(location))
   error("h5read: 2nd argument must be a string holding the dataset location");
 endif
 
-if nargin==2,
-    start_pos = [];
-    count = [];
-    stride = [];
-else
-    start_pos = check_idx_vec(start_pos,'start');
-    count = check_idx_vec(count,'count');
-    if nargin==5,
-        stride = check_idx_vec(stride,'stride');
+[reg, chunkcache, outputtype, convbuffer, threads, mmap, transpose, texttype, fields] = parseparams (varargin, ...
+  'ChunkCache', [], ...
+  'OutputType', 'native', ...
+  'ConversionBuffer', 0, ...
+  'Threads', 0, ...
+  'MMap', false, ...
+  'Transpose', false, ...
+  'TextType', 'cellstr', ...
+  'Fields', {});
+
+nreg = numel(reg);
+if nreg > 3,
+    print_usage();
+endif
+start_pos = [];
+count = [];
+stride = [];
+if nreg==1,
+    opts = check_selection(reg{1});
+elseif nreg>1,
+    start_pos = check_idx_vec(reg{1},'start');
+    count = check_idx_vec(reg{2},'count');
+    if nreg==3,
+        stride = check_idx_vec(reg{3},'stride');
     else
         stride = [];
     endif
     if length(count)!=length(start_pos),
-        error(["h5write: count should have the same size as start"]);
+        error(["h5read: count should have the same size as start"]);
     endif
-    if nargin==6 && length(stride)!=length(start_pos),
-        error(["h5write: stride should have the same size as start"]);
+    if nreg==3 && length(stride)!=length(start_pos),
+        error(["h5read: stride should have the same size as start"]);
     endif
 endif
 
-data = __h5read__(filename,location,start_pos,count,stride);
+opts.ChunkCache = check_chunk_cache(chunkcache);
+if !(ischar(outputtype) && any(strcmp(outputtype, {'native', 'double', 'single', ...
+    'uint64', 'int64', 'uint32', 'int32', 'uint16', 'int16', 'uint8', 'int8'})))
+  error("h5read: invalid 'OutputType'");
+endif
+if !(isscalar(convbuffer) && (convbuffer==0 || isindex(convbuffer)))
+  error("h5read: 'ConversionBuffer' must be a positive integer");
+endif
+if !(isscalar(threads) && (threads==0 || isindex(threads)))
+  error("h5read: 'Threads' must be a positive integer");
+endif
+opts.OutputType = outputtype;
+opts.ConversionBuffer = double(convbuffer);
+if !(isscalar(mmap) && (islogical(mmap) || isnumeric(mmap)))
+  error("h5read: 'MMap' must be true or false");
+endif
+opts.Threads = double(threads);
+opts.MMap = logical(mmap);
+if !(isscalar(transpose) && (islogical(transpose) || isnumeric(transpose)))
+  error("h5read: 'Transpose' must be true or false");
+endif
+opts.Transpose = logical(transpose);
+if !(ischar(texttype) && any(strcmp(texttype, {'cellstr', 'char'})))
+  error("h5read: 'TextType' must be 'cellstr' or 'char'");
+endif
+opts.TextType = texttype;
+if !(ischar(fields) || iscellstr(fields))
+  error("h5read: 'Fields' must be a string or a cell array of strings");
+endif
+if !isempty(fields)
+  opts.Fields = cellstr(fields);
+endif
+
+data = __h5read__(filename,location,start_pos,count,stride,opts);
 
 endfunction
 
@@ -123,6 +270,30 @@ j = i(:);
 
 endfunction
 
+function opts = check_selection(s)
 
+if islogical(s),
+    opts.Mask = s;
+elseif isnumeric(s) && ismatrix(s) && !isempty(s) && isindex(s),
+    opts.Points = s;
+else
+    error("h5read: 3rd argument must be a matrix of point coordinates or a logical mask");
+endif
+
+endfunction
+
+function c = check_chunk_cache(c)
 
+if isempty(c) || (ischar(c) && strcmpi(c,'auto')),
+    c = tolower(c);
+    return
+endif
+if !(isnumeric(c) && isreal(c) && isvector(c) && numel(c)<=3 && all(c>=0)),
+    error("h5read: 'ChunkCache' must be 'auto' or [nbytes nslots w0]");
+endif
+if numel(c)==3 && c(3)>1,
+    error("h5read: 'ChunkCache' w0 must be between 0 and 1");
+endif
+c = double(c);
 
+endfunction
@@ -55,7 +55,7 @@ endif
 if (!ischar(filename))
   error("h5readatt: 1st argument must be a string holding the hdf5 file name");
 endif
-if (!isfile(filename))
+if (!isfile(filename) && !strncmp(filename, "mem://", 6))
   error("h5readatt: filename does not exist");
 endif
 if (!ischar(location))
@@ -0,0 +1,132 @@
+##
+##    Copyright (C) 2012 Tom Mullins
+##    Copyright (C) 2015 Tom Mullins, Thorsten Liebig, Anton Starikov, Stefan Großhauser
+##    Copyright (C) 2008-2013 Andrew Collette
+##    Copyright (C) 2024 George Apostolopoulos
+##
+##    This file is part of hdf5oct.
+##
+##    hdf5oct is free software: you can redistribute it and/or modify
+##    it under the terms of the GNU Lesser General Public License as published by
+##    the Free Software Foundation, either version 3 of the License, or
+##    (at your option) any later version.
+##
+##    hdf5oct is distributed in the hope that it will be useful,
+##    but WITHOUT ANY WARRANTY; without even the implied warranty of
+##    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+##    GNU Lesser General Public License for more details.
+##
+##    You should have received a copy of the GNU Lesser General Public License
+##    along with hdf5oct.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+# -*- texinfo -*-
+# @deftypefn {Function File} {@var{data}=} h5readmulti (@var{filename}, @var{dsetnames})
+# @deftypefnx {Function File} {@var{data}=} h5readmulti (@var{filename}, @var{dsetnames}, @var{start}, @var{count})
+# @deftypefnx {Function File} {@var{data}=} h5readmulti (@var{filename}, @var{dsetnames}, @var{start}, @var{count}, @var{stride})
+# @deftypefnx {Function File} {@var{data}=} h5readmulti (@dots{}, @var{key}, @var{val}, @dots{})
+#
+# Read data from several HDF5 datasets in one call.
+#
+# @code{data = h5readmulti(@var{filename}, @var{dsetnames})}
+# reads all the data from the datasets listed in the cell array of
+# strings @var{dsetnames}. @var{data} is a cell array of the same size as
+# @var{dsetnames} holding the data of each dataset.
+#
+# @var{start}, @var{count} and @var{stride} select a subset of the data,
+# as in @code{h5read}. Each of them is either a vector, which applies to
+# all datasets, or a cell array with one vector per dataset.
+# An empty entry reads the whole dataset.
+#
+# The file is opened once and the paths of the datasets are resolved
+# together, so that reading many small datasets is much faster than
+# calling @code{h5read} for each of them. With HDF5 1.14 or newer
+# all the datasets are read with a single @code{H5Dread_multi} call.
+#
+# The @option{OutputType} and @option{ConversionBuffer} options of
+# @code{h5read} are supported and apply to all datasets.
+#
+# This function is not provided by the MATLAB high-level HDF5 interface.
+#
+# @seealso{h5read}
+# @end deftypefn
+#
+
+function data = h5readmulti(filename,locations,varargin)
+
+# check number and types of arguments
+if nargin < 2,
+    print_usage();
+endif
+if (!ischar(filename))
+  error("h5readmulti: 1st argument must be a string holding the hdf5 file name");
+endif
+if (!isfile(filename) && !strncmp(filename, "mem://", 6))
+  error("h5readmulti: filename does not exist");
+endif
+if ischar(locations),
+  locations = {locations};
+endif
+if (!iscellstr(locations))
+  error("h5readmulti: 2nd argument must be a cell array of dataset locations");
+endif
+
+[reg, outputtype, convbuffer] = parseparams (varargin, ...
+  'OutputType', 'native', ...
+  'ConversionBuffer', 0);
+
+n = numel(locations);
+nreg = numel(reg);
+if !(nreg==0 || nreg==2 || nreg==3),
+    print_usage();
+endif
+start_pos = count = stride = cell(size(locations));
+if nreg>0,
+    start_pos = check_idx_cell(reg{1},'start',n);
+    count = check_idx_cell(reg{2},'count',n);
+    if nreg==3,
+        stride = check_idx_cell(reg{3},'stride',n);
+    endif
+    for i=1:n
+        if length(count{i})!=length(start_pos{i}),
+            error("h5readmulti: count should have the same size as start");
+        endif
+        if nreg==3 && !isempty(start_pos{i}) && length(stride{i})!=length(start_pos{i}),
+            error("h5readmulti: stride should have the same size as start");
+        endif
+    endfor
+endif
+
+if !(ischar(outputtype) && any(strcmp(outputtype, {'native', 'double', 'single', ...
+    'uint64', 'int64', 'uint32', 'int32', 'uint16', 'int16', 'uint8', 'int8'})))
+  error("h5readmulti: invalid 'OutputType'");
+endif
+if !(isscalar(convbuffer) && (convbuffer==0 || isindex(convbuffer)))
+  error("h5readmulti: 'ConversionBuffer' must be a positive integer");
+endif
+opts.OutputType = outputtype;
+opts.ConversionBuffer = double(convbuffer);
+
+data = __h5readmulti__(filename,locations,start_pos,count,stride,opts);
+
+endfunction
+
+function c = check_idx_cell(i, lbl, n)
+
+if !iscell(i),
+    i = repmat({i}, 1, n);
+elseif numel(i)!=n,
+    error(["h5readmulti: " lbl " must have one entry per dataset"]);
+endif
+c = cell(size(i));
+for k=1:n
+    if isempty(i{k}),
+        c{k} = [];
+    elseif !(isvector(i{k}) && isindex(i{k})),
+        error(["h5readmulti: " lbl " must be a vector of valid index values"]);
+    else
+        c{k} = i{k}(:);
+    endif
+endfor
+
+endfunction
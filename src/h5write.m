@@ -24,6 +24,10 @@
 # @deftypefn {Function File} { } h5write (@var{filename}, @var{dsetname}, @var{data})
 # @deftypefnx {Function File} { } h5write (@var{filename}, @var{dsetname}, @var{data}, @var{start}, @var{count})
 # @deftypefnx {Function File} { } h5write (@var{filename}, @var{dsetname}, @var{data}, @var{start}, @var{count}, @var{stride})
+# @deftypefnx {Function File} { } h5write (@var{filename}, @var{dsetname}, @var{data}, @var{points})
+# @deftypefnx {Function File} { } h5write (@var{filename}, @var{dsetname}, @var{data}, @var{mask})
+# @deftypefnx {Function File} { } h5write (@dots{}, @var{key}, @var{val}, @dots{})
+# @deftypefnx {Function File} {@var{h} =} h5write (@dots{}, 'Async', true)
 #
 # Write data to a HDF5 dataset.
 #
@@ -40,6 +44,13 @@
 # @code{h5write(filename,ds,data,start,count,stride)} specifies the spacing between
 # elements, @var{stride}, along each dimension of the dataset.
 #
+# @code{h5write(filename,ds,data,points)} writes the elements of @var{data}
+# to the coordinates in the rows of the N-by-ndim matrix @var{points}.
+# @code{h5write(filename,ds,data,mask)} writes them where the logical
+# array @var{mask}, of the same size as the dataset, is true,
+# as in @code{x(@var{mask}) = data}.
+# In both cases @var{data} may have any shape with the right number of elements.
+#
 # @table @asis
 # @item @var{filename}
 # Filename of an existing HDF5 file, specified as a string
@@ -81,46 +92,114 @@
 # 2 writes every other element, and so on.
 # @end table
 #
-# @seealso{h5create}
+# The following @var{key}, @var{val} options are supported:
+#
+# @table @asis
+# @item @option{ChunkCache}
+# Size of the HDF5 chunk cache of a chunked dataset,
+# specified as in @code{h5read}.
+#
+# @item @option{Threads}
+# Number of threads compressing the chunks of a dataset with
+# the @samp{deflate}, @samp{shuffle} or @samp{fletcher32} filters,
+# when the data cover whole chunks.
+# The default is the value set by @code{h5threads}.
+#
+# @item @option{Async}
+# If true, the data are queued for writing by a background thread
+# and @code{h5write} returns with a handle @var{h}, once it has
+# checked the data and the selection, which raise errors right away.
+# The data are not copied: the queue keeps a reference to the array,
+# which may thus be modified or cleared right away without affecting
+# what is written. Errors of the write itself are reported by
+# @code{h5wait(@var{h})} or @code{h5flush}. HDF5 is used by one thread
+# at a time: all hdf5oct functions, including the next @code{h5write},
+# first wait for the queued writes to complete. Other users of the
+# HDF5 library in the same process, such as @code{save -hdf5} and
+# @code{load} of HDF5 files, do not wait, and must be preceded by
+# @code{h5wait ()}. The amount of queued data is limited by
+# @code{h5writequeue}; when the queue is full @code{h5write} waits.
+#
+# @item @option{Transpose}
+# If true, @var{data} are given in the row-major order of the file,
+# as by @code{h5read(@dots{}, 'Transpose', true)}: the dimensions of
+# @var{data}, @var{start}, @var{count}, @var{stride}, the columns of
+# @var{points} and @var{mask} are those of the dataset in the file.
+# The elements are reordered by a cache-blocked kernel, without
+# calling @code{permute}. 1-D datasets are not affected.
+# The default is false.
+# @end table
+#
+# @seealso{h5create, h5threads, h5wait, h5writequeue}
 # @end deftypefn
 #
 
-function h5write(filename,location,data,start_pos,count,stride)
+function h = h5write(filename,location,data,varargin)
 
 # check number and types of arguments
-if !((nargin == 3) || (nargin==5) || (nargin==6))
+if nargin < 3,
     print_usage();
 endif
 if (!ischar(filename))
   error("h5write: 1st argument must be a string holding the hdf5 file name");
 endif
-if (!isfile(filename))
+if (!isfile(filename) && !strncmp(filename, "mem://", 6))
   error("h5write: filename does not exist");
 endif
 if (!ischar(location))
   error("h5write: 2nd argument must be a string holding the dataset location");
 endif
 
+[reg, chunkcache, threads, async, transpose] = parseparams (varargin, ...
+  'ChunkCache', [], ...
+  'Threads', 0, ...
+  'Async', false, ...
+  'Transpose', false);
+
 datasize = size(data);
 datasize = datasize(:);
 
-if nargin==3,
-    start_pos = [];
-    count = [];
-    stride = [];
-else
-    start_pos = check_idx_vec(start_pos,datasize,'start');
-    count = check_idx_vec(count,datasize,'count');
-    if nargin==6,
-        stride = check_idx_vec(stride,datasize,'stride');
+nreg = numel(reg);
+if nreg > 3,
+    print_usage();
+endif
+start_pos = [];
+count = [];
+stride = [];
+if nreg==1,
+    opts = check_selection(reg{1});
+elseif nreg>1,
+    start_pos = check_idx_vec(reg{1},datasize,'start');
+    count = check_idx_vec(reg{2},datasize,'count');
+    if nreg==3,
+        stride = check_idx_vec(reg{3},datasize,'stride');
     else
         stride = [];
     endif
 endif
 
+opts.ChunkCache = check_chunk_cache(chunkcache);
+if !(isscalar(threads) && (threads==0 || isindex(threads)))
+  error("h5write: 'Threads' must be a positive integer");
+endif
+opts.Threads = double(threads);
+if !(isscalar(async) && (islogical(async) || isnumeric(async)))
+  error("h5write: 'Async' must be true or false");
+endif
+opts.Async = logical(async);
+if !(isscalar(transpose) && (islogical(transpose) || isnumeric(transpose)))
+  error("h5write: 'Transpose' must be true or false");
+endif
+opts.Transpose = logical(transpose);
+
 if ischar(data), data = cellstr(data); endif
 
-__h5write__(filename,location,data,start_pos,count,stride);
+if opts.Async,
+  h = __h5write__(filename,location,data,start_pos,count,stride,opts);
+else
+  __h5write__(filename,location,data,start_pos,count,stride,opts);
+  if nargout > 0, h = []; endif
+endif
 
 endfunction
 
@@ -139,6 +218,30 @@ endif
 
 endfunction
 
+function opts = check_selection(s)
 
+if islogical(s),
+    opts.Mask = s;
+elseif isnumeric(s) && ismatrix(s) && !isempty(s) && isindex(s),
+    opts.Points = s;
+else
+    error("h5write: 4th argument must be a matrix of point coordinates or a logical mask");
+endif
 
+endfunction
 
+function c = check_chunk_cache(c)
+
+if isempty(c) || (ischar(c) && strcmpi(c,'auto')),
+    c = tolower(c);
+    return
+endif
+if !(isnumeric(c) && isreal(c) && isvector(c) && numel(c)<=3 && all(c>=0)),
+    error("h5write: 'ChunkCache' must be 'auto' or [nbytes nslots w0]");
+endif
+if numel(c)==3 && c(3)>1,
+    error("h5write: 'ChunkCache' w0 must be between 0 and 1");
+endif
+c = double(c);
+
+endfunction
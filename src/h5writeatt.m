@@ -56,7 +56,7 @@ endif
 if (!ischar(filename))
   error("h5writeatt: 1st argument must be a string holding the hdf5 file name");
 endif
-if (!isfile(filename))
+if (!isfile(filename) && !strncmp(filename, "mem://", 6))
   error("h5writeatt: filename does not exist");
 endif
 if (!ischar(location))
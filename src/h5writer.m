@@ -0,0 +1,77 @@
+##
+##    Copyright (C) 2024 George Apostolopoulos
+##
+##    This file is part of hdf5oct.
+##
+##    hdf5oct is free software: you can redistribute it and/or modify
+##    it under the terms of the GNU Lesser General Public License as published by
+##    the Free Software Foundation, either version 3 of the License, or
+##    (at your option) any later version.
+##
+##    hdf5oct is distributed in the hope that it will be useful,
+##    but WITHOUT ANY WARRANTY; without even the implied warranty of
+##    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+##    GNU Lesser General Public License for more details.
+##
+##    You should have received a copy of the GNU Lesser General Public License
+##    along with hdf5oct.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+# -*- texinfo -*-
+# @deftypefn {Function File} {@var{w} =} h5writer (@var{filename}, @var{dsetname})
+#
+# Open a HDF5 dataset for writing a stream of data blocks.
+#
+# @code{h5writer} returns a handle @var{w} to the existing dataset
+# @var{dsetname} in the HDF5 file @var{filename}, with the following methods:
+#
+# @table @code
+# @item @var{w}.write (@var{data}, @var{start})
+# Write the array @var{data} to the dataset starting at the 1-based
+# indices @var{start}, as @code{h5write (filename, dsetname, data, start, size (data))}.
+# Extendable datasets are extended along their unlimited dimensions as needed.
+#
+# @item @var{w}.close ()
+# Flush the file and release the dataset.
+# @end table
+#
+# The dataset stays open between calls, and the checks and dataspaces
+# prepared for a block are reused as long as the blocks have the same
+# class and size. Writing such a block then costs a single HDF5 write
+# call, compared to re-opening and checking the dataset in each
+# @code{h5write}. The data are flushed to disk when the writer is closed,
+# or when the last copy of @var{w} is cleared.
+#
+# Example:
+# @example
+# @group
+# h5create ('log.h5', '/D', [8 Inf], 'ChunkSize', [8 1024]);
+# w = h5writer ('log.h5', '/D');
+# for k = 1:1000
+#   w.write (rand (8, 1), [1 k]);
+# endfor
+# w.close ();
+# @end group
+# @end example
+#
+# @seealso{h5write, h5append, h5create}
+# @end deftypefn
+
+function w = h5writer(filename,location)
+
+if nargin != 2,
+    print_usage();
+endif
+if (!ischar(filename))
+  error("h5writer: 1st argument must be a string holding the hdf5 file name");
+endif
+if (!isfile(filename) && !strncmp(filename, "mem://", 6))
+  error("h5writer: filename does not exist");
+endif
+if (!ischar(location))
+  error("h5writer: 2nd argument must be a string holding the dataset location");
+endif
+
+w = __h5writer__(filename,location);
+
+endfunction
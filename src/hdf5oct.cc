@@ -25,42 +25,132 @@
 
 #include "hdf5oct.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
 using namespace std;
 namespace H5 = HighFive;
 namespace h5o = hdf5oct;
 
 // PKG_ADD: autoload("__h5read__","hdf5oct.oct")
+// PKG_ADD: autoload("__h5readmulti__","hdf5oct.oct")
 // PKG_ADD: autoload("__h5readatt__","hdf5oct.oct")
 // PKG_ADD: autoload("__h5write__","hdf5oct.oct")
+// PKG_ADD: autoload("__h5append__","hdf5oct.oct")
+// PKG_ADD: autoload("__h5writer__","hdf5oct.oct")
+// PKG_ADD: autoload("__h5blocks__","hdf5oct.oct")
 // PKG_ADD: autoload("__h5writeatt__","hdf5oct.oct")
 // PKG_ADD: autoload("__h5create__","hdf5oct.oct")
 // PKG_ADD: autoload("h5info","hdf5oct.oct")
+// PKG_ADD: autoload("h5ls","hdf5oct.oct")
+// PKG_ADD: autoload("__h5load__","hdf5oct.oct")
+// PKG_ADD: autoload("__h5open__","hdf5oct.oct")
+// PKG_ADD: autoload("__h5close__","hdf5oct.oct")
+// PKG_ADD: autoload("__h5flush__","hdf5oct.oct")
+// PKG_ADD: autoload("h5filecache","hdf5oct.oct")
+// PKG_ADD: autoload("h5fileaccess","hdf5oct.oct")
+// PKG_ADD: autoload("h5filestats","hdf5oct.oct")
+// PKG_ADD: autoload("h5serialize","hdf5oct.oct")
+// PKG_ADD: autoload("h5deserialize","hdf5oct.oct")
+// PKG_ADD: autoload("h5threads","hdf5oct.oct")
+// PKG_ADD: autoload("h5wait","hdf5oct.oct")
+// PKG_ADD: autoload("h5writequeue","hdf5oct.oct")
 
 // PKG_DEL: autoload("__h5read__","hdf5oct.oct","remove")
+// PKG_DEL: autoload("__h5readmulti__","hdf5oct.oct","remove")
 // PKG_DEL: autoload("__h5readatt__","hdf5oct.oct","remove")
 // PKG_DEL: autoload("__h5write__","hdf5oct.oct","remove")
+// PKG_DEL: autoload("__h5append__","hdf5oct.oct","remove")
+// PKG_DEL: autoload("__h5writer__","hdf5oct.oct","remove")
+// PKG_DEL: autoload("__h5blocks__","hdf5oct.oct","remove")
 // PKG_DEL: autoload("__h5writeatt__","hdf5oct.oct","remove")
 // PKG_DEL: autoload("__h5create__","hdf5oct.oct","remove")
 // PKG_DEL: autoload("h5info","hdf5oct.oct","remove")
+// PKG_DEL: autoload("h5ls","hdf5oct.oct","remove")
+// PKG_DEL: autoload("__h5load__","hdf5oct.oct","remove")
+// PKG_DEL: autoload("__h5open__","hdf5oct.oct","remove")
+// PKG_DEL: autoload("__h5close__","hdf5oct.oct","remove")
+// PKG_DEL: autoload("__h5flush__","hdf5oct.oct","remove")
+// PKG_DEL: autoload("h5filecache","hdf5oct.oct","remove")
+// PKG_DEL: autoload("h5fileaccess","hdf5oct.oct","remove")
+// PKG_DEL: autoload("h5filestats","hdf5oct.oct","remove")
+// PKG_DEL: autoload("h5serialize","hdf5oct.oct","remove")
+// PKG_DEL: autoload("h5deserialize","hdf5oct.oct","remove")
+// PKG_DEL: autoload("h5threads","hdf5oct.oct","remove")
+// PKG_DEL: autoload("h5wait","hdf5oct.oct","remove")
+// PKG_DEL: autoload("h5writequeue","hdf5oct.oct","remove")
 
-// __h5create__(fname,create_file,loc,sz,datatype,chunksize,fillvalue)
+// __h5create__(fname,create_file,loc,sz,datatype,opts)
 DEFUN_DLD(__h5create__, args, , "__h5create__: backend for h5create\n\
 Users should not use this directly. Use h5create.m instead")
 {
-    if (args.length() != 7)
+    if (args.length() != 6)
         error("__h5create__: wrong # of args");
     string filename = args(0).string_value();
     bool create_file = args(1).bool_value();
     string location = args(2).string_value();
     uint64NDArray size = args(3).uint64_array_value();
     string datatype = args(4).string_value();
-    uint64NDArray chunksize = args(5).uint64_array_value();
-    int fillvalue = args(6).int_value();
-    bool has_unlimited = !chunksize.isempty();
+    octave_scalar_map opts = args(5).scalar_map_value();
+
+    // ChunkSize is either a vector or 'auto'
+    octave_value chunkopt = opts.getfield("ChunkSize");
+    bool auto_chunk = chunkopt.is_string();
+    uint64NDArray chunksize;
+    if (!auto_chunk)
+        chunksize = chunkopt.uint64_array_value();
+    string chunk_access = opts.getfield("ChunkAccess").string_value();
+    size_t chunk_bytes = opts.getfield("ChunkBytes").double_value();
+    octave_value fillvalue = opts.getfield("FillValue");
+    string alloc_time = opts.getfield("AllocTime").string_value();
+    string fill_time = opts.getfield("FillTime").string_value();
+    int deflate = opts.getfield("Deflate").int_value();
+    bool shuffle = opts.getfield("Shuffle").bool_value();
+    bool fletcher32 = opts.getfield("Fletcher32").bool_value();
+    bool has_filters = deflate > 0 || shuffle || fletcher32;
+    string fspace_strategy = opts.getfield("FileSpaceStrategy").string_value();
+    hsize_t page_size = opts.getfield("FileSpacePageSize").double_value();
+    bool latest_format = opts.getfield("LatestFormat").bool_value();
+    hsize_t meta_block_size = opts.getfield("MetadataBlockSize").double_value();
+    bool link_order = opts.getfield("LinkCreationOrder").bool_value();
     try
     {
+        // first, as HDF5 must not be called while asynchronous writes run
+        h5o::file_cache &cache = h5o::file_cache::instance();
+
+        // File creation properties, used only if the file is created.
+        // Paged aggregation and larger metadata blocks keep the metadata
+        // of files with many small objects together, the latest format
+        // stores large groups in B-trees, with fast lookup by name
+        H5::FileCreateProps fcpl;
+        H5::FileAccessProps fapl;
+        unsigned order_flags = H5::CreationOrder::Tracked | H5::CreationOrder::Indexed;
+        if (create_file)
+        {
+            if (!fspace_strategy.empty())
+            {
+                H5F_fspace_strategy_t s = fspace_strategy == "page"   ? H5F_FSPACE_STRATEGY_PAGE
+                                          : fspace_strategy == "aggr" ? H5F_FSPACE_STRATEGY_AGGR
+                                          : fspace_strategy == "none" ? H5F_FSPACE_STRATEGY_NONE
+                                                                      : H5F_FSPACE_STRATEGY_FSM_AGGR;
+                fcpl.add(H5::FileSpaceStrategy(s, false, 1));
+            }
+            if (page_size > 0)
+                fcpl.add(H5::FileSpacePageSize(page_size));
+            if (link_order)
+                fcpl.add(H5::LinkCreationOrder(order_flags));
+            if (latest_format)
+                fapl.add(H5::FileVersionBounds(H5F_LIBVER_LATEST, H5F_LIBVER_LATEST));
+            if (meta_block_size > 0)
+                fapl.add(H5::MetadataBlockSize(meta_block_size));
+        }
+
         // open the hdf5 file, create it if it does not exist
-        H5::File file(filename, create_file ? H5::File::Create : H5::File::ReadWrite);
+        unsigned mode = create_file ? H5::File::Create : H5::File::ReadWrite;
+        H5::File file = cache.open(filename, mode, false, fcpl, fapl);
 
         // check location
         if (!h5o::validLocation(location))
@@ -73,13 +163,14 @@ Users should not use this directly. Use h5create.m instead")
                   location.c_str());
 
         // create dataspace
+        H5::DataType dtype = h5o::h5type_from_spec(datatype);
         H5::DataSpace fspace = H5::DataSpace::Scalar();
         size_t ndim = size.numel();
         bool is_scalar = (ndim == 1 && size_t(size(0)) == 1) ||
                          (ndim == 2 && size_t(size(0)) == 1 & size_t(size(1)) == 1);
+        vector<size_t> dims(ndim), maxdims(ndim);
         if (!is_scalar)
         {
-            vector<size_t> dims(ndim), maxdims(ndim);
             for (int i = 0; i < ndim; i++)
             {
                 bool b = size_t(size(i)) == H5::DataSpace::UNLIMITED;
@@ -88,21 +179,75 @@ Users should not use this directly. Use h5create.m instead")
             }
             fspace = H5::DataSpace(dims, maxdims);
         }
+        else if (has_filters)
+            error("h5create: filters cannot be applied to a scalar dataset");
+        else if (auto_chunk)
+            error("h5create: a scalar dataset cannot be chunked");
 
         // Modify dataset creation properties, i.e. enable chunking.
+        // Filters need chunking, if no chunk size is given make a guess
+        // taking into account the expected access pattern
         H5::DataSetCreateProps dscp;
-        if (has_unlimited)
+        if (!chunksize.isempty())
         {
             vector<hsize_t> chunk_dims(ndim);
             for (int i = 0; i < ndim; i++)
                 chunk_dims[ndim - 1 - i] = chunksize(i);
             dscp.add(H5::Chunking(chunk_dims));
         }
-        // Set fill value for the dataset
-        // cparms.setFillValue( PredType::NATIVE_INT, &fill_val);
+        else if (auto_chunk || has_filters)
+            dscp.add(H5::Chunking(h5o::guessChunkDims(dims, dtype.getSize(),
+                                                      chunk_access, chunk_bytes)));
+
+        // Set up the filter pipeline.
+        // Shuffle must precede deflate, the checksum is computed last.
+        if (shuffle)
+            dscp.add(H5::Shuffle());
+        if (deflate > 0)
+            dscp.add(H5::Deflate(deflate));
+        if (fletcher32 && H5Pset_fletcher32(dscp.getId()) < 0)
+            error("h5create: could not set the Fletcher32 filter");
+
+        // Fill value, converted to the dataset type, and the policies for
+        // allocating the storage and writing the fill value to it.
+        // Late allocation and no filling make creating a large dataset
+        // instantaneous, when all of it will be written anyway
+        if (!fillvalue.isempty() && !h5o::setFillValue(dscp, datatype, fillvalue))
+            error("h5create: could not set the fill value");
+        if (!alloc_time.empty())
+        {
+            H5D_alloc_time_t t = alloc_time == "early"         ? H5D_ALLOC_TIME_EARLY
+                                 : alloc_time == "incremental" ? H5D_ALLOC_TIME_INCR
+                                                               : H5D_ALLOC_TIME_LATE;
+            if (H5Pset_alloc_time(dscp.getId(), t) < 0)
+                error("h5create: could not set the allocation time");
+        }
+        if (!fill_time.empty())
+        {
+            H5D_fill_time_t t = fill_time == "never"   ? H5D_FILL_TIME_NEVER
+                                : fill_time == "alloc" ? H5D_FILL_TIME_ALLOC
+                                                       : H5D_FILL_TIME_IFSET;
+            if (H5Pset_fill_time(dscp.getId(), t) < 0)
+                error("h5create: could not set the fill time");
+        }
+
+        // intermediate groups track the creation order of their links, too
+        if (link_order)
+        {
+            H5::GroupCreateProps gcpl;
+            gcpl.add(H5::LinkCreationOrder(order_flags));
+            for (size_t pos = location.find('/', 1); pos != string::npos;
+                 pos = location.find('/', pos + 1))
+            {
+                string parent = location.substr(0, pos);
+                if (!file.exist(parent))
+                    file.createGroup(parent, gcpl, false);
+            }
+        }
 
         // create the dataset
-        file.createDataSet(location, fspace, h5o::h5type_from_spec(datatype), dscp);
+        file.createDataSet(location, fspace, dtype, dscp);
+        h5o::file_cache::instance().sync(file);
     }
     catch (const H5::Exception &e)
     {
@@ -111,21 +256,91 @@ Users should not use this directly. Use h5create.m instead")
     return octave_value_list();
 }
 
-// data = h5read(filename,dsname,start,count,stride)
+// Open a dataset applying the access options (ChunkCache) of h5read/h5write
+static H5::DataSet open_dataset(const H5::File &file, const string &location,
+                                const h5o::chunk_cache_t &cache,
+                                const uint64NDArray &start, const uint64NDArray &count,
+                                const uint64NDArray &stride)
+{
+    if (cache.mode == h5o::chunk_cache_t::None)
+        return file.getDataSet(location);
+    h5o::chunk_cache_t cc(cache);
+    {
+        H5::DataSet dset = file.getDataSet(location);
+        cc.configure(dset, start, count, stride);
+        if (cc.nslots == 0)
+            return dset; // not chunked
+    } // dset is closed here, so that the new cache settings can take effect
+    return h5o::file_cache::instance().openDataSet(file, location, cc);
+}
+
+// The permutation reversing n dimensions
+static Array<octave_idx_type> reversal(int n)
+{
+    Array<octave_idx_type> perm(dim_vector(1, n));
+    for (int i = 0; i < n; i++)
+        perm(i) = n - 1 - i;
+    return perm;
+}
+
+// With the 'Transpose' option the selection is given in HDF5 dimension
+// order. It is reversed here to octave order, except for 1-D datasets,
+// which are the same in both. Returns true if the option applies
+static bool transpose_selection(const H5::File &file, const string &location,
+                                const octave_scalar_map &opts, uint64NDArray &start,
+                                uint64NDArray &count, uint64NDArray &stride,
+                                octave_value &points, octave_value &mask)
+{
+    octave_value tr = opts.getfield("Transpose");
+    if (!(tr.is_defined() && tr.bool_value()))
+        return false;
+    int ndim = file.getDataSet(location).getSpace().getNumberDimensions();
+    if (ndim < 2)
+        return false;
+
+    for (uint64NDArray *v : {&start, &count, &stride})
+    {
+        octave_idx_type n = v->numel();
+        for (octave_idx_type i = 0; i < n / 2; i++)
+            std::swap((*v)(i), (*v)(n - 1 - i));
+    }
+    if (points.is_defined())
+    {
+        uint64NDArray P = points.uint64_array_value(), Q(P.dims());
+        octave_idx_type nr = P.rows(), nc = P.cols();
+        for (octave_idx_type j = 0; j < nc; j++)
+            for (octave_idx_type i = 0; i < nr; i++)
+                Q(i, nc - 1 - j) = P(i, j);
+        points = Q;
+    }
+    if (mask.is_defined())
+    {
+        boolNDArray M = mask.bool_array_value();
+        mask = boolNDArray(M.permute(reversal(std::max(ndim, M.ndims()))));
+    }
+    return true;
+}
+
+// data = h5read(filename,dsname,start,count,stride,opts)
 DEFUN_DLD(__h5read__, args, , "__h5read__: backend for h5read\n\
 Users should not use this directly. Use h5read.m instead")
 {
-    if (args.length() != 5)
+    if (args.length() != 6)
         error("__h5read__: wrong # of args");
     string filename = args(0).string_value();
     string location = args(1).string_value();
     uint64NDArray start = args(2).uint64_array_value();
     uint64NDArray count = args(3).uint64_array_value();
     uint64NDArray stride = args(4).uint64_array_value();
+    octave_scalar_map opts = args(5).scalar_map_value();
+
+    h5o::chunk_cache_t cache;
+    if (!cache.assign(opts.getfield("ChunkCache")))
+        error("h5read: %s", h5o::lastError.c_str());
 
     try
     {
-        H5::File file(filename, H5::File::ReadOnly);
+        H5::File file = h5o::file_cache::instance().open(filename, H5::File::ReadOnly);
 
         // check that location is valid, exists and that it is a dataset
         if (!h5o::validLocation(location))
@@ -135,9 +350,14 @@ Users should not use this directly. Use h5read.m instead")
         else if (file.getObjectType(location) != H5::ObjectType::Dataset)
             error("h5read: location '%s' is not a Dataset", location.c_str());
 
+        octave_value points = opts.getfield("Points");
+        octave_value mask = opts.getfield("Mask");
+        bool transposed = transpose_selection(file, location, opts, start, count, stride,
+                                              points, mask);
+
         // Create file dx struct
         h5o::data_exchange dxfile;
-        H5::DataSet dset = file.getDataSet(location);
+        H5::DataSet dset = open_dataset(file, location, cache, start, count, stride);
         if (!dxfile.assign(&dset))
             error("h5read: dataset %s: %s", location.c_str(),
                   h5o::lastError.c_str());
@@ -146,6 +366,51 @@ Users should not use this directly. Use h5read.m instead")
         if (!start.isempty() && !dxfile.selectHyperslab(start, count, stride, false))
             error("h5read: hyperslab selection: %s", h5o::lastError.c_str());
 
+        // or a list of points, or a mask
+        if (points.is_defined() && !dxfile.selectPoints(points.uint64_array_value()))
+            error("h5read: point selection: %s", h5o::lastError.c_str());
+        if (mask.is_defined() && !dxfile.selectMask(mask.bool_array_value()))
+            error("h5read: mask selection: %s", h5o::lastError.c_str());
+        // a list of elements is returned as such
+        dxfile.transposed = transposed && !dxfile.element_list;
+
+        // if requested, convert to another class while reading
+        octave_value outtype = opts.getfield("OutputType");
+        octave_value convbuf = opts.getfield("ConversionBuffer");
+        if ((outtype.is_defined() && !dxfile.setOutputType(outtype.string_value())) ||
+            (convbuf.is_defined() && !dxfile.setConversionBuffer(convbuf.double_value())))
+            error("h5read: %s", h5o::lastError.c_str());
+
+        // if requested, read contiguous datasets from a mapping of the file
+        octave_value mmap = opts.getfield("MMap");
+        if (mmap.is_defined() && mmap.bool_value())
+            dxfile.mapping = h5o::file_cache::instance().mapFile(file);
+
+        // threads for decoding compressed chunks, 0 for the h5threads setting
+        octave_value threads = opts.getfield("Threads");
+        if (threads.is_defined() && threads.double_value() > 0)
+            dxfile.nthreads = threads.double_value();
+
+        octave_value texttype = opts.getfield("TextType");
+        dxfile.char_strings = texttype.is_defined() && texttype.string_value() == "char";
+
+        // the members of a compound dataset to read
+        octave_value fields = opts.getfield("Fields");
+        if (fields.is_defined())
+        {
+            if (dxfile.dtype_spec != "struct")
+                error("h5read: 'Fields' applies to compound datasets only");
+            const vector<string> &all = dxfile.dtype_info.fields;
+            Array<string> names = fields.cellstr_value();
+            for (octave_idx_type i = 0; i < names.numel(); i++)
+            {
+                if (std::find(all.begin(), all.end(), names(i)) == all.end())
+                    error("h5read: dataset %s has no field '%s'", location.c_str(),
+                          names(i).c_str());
+                dxfile.fields.push_back(names(i));
+            }
+        }
+
         return dxfile.read();
     }
     catch (const H5::Exception &e)
@@ -154,22 +419,136 @@ Users should not use this directly. Use h5read.m instead")
     }
 }
 
-// h5write(filename,ds,data,start,count,stride)
-DEFUN_DLD(__h5write__, args, , "__h5write__: backend for h5write\n\
-Users should not use this directly. Use h5write.m instead")
+// data = __h5readmulti__(filename,locations,start,count,stride,opts)
+DEFUN_DLD(__h5readmulti__, args, , "__h5readmulti__: backend for h5readmulti\n\
+Users should not use this directly. Use h5readmulti.m instead")
 {
     if (args.length() != 6)
-        error("__h5write__: wrong # of args");
+        error("__h5readmulti__: wrong # of args");
     string filename = args(0).string_value();
-    string location = args(1).string_value();
-    octave_value data = args(2);
-    uint64NDArray start = args(3).uint64_array_value();
-    uint64NDArray count = args(4).uint64_array_value();
-    uint64NDArray stride = args(5).uint64_array_value();
+    Cell locations = args(1).cell_value();
+    Cell start = args(2).cell_value();
+    Cell count = args(3).cell_value();
+    Cell stride = args(4).cell_value();
+    octave_scalar_map opts = args(5).scalar_map_value();
+    octave_idx_type n = locations.numel();
+    if (start.numel() != n || count.numel() != n || stride.numel() != n)
+        error("__h5readmulti__: start, count and stride must have one entry per location");
+    octave_value outtype = opts.getfield("OutputType");
+    octave_value convbuf = opts.getfield("ConversionBuffer");
+
+    try
+    {
+        H5::File file = h5o::file_cache::instance().open(filename, H5::File::ReadOnly);
+
+        // Open all datasets and select the hyperslabs.
+        // Intermediate groups shared by the locations are checked only once
+        map<string, bool> known;
+        vector<H5::DataSet> dsets;
+        vector<h5o::data_exchange> dx(n);
+        dsets.reserve(n); // dx keeps pointers to the datasets
+        for (octave_idx_type i = 0; i < n; i++)
+        {
+            string location = locations(i).string_value();
+            if (!h5o::validLocation(location))
+                error("h5readmulti: %s", h5o::lastError.c_str());
+            if (!h5o::locationExists(file, location, known))
+                error("h5readmulti: location %s does not exist", location.c_str());
+            else if (file.getObjectType(location) != H5::ObjectType::Dataset)
+                error("h5readmulti: location '%s' is not a Dataset", location.c_str());
+
+            dsets.push_back(file.getDataSet(location));
+            if (!dx[i].assign(&dsets.back()))
+                error("h5readmulti: dataset %s: %s", location.c_str(),
+                      h5o::lastError.c_str());
+            uint64NDArray s = start(i).uint64_array_value();
+            if (!s.isempty() &&
+                !dx[i].selectHyperslab(s, count(i).uint64_array_value(),
+                                       stride(i).uint64_array_value(), false))
+                error("h5readmulti: dataset %s: hyperslab selection: %s",
+                      location.c_str(), h5o::lastError.c_str());
+            if ((outtype.is_defined() && !dx[i].setOutputType(outtype.string_value())) ||
+                (convbuf.is_defined() && !dx[i].setConversionBuffer(convbuf.double_value())))
+                error("h5readmulti: dataset %s: %s", location.c_str(),
+                      h5o::lastError.c_str());
+        }
+
+        // Allocate the output arrays. Strings are read right away,
+        // all other datasets are read together below
+        Cell data(locations.dims());
+        vector<hid_t> dset_ids, mem_type_ids, mem_space_ids, file_space_ids;
+        vector<H5::DataType> mem_types;
+        vector<H5::DataSpace> mem_spaces;
+        vector<void *> bufs;
+        vector<h5o::data_exchange::allocation> arrays(n);
+        for (octave_idx_type i = 0; i < n; i++)
+        {
+            H5::DataType mem_type;
+            if (!dx[i].allocate(arrays[i], mem_type))
+            {
+                data(i) = dx[i].read();
+                continue;
+            }
+            mem_types.push_back(mem_type);
+            mem_spaces.push_back(dx[i].memSpace());
+            dset_ids.push_back(dsets[i].getId());
+            mem_type_ids.push_back(mem_type.getId());
+            mem_space_ids.push_back(mem_spaces.back().getId());
+            file_space_ids.push_back(dx[i].dspace.getId());
+            bufs.push_back(arrays[i].data());
+        }
+        if (bufs.empty())
+            return octave_value(data);
+
+        hid_t xfer_id = dx[0].xfer_props.getId();
+#if H5_VERSION_GE(1, 14, 0)
+        // a single I/O request for all datasets
+        if (H5Dread_multi(bufs.size(), dset_ids.data(), mem_type_ids.data(),
+                          mem_space_ids.data(), file_space_ids.data(),
+                          xfer_id, bufs.data()) < 0)
+            H5::HDF5ErrMapper::ToException<H5::DataSetException>(
+                "Error during HDF5 Read");
+#else
+        for (size_t i = 0; i < bufs.size(); i++)
+            if (H5Dread(dset_ids[i], mem_type_ids[i], mem_space_ids[i],
+                        file_space_ids[i], xfer_id, bufs[i]) < 0)
+                H5::HDF5ErrMapper::ToException<H5::DataSetException>(
+                    "Error during HDF5 Read");
+#endif
+        for (octave_idx_type i = 0; i < n; i++)
+            if (arrays[i].data())
+                data(i) = arrays[i].value();
+        return octave_value(data);
+    }
+    catch (const H5::Exception &e)
+    {
+        error("%s", e.what());
+    }
+}
+
+// The body of h5write. With async, the write itself is queued to the
+// thread of async_queue, and its job id returned. Everything else, the
+// checks, the selection and the conversion of the data, is done here,
+// on the interpreter thread, so that the job makes no octave calls
+static uint64_t write_dataset(const string &filename, const string &location,
+                              const octave_value &data, uint64NDArray start,
+                              uint64NDArray count, uint64NDArray stride,
+                              const octave_scalar_map &opts, bool async)
+{
+    h5o::chunk_cache_t cache;
+    if (!cache.assign(opts.getfield("ChunkCache")))
+        error("h5write: %s", h5o::lastError.c_str());
 
+    // the ids and the buffer of an asynchronous write
+    hid_t ds, mt, ms, fs;
+    const void *buf;
+    std::shared_ptr<const void> hold;
+    unsigned nthreads;
+    H5F_scope_t scope;
+    bool flush;
     try
     {
-        H5::File file(filename, H5::File::ReadWrite);
+        H5::File file = h5o::file_cache::instance().open(filename, H5::File::ReadWrite);
 
         // check that location is valid, exists and that it is a dataset
         if (!h5o::validLocation(location))
@@ -179,12 +558,18 @@ Users should not use this directly. Use h5write.m instead")
         else if (file.getObjectType(location) != H5::ObjectType::Dataset)
             error("h5write: location '%s' is not a Dataset", location.c_str());
 
-        // Create file dx struct
+        octave_value points = opts.getfield("Points");
+        octave_value mask = opts.getfield("Mask");
+        bool transposed = transpose_selection(file, location, opts, start, count, stride,
+                                              points, mask);
+
+        // Create file dx struct. A dataset extended by h5append is first
+        // trimmed to its logical size, which h5write may then extend
         h5o::data_exchange dxfile;
-        H5::DataSet dset = file.getDataSet(location);
+        H5::DataSet dset = open_dataset(file, location, cache, start, count, stride);
+        h5o::trimDataset(dset);
         if (!dxfile.assign(&dset))
-            error("h5write: dataset %s: %s", location.c_str(),
-                  h5o::lastError.c_str());
+            error("h5write: dataset %s: %s", location.c_str(), h5o::lastError.c_str());
 
         // Create octave data dx struct
         h5o::data_exchange dxmem;
@@ -197,10 +582,231 @@ Users should not use this directly. Use h5write.m instead")
         if (!start.isempty() && !dxfile.selectHyperslab(start, count, stride, true))
             error("h5write: hyperslab selection: %s", h5o::lastError.c_str());
 
+        if (points.is_defined() && !dxfile.selectPoints(points.uint64_array_value()))
+            error("h5write: point selection: %s", h5o::lastError.c_str());
+        if (mask.is_defined() && !dxfile.selectMask(mask.bool_array_value()))
+            error("h5write: mask selection: %s", h5o::lastError.c_str());
+        // a list of elements may have any shape
+        if (transposed && !dxfile.element_list)
+            dxmem.transpose(dxfile.dspace_info.size.numel());
+
         if (!dxmem.isCompatible(dxfile))
             error("h5write: incompatible dataset and octave data: %s", h5o::lastError.c_str());
 
+        // threads for compressing chunks, 0 for the h5threads setting
+        octave_value threads = opts.getfield("Threads");
+        if (threads.is_defined() && threads.double_value() > 0)
+            dxmem.nthreads = threads.double_value();
+
+        if (!async)
+        {
+            dxmem.write(dxfile);
+            h5o::file_cache::instance().sync(file);
+            return 0;
+        }
+
+        // The job gets references of its own to the ids, which it
+        // releases when done. The objects here are released before
+        // the job is queued, as HDF5 is used by one thread at a time
+        flush = h5o::file_cache::instance().syncScope(file, scope);
+        h5o::data_exchange::write_buffer b;
+        dxmem.prepareWrite(b);
+        buf = b.data;
+        hold = b.hold;
+        ds = dset.getId();
+        mt = b.mem_type.getId();
+        ms = dxmem.dspace.getId();
+        fs = dxfile.dspace.getId();
+        for (hid_t id : {ds, mt, ms, fs})
+            H5Iinc_ref(id);
+        nthreads = dxmem.nthreads;
+    }
+    catch (const H5::Exception &e)
+    {
+        error("%s", e.what());
+    }
+    // hold keeps the buffer until the job is released by this thread
+    return h5o::async_queue::instance().submit(
+        filename, data,
+        [ds, mt, ms, fs, buf, hold, nthreads, flush, scope]()
+        {
+            string err;
+            try
+            {
+                h5o::data_exchange::writeRaw(ds, mt, ms, fs, buf, nthreads);
+                if (flush)
+                    H5::detail::h5f_flush(ds, scope);
+            }
+            catch (const std::exception &e)
+            {
+                err = e.what();
+            }
+            for (hid_t id : {ds, mt, ms, fs})
+                H5Idec_ref(id);
+            if (!err.empty())
+                throw std::runtime_error(err);
+        });
+}
+
+// Raise the errors of failed asynchronous writes
+static void report_async_errors(const char *fname, const vector<string> &errors)
+{
+    if (errors.size() == 1)
+        error("%s: asynchronous write failed: %s", fname, errors[0].c_str());
+    else if (errors.size() > 1)
+        error("%s: %d asynchronous writes failed, the first with: %s",
+              fname, int(errors.size()), errors[0].c_str());
+}
+
+// h5write(filename,ds,data,start,count,stride,opts)
+DEFMETHOD_DLD(__h5write__, interp, args, , "__h5write__: backend for h5write\n\
+Users should not use this directly. Use h5write.m instead")
+{
+    if (args.length() != 7)
+        error("__h5write__: wrong # of args");
+    string filename = args(0).string_value();
+    string location = args(1).string_value();
+    octave_value data = args(2);
+    uint64NDArray start = args(3).uint64_array_value();
+    uint64NDArray count = args(4).uint64_array_value();
+    uint64NDArray stride = args(5).uint64_array_value();
+    octave_scalar_map opts = args(6).scalar_map_value();
+
+    // queue the write and return its id
+    octave_value async = opts.getfield("Async");
+    if (async.is_defined() && async.bool_value())
+    {
+        // the I/O thread must not be unloaded
+        interp.mlock();
+        uint64_t id = write_dataset(filename, location, data, start, count, stride, opts, true);
+        return octave_value(double(id));
+    }
+
+    write_dataset(filename, location, data, start, count, stride, opts, false);
+    return octave_value_list();
+}
+
+// __h5append__(filename,location,data,dim)
+DEFUN_DLD(__h5append__, args, , "__h5append__: backend for h5append\n\
+Users should not use this directly. Use h5append.m instead")
+{
+    if (args.length() != 4)
+        error("__h5append__: wrong # of args");
+    string filename = args(0).string_value();
+    string location = args(1).string_value();
+    octave_value data = args(2);
+    int dim = args(3).int_value(); // octave dimension, 0 for the last one
+
+    try
+    {
+        H5::File file = h5o::file_cache::instance().open(filename, H5::File::ReadWrite);
+
+        // check that location is valid, exists and that it is a dataset
+        if (!h5o::validLocation(location))
+            error("h5append: %s", h5o::lastError.c_str());
+        if (!h5o::locationExists(file, location))
+            error("h5append: location %s does not exist", location.c_str());
+        else if (file.getObjectType(location) != H5::ObjectType::Dataset)
+            error("h5append: location '%s' is not a Dataset", location.c_str());
+
+        H5::DataSet dset = file.getDataSet(location);
+        H5::DataSpace space = dset.getSpace();
+        if (H5Sget_simple_extent_type(space.getId()) != H5S_SIMPLE)
+            error("h5append: dataset %s is not an array", location.c_str());
+        int rank = space.getNumberDimensions();
+        if (dim == 0)
+            dim = rank;
+        if (rank > 1 && dim > rank)
+            error("h5append: dataset %s has %d dimensions", location.c_str(), rank);
+        int j = rank == 1 ? 0 : rank - dim; // in HDF5 order
+
+        // size of the data along the dataset dimensions, in HDF5 order
+        dim_vector ddv = data.dims();
+        vector<size_t> count(rank);
+        if (rank == 1)
+        {
+            if (ddv.ndims() > 2 || (ddv(0) != 1 && ddv(1) != 1))
+                error("h5append: data must be a vector for a 1D dataset");
+            count[0] = data.numel();
+        }
+        else
+        {
+            if (ddv.ndims() > rank)
+                error("h5append: data has more dimensions than the dataset");
+            for (int i = 0; i < rank; i++)
+                count[rank - 1 - i] = i < ddv.ndims() ? ddv(i) : 1;
+        }
+
+        vector<size_t> dims = h5o::logicalDims(dset), alloc = space.getDimensions(),
+                       maxdims = space.getMaxDimensions();
+        for (int k = 0; k < rank; k++)
+            if (k != j && count[k] != dims[k])
+                error("h5append: the data must have the size of dataset %s, "
+                      "except along dimension %d",
+                      location.c_str(), dim);
+        if (count[j] == 0)
+            return octave_value_list();
+        size_t offset = dims[j];
+        dims[j] += count[j];
+        if (dims[j] > maxdims[j])
+            error("h5append: dataset %s cannot be extended along dimension %d",
+                  location.c_str(), dim);
+
+        // grow the extent geometrically, by at least one chunk,
+        // and keep the logical size in an attribute.
+        // In SWMR mode no attributes may be written, the extent is exact
+        if (dims[j] > alloc[j] && h5o::isSWMRWriter(file))
+        {
+            alloc[j] = dims[j];
+            dset.resize(alloc);
+        }
+        else if (dims[j] > alloc[j])
+        {
+            uint64NDArray chunk = h5o::getChunkSize(dset);
+            size_t grow = std::max(2 * alloc[j], chunk.isempty() ? size_t(1) : size_t(chunk(rank - 1 - j)));
+            alloc[j] = std::min(std::max(dims[j], grow), maxdims[j]);
+            dset.resize(alloc);
+        }
+        bool over_allocated = dims != alloc;
+        if (over_allocated)
+        {
+            vector<uint64_t> size(dims.begin(), dims.end());
+            if (dset.hasAttribute(h5o::appendSizeAttr))
+                dset.getAttribute(h5o::appendSizeAttr).write(size);
+            else
+                dset.createAttribute<uint64_t>(h5o::appendSizeAttr, H5::DataSpace::From(size))
+                    .write(size);
+        }
+        else if (dset.hasAttribute(h5o::appendSizeAttr))
+            dset.deleteAttribute(h5o::appendSizeAttr);
+
+        // write the data after the current end
+        h5o::data_exchange dxfile, dxmem;
+        if (!dxfile.assign(&dset))
+            error("h5append: dataset %s: %s", location.c_str(), h5o::lastError.c_str());
+        uint64NDArray start(dim_vector(rank, 1)), cnt(dim_vector(rank, 1));
+        for (int i = 0; i < rank; i++)
+        {
+            int k = rank - 1 - i;
+            start(i) = (k == j ? offset : 0) + 1;
+            cnt(i) = count[k];
+        }
+        if (!dxfile.selectHyperslab(start, cnt, uint64NDArray(), false))
+            error("h5append: hyperslab selection: %s", h5o::lastError.c_str());
+        if (!dxmem.assign(data))
+            error("h5append: octave data: %s", h5o::lastError.c_str());
+        if (dxmem.dtype_spec == "string" && dxfile.dtype_info.size != H5T_VARIABLE)
+            error("h5append: export of string data is supported only to variable size HDF5 string datasets");
+        // the data may lack trailing singleton dimensions, so only
+        // the number of elements is compared
+        dxmem.element_list = true;
+        if (!dxmem.isCompatible(dxfile))
+            error("h5append: incompatible dataset and octave data: %s", h5o::lastError.c_str());
         dxmem.write(dxfile);
+
+        if (over_allocated && !h5o::file_cache::instance().trackAppend(file, location))
+            h5o::trimDataset(dset);
+        h5o::file_cache::instance().sync(file);
     }
     catch (const H5::Exception &e)
     {
@@ -209,6 +815,64 @@ Users should not use this directly. Use h5write.m instead")
     return octave_value_list();
 }
 
+// w = __h5writer__(filename,location)
+DEFMETHOD_DLD(__h5writer__, interp, args, , "__h5writer__: backend for h5writer\n\
+Users should not use this directly. Use h5writer.m instead")
+{
+    if (args.length() != 2)
+        error("__h5writer__: wrong # of args");
+    string filename = args(0).string_value();
+    string location = args(1).string_value();
+
+    static bool type_registered = false;
+    if (!type_registered)
+    {
+        h5o::h5writer::register_type();
+        type_registered = true;
+    }
+    // the type must not be unloaded while handles exist
+    interp.mlock();
+
+    try
+    {
+        return octave_value(new h5o::h5writer(filename, location));
+    }
+    catch (const H5::Exception &e)
+    {
+        error("%s", e.what());
+    }
+}
+
+// it = __h5blocks__(filename,location,dim,blocksize)
+DEFMETHOD_DLD(__h5blocks__, interp, args, , "__h5blocks__: backend for h5blocks\n\
+Users should not use this directly. Use h5blocks.m instead")
+{
+    if (args.length() != 4)
+        error("__h5blocks__: wrong # of args");
+    string filename = args(0).string_value();
+    string location = args(1).string_value();
+    int dim = args(2).int_value();                   // 0 for the last dimension
+    size_t blocksize = args(3).double_value(); // 0 for one chunk
+
+    static bool type_registered = false;
+    if (!type_registered)
+    {
+        h5o::h5blocks::register_type();
+        type_registered = true;
+    }
+    // the type and the prefetching thread must not be unloaded
+    interp.mlock();
+
+    try
+    {
+        return octave_value(new h5o::h5blocks(filename, location, dim, blocksize));
+    }
+    catch (const H5::Exception &e)
+    {
+        error("%s", e.what());
+    }
+}
+
 template <class H5Obj>
 octave_value read_attr(const H5Obj &obj, const string &attrname)
 {
@@ -234,7 +898,7 @@ Users should not use this directly. Use h5readatt.m instead")
 
     try
     {
-        H5::File file(filename, H5::File::ReadOnly);
+        H5::File file = h5o::file_cache::instance().open(filename, H5::File::ReadOnly);
 
         // check that location is valid & exists
         if (!h5o::validLocation(location))
@@ -280,7 +944,7 @@ Users should not use this directly. Use h5writeatt.m instead")
 
     try
     {
-        H5::File file(filename, H5::File::ReadWrite);
+        H5::File file = h5o::file_cache::instance().open(filename, H5::File::ReadWrite);
 
         // check that location is valid & exists
         if (!h5o::validLocation(location))
@@ -315,6 +979,7 @@ Users should not use this directly. Use h5writeatt.m instead")
         default:
             error("h5writeatt: location has unsupported object type");
         }
+        h5o::file_cache::instance().sync(file);
     }
     catch (const H5::Exception &e)
     {
@@ -326,17 +991,34 @@ Users should not use this directly. Use h5writeatt.m instead")
 
 DEFUN_DLD(h5info, args, argout, "-*- texinfo -*- \n\
 @deftypefn {Loadable Function} {@var{info}=} h5info (@var{filename}) \n\
-@deftypefnx {Loadable Function} {@var{info}=} h5info (@var{filename}, @var{location}) \n\n\
+@deftypefnx {Loadable Function} {@var{info}=} h5info (@var{filename}, @var{location}) \n\
+@deftypefnx {Loadable Function} {@var{info}=} h5info (@dots{}, @var{key}, @var{val}, @dots{}) \n\n\
 Return information about the content of a HDF5 file.\n\n\
 @code{info = h5info(@var{filename})} returns information about an entire HDF5 file.\n\n\
 @code{info = h5info(@var{filename},@var{location})} returns \
 information about the specified location in the HDF5 file.\n\n\
 The return value, @var{info}, is a structure with detailed information \
 on the groups, datasets, and datatypes contained in the file.\n\n\
-@seealso{h5disp}\n@end deftypefn")
+The following @var{key}, @var{val} options limit the information collected, \
+which is much faster for large files:\n\n\
+@table @asis\n\
+@item @option{Depth}\n\
+Number of group levels below @var{location} whose members are listed. \
+Groups at that level are returned with empty @samp{Groups}, @samp{Datasets} \
+and @samp{Datatypes}. The default is @code{Inf}.\n\
+@item @option{Attributes}\n\
+@samp{values} (default) or @code{true} reads the attributes, \
+@samp{names} returns the attribute names with empty values, \
+@samp{none} or @code{false} skips the attributes.\n\
+@item @option{Datasets}\n\
+@samp{full} (default) describes the datatype, dataspace, chunking and \
+filters of each dataset, @samp{names} returns only the dataset names, \
+with the other fields empty.\n\
+@end table\n\n\
+@seealso{h5disp, h5ls}\n@end deftypefn")
 {
     int nargin = args.length();
-    if (nargin < 1 || nargin > 2)
+    if (nargin < 1 || (nargin > 2 && nargin % 2 != 0))
     {
         print_usage();
         return octave_value();
@@ -348,7 +1030,7 @@ on the groups, datasets, and datatypes contained in the file.\n\n\
     }
     string filename = args(0).string_value();
     string location("/");
-    if (nargin == 2)
+    if (nargin >= 2)
     {
         if (!(args(1).is_string()))
         {
@@ -358,10 +1040,49 @@ on the groups, datasets, and datatypes contained in the file.\n\n\
         location = args(1).string_value();
     }
 
+    // parse options
+    h5o::info_opts_t opts;
+    for (int i = 2; i < nargin; i += 2)
+    {
+        string key = args(i).xstring_value("h5info: option name must be a string");
+        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+        octave_value val = args(i + 1);
+        if (key == "depth")
+        {
+            double d = val.is_real_scalar() ? val.double_value() : -1;
+            if (!(d >= 0 && (d == std::round(d) || std::isinf(d))))
+                error("h5info: 'Depth' must be a non-negative integer or Inf");
+            opts.depth = std::isinf(d) ? -1 : int(d);
+        }
+        else if (key == "attributes")
+        {
+            string v = val.is_string() ? val.string_value() : "";
+            if (val.is_bool_scalar())
+                v = val.bool_value() ? "values" : "none";
+            if (v == "values")
+                opts.attributes = h5o::info_opts_t::AttributeValues;
+            else if (v == "names")
+                opts.attributes = h5o::info_opts_t::AttributeNames;
+            else if (v == "none")
+                opts.attributes = h5o::info_opts_t::NoAttributes;
+            else
+                error("h5info: 'Attributes' must be 'values', 'names', 'none', true or false");
+        }
+        else if (key == "datasets")
+        {
+            string v = val.is_string() ? val.string_value() : "";
+            if (v != "full" && v != "names")
+                error("h5info: 'Datasets' must be 'full' or 'names'");
+            opts.dataset_details = v == "full";
+        }
+        else
+            error("h5info: unknown option '%s'", args(i).string_value().c_str());
+    }
+
     octave_scalar_map info;
     try
     {
-        H5::File file(filename, H5::File::ReadOnly);
+        H5::File file = h5o::file_cache::instance().open(filename, H5::File::ReadOnly);
 
         // check that location is valid & exists
         if (!h5o::validLocation(location))
@@ -374,14 +1095,14 @@ on the groups, datasets, and datatypes contained in the file.\n\n\
         case H5::ObjectType::Group:
         {
             h5o::group_info_t I;
-            I.assign(file.getGroup(location), location);
+            I.assign(file.getGroup(location), location, opts);
             info = I.oct_map();
         }
         break;
         case H5::ObjectType::Dataset:
         {
             h5o::dset_info_t I;
-            I.assign(file.getDataSet(location), location);
+            I.assign(file.getDataSet(location), location, opts);
             info = I.oct_map();
         }
         break;
@@ -397,900 +1118,3654 @@ on the groups, datasets, and datatypes contained in the file.\n\n\
     return octave_value_list(info);
 }
 
-HighFive::DataType hdf5oct::h5type_from_spec(const std::string &dtype_spec)
+DEFUN_DLD(h5ls, args, nargout, "-*- texinfo -*- \n\
+@deftypefn {Loadable Function} {} h5ls (@var{filename}) \n\
+@deftypefnx {Loadable Function} {} h5ls (@var{filename}, @var{location}) \n\
+@deftypefnx {Loadable Function} {[@var{names}, @var{types}] =} h5ls (@dots{}) \n\n\
+List the members of a group in a HDF5 file.\n\n\
+@code{h5ls(@var{filename},@var{location})} lists the names and object types \
+of the members of the group @var{location}, by default the root group. \
+The objects are not opened and no attributes are read, so \
+that even very large groups are listed quickly.\n\n\
+With output arguments, @var{names} and @var{types} are column cell arrays \
+with the member names and their types: @samp{Group}, @samp{Dataset}, \
+@samp{Datatype}, @samp{External Link} (not followed) or @samp{Soft Link} \
+(a dangling soft link).\n\n\
+This function is not provided by the MATLAB high-level HDF5 interface.\n\n\
+@seealso{h5info, h5disp}\n@end deftypefn")
 {
-    if (dtype_spec == "double")
-        return h5traits<double>::predType();
-    else if (dtype_spec == "single")
-        return h5traits<float>::predType();
-    else if (dtype_spec == "double complex")
-        return h5traits<std::complex<double>>::predType();
-    else if (dtype_spec == "single complex")
-        return h5traits<std::complex<float>>::predType();
-    else if (dtype_spec == "uint64")
-        return h5traits<uint64_t>::predType();
-    else if (dtype_spec == "int64")
-        return h5traits<int64_t>::predType();
-    else if (dtype_spec == "uint32")
-        return h5traits<uint32_t>::predType();
-    else if (dtype_spec == "int32")
-        return h5traits<int32_t>::predType();
-    else if (dtype_spec == "uint16")
-        return h5traits<uint16_t>::predType();
-    else if (dtype_spec == "int16")
-        return h5traits<int16_t>::predType();
-    else if (dtype_spec == "uint8")
-        return h5traits<uint8_t>::predType();
-    else if (dtype_spec == "int8")
-        return h5traits<int8_t>::predType();
-    else if (dtype_spec == "logical")
-        return h5traits<bool>::predType();
-    else if (dtype_spec == "string")
-        return h5traits<std::string>::predType();
-    return HighFive::DataType();
-}
+    int nargin = args.length();
+    if (nargin < 1 || nargin > 2 || !args(0).is_string() ||
+        (nargin == 2 && !args(1).is_string()))
+    {
+        print_usage();
+        return octave_value();
+    }
+    string filename = args(0).string_value();
+    string location = nargin == 2 ? args(1).string_value() : "/";
 
-string h5_concat_path(const string &path, const string &obj_name)
-{
-    string p(path);
-    if (path.back() != '/')
-        p += '/';
-    p += obj_name;
-    return p;
-}
+    vector<h5o::link_info_t> links;
+    try
+    {
+        H5::File file = h5o::file_cache::instance().open(filename, H5::File::ReadOnly);
 
-void hdf5oct::dspace_info_t::assign(const H5::DataSpace &ds)
-{
-    int ndim;
-    switch (H5Sget_simple_extent_type(ds.getId()))
+        if (!h5o::validLocation(location))
+            error("h5ls: %s", h5o::lastError.c_str());
+        if (!h5o::locationExists(file, location))
+            error("h5ls: location '%s' does not exist", location.c_str());
+        if (file.getObjectType(location) != H5::ObjectType::Group)
+            error("h5ls: location '%s' is not a Group", location.c_str());
+
+        links = h5o::listGroupMembers(file.getGroup(location));
+    }
+    catch (const H5::Exception &e)
     {
-    case H5S_SIMPLE:
-        extent_type = "Simple";
-        ndim = ds.getNumberDimensions();
-        size = uint64NDArray(dim_vector(1, ndim));
-        maxsize = uint64NDArray(dim_vector(1, ndim));
+        error("%s", e.what());
+    }
+
+    Cell names(dim_vector(links.size(), 1)), types(dim_vector(links.size(), 1));
+    for (size_t i = 0; i < links.size(); i++)
+    {
+        string type;
+        switch (links[i].obj_type)
         {
-            auto dims = ds.getDimensions();
-            auto maxdims = ds.getMaxDimensions();
-            for (octave_idx_type i = 0; i < ndim; i++)
-            {
-                size(i) = dims[ndim - 1 - i];
-                maxsize(i) = maxdims[ndim - i - 1];
-            }
+        case H5O_TYPE_GROUP:
+            type = "Group";
+            break;
+        case H5O_TYPE_DATASET:
+            type = "Dataset";
+            break;
+        case H5O_TYPE_NAMED_DATATYPE:
+            type = "Datatype";
+            break;
+        default:
+            type = links[i].link_type == H5L_TYPE_EXTERNAL ? "External Link" : "Soft Link";
         }
-        break;
-    case H5S_SCALAR:
-        extent_type = "Scalar";
-        break;
-    case H5S_NULL:
-        extent_type = "Empty";
-        break;
-    default:
-        break;
+        names(i) = links[i].name;
+        types(i) = type;
+    }
+    if (nargout == 0)
+    {
+        for (size_t i = 0; i < links.size(); i++)
+        {
+            const string &name = links[i].name;
+            octave_stdout << name << string(name.size() < 24 ? 24 - name.size() : 1, ' ')
+                          << types(i).string_value() << "\n";
+        }
+        return octave_value_list();
     }
+    octave_value_list retval;
+    retval(0) = names;
+    retval(1) = types;
+    return retval;
 }
-octave_scalar_map hdf5oct::dspace_info_t::oct_map() const
+
+string h5_concat_path(const string &path, const string &obj_name);
+
+// Read all datasets below group g into a struct with the same hierarchy.
+// Attributes are collected in attrs if requested
+static octave_scalar_map load_group(const H5::Group &g, const string &path,
+                                    bool with_attrs, vector<octave_scalar_map> &attrs);
+
+// A dataset opened by openGroupMembers. HighFive converts an Object to
+// a DataSet only through a protected constructor
+struct member_dataset_t : H5::DataSet
 {
-    map<string, octave_value> M;
-    M["ExtentType"] = extent_type;
-    M["Size"] = size;
-    // Return maxsize as a double array to get the "inf" for unlimited dimensions
-    RowVector dmaxsize(maxsize.numel());
-    for (int i = 0; i < maxsize.numel(); i++)
+    explicit member_dataset_t(H5::Object &&o) : H5::DataSet(std::move(o)) {}
+};
+
+static octave_value load_dataset(H5::DataSet &ds, const string &path,
+                                 bool with_attrs, vector<octave_scalar_map> &attrs)
+{
+    h5o::data_exchange dx;
+    if (!dx.assign(&ds))
+        error("h5load: dataset %s: %s", path.c_str(), h5o::lastError.c_str());
+    if (with_attrs && ds.getNumberAttributes() > 0)
     {
-        dmaxsize(i) = hsize_t(maxsize(i)) == H5::DataSpace::UNLIMITED ? INFINITY : double(maxsize(i));
+        octave_scalar_map a;
+        a.assign("Name", path);
+        a.assign("Attributes", octave_value(h5o::readAttributes(ds)));
+        attrs.push_back(a);
     }
-    M["MaxSize"] = dmaxsize;
-    return octave_scalar_map(M);
+    return dx.read();
 }
-bool hdf5oct::dspace_info_t::needs_chunk() const
+
+static octave_scalar_map load_group(const H5::Group &g, const string &path,
+                                    bool with_attrs, vector<octave_scalar_map> &attrs)
 {
-    if (size.isempty())
-        return false;
-    int n = size.numel();
-    // HDF5 specs: chunking is needed if size!=maxsize OR maxsize==unlimited
-    for (int i = 0; i < n; i++)
+    if (with_attrs && g.getNumberAttributes() > 0)
     {
-        if (size(i) != maxsize(i) || (size_t(maxsize(i)) == H5::DataSpace::UNLIMITED))
-            return true;
+        octave_scalar_map a;
+        a.assign("Name", path);
+        a.assign("Attributes", octave_value(h5o::readAttributes(g)));
+        attrs.push_back(a);
     }
-    return false;
+
+    vector<string> names;
+    vector<H5::Object> objects;
+    h5o::openGroupMembers(g, names, objects);
+
+    // datasets first, then groups, as in h5info. The objects opened
+    // while iterating over the group are used, without a second lookup
+    octave_scalar_map M;
+    for (size_t i = 0; i < objects.size(); i++)
+        if (objects[i].getType() == H5::ObjectType::Dataset)
+        {
+            H5::DataSet ds = member_dataset_t(std::move(objects[i]));
+            M.assign(names[i], load_dataset(ds, h5_concat_path(path, names[i]),
+                                            with_attrs, attrs));
+        }
+    for (size_t i = 0; i < objects.size(); i++)
+        if (objects[i].getType() == H5::ObjectType::Group)
+        {
+            H5::Group sub(std::move(objects[i]));
+            M.assign(names[i], load_group(sub, h5_concat_path(path, names[i]),
+                                          with_attrs, attrs));
+        }
+    return M;
 }
 
-void hdf5oct::dtype_info_t::assign(const H5::DataType &dt)
+// [data, attrs] = __h5load__(filename,location,with_attrs)
+DEFUN_DLD(__h5load__, args, , "__h5load__: backend for h5load\n\
+Users should not use this directly. Use h5load.m instead")
 {
-    string s = dt.string();
-    switch (dt.getClass())
+    if (args.length() != 3)
+        error("__h5load__: wrong # of args");
+    string filename = args(0).string_value();
+    string location = args(1).string_value();
+    bool with_attrs = args(2).bool_value();
+
+    octave_value data;
+    vector<octave_scalar_map> attrs;
+    try
     {
-    case H5::DataTypeClass::Integer:
-        h5class = "int";
+        H5::File file = h5o::file_cache::instance().open(filename, H5::File::ReadOnly);
+
+        // check that location is valid & exists
+        if (!h5o::validLocation(location))
+            error("h5load: %s", h5o::lastError.c_str());
+        if (!h5o::locationExists(file, location))
+            error("h5load: location '%s' does not exist", location.c_str());
+
+        switch (file.getObjectType(location))
         {
-            bool isUnsigned = (H5Tget_sign(dt.getId()) == H5T_SGN_NONE);
-            signed_status = isUnsigned ? "unsigned" : "signed";
-            size = dt.getSize();
-            if (size <= 8)
-            {
-                octave_class = isUnsigned ? "uint" : "int";
-                octave_class += to_string(size * 8);
-            }
+        case H5::ObjectType::Group:
+            data = load_group(file.getGroup(location), location, with_attrs, attrs);
+            break;
+        case H5::ObjectType::Dataset:
+        {
+            H5::DataSet ds = file.getDataSet(location);
+            data = load_dataset(ds, location, with_attrs, attrs);
         }
         break;
-    case H5::DataTypeClass::Float:
-        h5class = "float";
+        default:
+            error("h5load: location '%s' has unsupported object type",
+                  location.c_str());
+        }
+    }
+    catch (const H5::Exception &e)
+    {
+        error("%s", e.what());
+    }
+
+    vector<string> keys{"Name", "Attributes"};
+    octave_map amap(dim_vector(attrs.size(), 1), keys);
+    for (size_t i = 0; i < attrs.size(); i++)
+        amap.fast_elem_insert(i, attrs[i]);
+    octave_value_list retval;
+    retval(0) = data;
+    retval(1) = amap;
+    return retval;
+}
+
+// The core (in-memory) file driver, for HighFive's FileAccessProps::add().
+// The file grows in steps of increment bytes; with a backing store, it
+// is read from disk when opened and written back when flushed or closed
+struct core_driver_property_t
+{
+    size_t increment;
+    bool backing_store;
+    void apply(hid_t fapl) const
+    {
+        if (H5Pset_fapl_core(fapl, increment, backing_store) < 0)
+            throw H5::PropertyException("could not set the core file driver");
+    }
+};
+
+static const size_t core_increment = 1024 * 1024;
+
+// h5open(filename,writable,opts)
+DEFUN_DLD(__h5open__, args, , "__h5open__: backend for h5open\n\
+Users should not use this directly. Use h5open.m instead")
+{
+    if (args.length() != 3)
+        error("__h5open__: wrong # of args");
+    string filename = args(0).string_value();
+    bool writable = args(1).bool_value();
+    octave_scalar_map opts = args(2).scalar_map_value();
+
+    try
+    {
+        h5o::file_cache &cache = h5o::file_cache::instance();
+        // SWMR and Core select how a file is opened for writing,
+        // the other options apply only to reading
+        octave_value swmr = opts.getfield("SWMR");
+        octave_value core = opts.getfield("Core");
+        bool swmr_write = writable && swmr.is_defined() && swmr.bool_value();
+        bool core_write = writable && core.is_defined() && core.bool_value();
+        if (swmr_write && core_write)
+            error("h5open: the options 'SWMR' and 'Core' cannot be combined");
+        if (writable && swmr.is_defined())
+            opts.rmfield("SWMR");
+        if (writable && core.is_defined())
+            opts.rmfield("Core");
+
+        // access properties of this file, when opened read-only
+        if (opts.nfields() > 0)
         {
-            size = dt.getSize();
-            if (size == 4)
-                octave_class = "single";
-            if (size == 8)
-                octave_class = "double";
+            h5o::file_access_t a = cache.access(filename);
+            if (!a.assign(opts))
+                error("h5open: %s", h5o::lastError.c_str());
+            cache.set_access(filename, a);
         }
-        break;
-    case H5::DataTypeClass::Time:
-        h5class = "time";
-        break;
-    case H5::DataTypeClass::String:
-        h5class = "string";
+
+        // The SWMR writer is opened anew, after the datasets extended by
+        // h5append have been trimmed, as attributes cannot be deleted later
+        if (swmr_write)
         {
-            H5::StringType st = dt.asStringType();
-            size = st.isVariableStr() ? H5T_VARIABLE : st.getSize();
-            switch (st.getCharacterSet())
-            {
-            case H5::CharacterSet::Ascii:
-                cset = "ascii";
-                break;
-            case H5::CharacterSet::Utf8:
-                cset = "utf8";
-                break;
-            default:
-                break;
-            }
-            switch (st.getPadding())
+            // SWMR writing needs the latest format bounds
+            cache.close(filename);
+            H5::FileAccessProps fapl;
+            fapl.add(H5::FileVersionBounds(H5F_LIBVER_LATEST, H5F_LIBVER_LATEST));
+            H5::File file = cache.open(filename, H5::File::ReadWrite, true,
+                                       H5::FileCreateProps::Default(), fapl);
+            if (!h5o::isSWMRWriter(file) && H5Fstart_swmr_write(file.getId()) < 0)
             {
-            case H5::StringPadding::NullTerminated:
-                pading = "nullterm";
-                break;
-            case H5::StringPadding::NullPadded:
-                pading = "nullpad";
-                break;
-            case H5::StringPadding::SpacePadded:
-                pading = "spacepad";
-                break;
-            default:
-                break;
+                cache.close(filename);
+                error("h5open: cannot write %s in SWMR mode. The file must be "
+                      "created with 'LatestFormat' and its datasets must be chunked",
+                      filename.c_str());
             }
-            octave_class = "string";
+            return octave_value_list();
         }
-        break;
-    case H5::DataTypeClass::BitField:
-        h5class = "bitfield";
-        break;
-    case H5::DataTypeClass::Opaque:
-        h5class = "opaque";
-        break;
-    case H5::DataTypeClass::Compound:
-        h5class = "compound";
-        if (dt == h5o::h5traits<std::complex<double>>::predType())
+        // The file is held in memory, and written back to disk
+        // by h5flush and h5close
+        if (core_write && !h5o::isMemoryFile(filename))
         {
-            octave_class = "double complex";
-            size = dt.getSize();
+            cache.close(filename);
+            H5::FileAccessProps fapl;
+            fapl.add(core_driver_property_t{core_increment, true});
+            cache.open(filename, H5::File::ReadWrite, true, H5::FileCreateProps::Default(), fapl);
+            return octave_value_list();
         }
-        else if (dt == h5o::h5traits<std::complex<float>>::predType())
+        h5o::file_cache::instance().open(filename,
+                                         writable ? H5::File::ReadWrite : H5::File::ReadOnly,
+                                         true);
+    }
+    catch (const H5::Exception &e)
+    {
+        error("%s", e.what());
+    }
+    return octave_value_list();
+}
+
+// h5close(filename) or h5close()
+DEFUN_DLD(__h5close__, args, , "__h5close__: backend for h5close\n\
+Users should not use this directly. Use h5close.m instead")
+{
+    if (args.length() > 1)
+        error("__h5close__: wrong # of args");
+
+    try
+    {
+        if (args.length() == 1)
+            h5o::file_cache::instance().close(args(0).string_value());
+        else
+            h5o::file_cache::instance().close_all();
+    }
+    catch (const H5::Exception &e)
+    {
+        error("%s", e.what());
+    }
+    return octave_value_list();
+}
+
+// h5flush(filename) or h5flush()
+DEFUN_DLD(__h5flush__, args, , "__h5flush__: backend for h5flush\n\
+Users should not use this directly. Use h5flush.m instead")
+{
+    if (args.length() > 1)
+        error("__h5flush__: wrong # of args");
+
+    // complete the asynchronous writes first
+    vector<string> errors = args.length() == 1
+                                ? h5o::async_queue::instance().waitFile(args(0).string_value())
+                                : h5o::async_queue::instance().wait(0);
+    try
+    {
+        if (args.length() == 1)
+            h5o::file_cache::instance().flush(args(0).string_value());
+        else
+            h5o::file_cache::instance().flush_all();
+    }
+    catch (const H5::Exception &e)
+    {
+        error("%s", e.what());
+    }
+    report_async_errors("h5flush", errors);
+    return octave_value_list();
+}
+
+DEFUN_DLD(h5wait, args, , "-*- texinfo -*- \n\
+@deftypefn {Loadable Function} {} h5wait (@var{h}) \n\
+@deftypefnx {Loadable Function} {} h5wait () \n\n\
+Wait for asynchronous writes to complete.\n\n\
+@code{h5wait (@var{h})} waits for the write with handle @var{h}, \
+returned by @code{h5write (@dots{}, 'Async', true)}, and raises \
+an error if it failed. @code{h5wait ()} waits for all queued writes \
+and raises the errors of all failed writes not yet reported.\n\n\
+@code{h5flush} also waits for the writes to the flushed file(s).\n\n\
+@seealso{h5write, h5writequeue, h5flush}\n@end deftypefn")
+{
+    int nargin = args.length();
+    if (nargin > 1)
+    {
+        print_usage();
+        return octave_value();
+    }
+    uint64_t id = 0;
+    if (nargin == 1)
+    {
+        if (!(args(0).is_real_scalar() && args(0).double_value() >= 1 &&
+              args(0).double_value() == std::round(args(0).double_value())))
+            error("h5wait: the handle must be a positive integer returned by h5write");
+        id = args(0).double_value();
+    }
+    report_async_errors("h5wait", h5o::async_queue::instance().wait(id));
+    return octave_value_list();
+}
+
+DEFUN_DLD(h5writequeue, args, , "-*- texinfo -*- \n\
+@deftypefn {Loadable Function} {@var{nbytes} =} h5writequeue () \n\
+@deftypefnx {Loadable Function} {} h5writequeue (@var{nbytes}) \n\n\
+Query or set the size limit of the queue of asynchronous writes.\n\n\
+@code{h5write (@dots{}, 'Async', true)} queues the data for writing \
+by a background thread and returns without waiting for the write. \
+The queued data are not copied: the queue keeps a reference \
+to the octave array, which octave copies only if the array is then modified. \
+When the total size of the queued arrays would exceed @var{nbytes} \
+(default 256 MiB), @code{h5write} waits until enough of them have been written. \
+A single array larger than the limit waits for the queue to empty.\n\n\
+@seealso{h5write, h5wait}\n@end deftypefn")
+{
+    int nargin = args.length();
+    if (nargin > 1)
+    {
+        print_usage();
+        return octave_value();
+    }
+    h5o::async_queue &queue = h5o::async_queue::instance();
+    if (nargin == 1)
+    {
+        // also rejects NaN, and sizes beyond the range of size_t
+        double n = args(0).is_real_scalar() ? args(0).double_value() : -1;
+        if (!(n >= 0 && n < std::ldexp(1.0, 64)) || n != std::floor(n))
+            error("h5writequeue: the queue size must be a non-negative integer number of bytes");
+        queue.set_capacity(n);
+        return octave_value_list();
+    }
+    return octave_value(double(queue.capacity()));
+}
+
+DEFUN_DLD(h5filecache, args, , "-*- texinfo -*- \n\
+@deftypefn {Loadable Function} {[@var{n}, @var{files}] =} h5filecache () \n\
+@deftypefnx {Loadable Function} {} h5filecache (@var{n}) \n\n\
+Query or set the size of the cache of open HDF5 files.\n\n\
+All hdf5oct functions keep the files they access open between calls, \
+so that repeated access to the same file does not need to re-open it. \
+Up to @var{n} files (default 8) are kept open, the least recently used \
+being closed first. Files opened with @code{h5open} are not counted \
+and stay open until @code{h5close} is called.\n\n\
+@code{[@var{n}, @var{files}] = h5filecache ()} returns the cache size \
+and a cell array with the names of all currently open files.\n\n\
+@code{h5filecache (@var{n})} sets the cache size. \
+@code{h5filecache (0)} disables caching, i.e., files are closed at the end of each call.\n\n\
+Note that HDF5 file locking may prevent other processes from writing \
+to a file while it is open in the cache. Use @code{h5close} to release it.\n\n\
+@seealso{h5open, h5close, h5flush}\n@end deftypefn")
+{
+    int nargin = args.length();
+    if (nargin > 1)
+    {
+        print_usage();
+        return octave_value();
+    }
+
+    h5o::file_cache &cache = h5o::file_cache::instance();
+    try
+    {
+        if (nargin == 1)
         {
-            octave_class = "single complex";
-            size = dt.getSize();
+            double n = args(0).is_real_scalar() ? args(0).double_value() : -1;
+            if (!(n >= 0) || std::isinf(n) || n != std::floor(n))
+                error("h5filecache: the cache size must be a non-negative integer");
+            cache.set_capacity(args(0).idx_type_value());
+            return octave_value_list();
         }
-        break;
-    case H5::DataTypeClass::Reference:
-        h5class = "reference";
-        break;
-    case H5::DataTypeClass::Enum:
-        h5class = "enum";
-        if (dt == h5o::h5traits<bool>::predType())
+    }
+    catch (const H5::Exception &e)
+    {
+        error("%s", e.what());
+    }
+
+    octave_value_list retval(2);
+    retval(0) = octave_value(double(cache.capacity()));
+    vector<string> names = cache.names();
+    Array<string> files(dim_vector(names.size(), 1));
+    for (size_t i = 0; i < names.size(); i++)
+        files(i) = names[i];
+    retval(1) = Cell(files);
+    return retval;
+}
+
+DEFUN_DLD(h5fileaccess, args, nargout, "-*- texinfo -*- \n\
+@deftypefn {Loadable Function} {@var{opts} =} h5fileaccess () \n\
+@deftypefnx {Loadable Function} {} h5fileaccess (@var{key}, @var{val}, ...) \n\n\
+Query or set the access properties of HDF5 files opened read-only.\n\n\
+The properties apply to all files opened read-only from now on, \
+including the files in the cache of open files (see @code{h5filecache}), \
+which are re-opened when they are next accessed. \
+@code{h5open} sets them for a single file. \
+Files opened for writing use the HDF5 defaults. The keys are:\n\n\
+@table @asis\n\
+@item @option{PageBufferSize}\n\
+The size in bytes of the page buffer, which keeps whole file pages in \
+memory, so that reading many small objects does not issue many small reads. \
+It applies only to files created with paged aggregation \
+(@code{h5create (..., 'FileSpaceStrategy', 'page')}) and must be at \
+least the file page size; other files are opened without a page buffer. \
+0 (default) disables the page buffer.\n\n\
+@item @option{MetadataCacheSize}\n\
+The maximum size, or @code{[initial max]}, of the metadata cache in bytes, \
+between 1 KiB and 128 MiB. [] (default) selects the HDF5 defaults.\n\n\
+@item @option{EvictOnClose}\n\
+If true, the metadata of an object are evicted from the cache when the \
+object is closed. Default is false.\n\n\
+@item @option{SWMR}\n\
+If true, files are opened for SWMR (single writer, multiple readers) \
+reading, while another process writes them, see @code{h5open}. \
+The datasets are refreshed on each access. Default is false.\n\n\
+@item @option{Core}\n\
+If true, the whole file is read into memory when it is opened, with the \
+HDF5 core driver, and all reads are served from memory. Default is false.\n\
+@end table\n\n\
+@code{@var{opts} = h5fileaccess ()} returns the current settings in a struct.\n\n\
+The effect of the settings can be checked with @code{h5filestats}.\n\n\
+@seealso{h5filestats, h5open, h5filecache}\n@end deftypefn")
+{
+    int nargin = args.length();
+    if (nargin % 2)
+    {
+        print_usage();
+        return octave_value();
+    }
+
+    h5o::file_cache &cache = h5o::file_cache::instance();
+    if (nargin > 0)
+    {
+        octave_scalar_map m;
+        for (int i = 0; i < nargin; i += 2)
+        {
+            string key = args(i).xstring_value("h5fileaccess: options must be given as key, value pairs");
+            bool found = false;
+            for (const char *name : {"PageBufferSize", "MetadataCacheSize", "EvictOnClose", "SWMR", "Core"})
+                if (strcasecmp(key.c_str(), name) == 0)
+                {
+                    m.assign(name, args(i + 1));
+                    found = true;
+                }
+            if (!found)
+                error("h5fileaccess: invalid option '%s'", key.c_str());
+        }
+        h5o::file_access_t a = cache.access();
+        if (!a.assign(m))
+            error("h5fileaccess: %s", h5o::lastError.c_str());
+        cache.set_access(a);
+        if (nargout == 0)
+            return octave_value_list();
+    }
+    return octave_value(cache.access().oct_map());
+}
+
+DEFUN_DLD(h5filestats, args, , "-*- texinfo -*- \n\
+@deftypefn {Loadable Function} {@var{stats} =} h5filestats (@var{filename}) \n\
+@deftypefnx {Loadable Function} {@var{stats} =} h5filestats (@var{filename}, \"reset\") \n\n\
+Return the statistics of the metadata cache and page buffer of an open HDF5 file.\n\n\
+@var{stats} is a struct with the fields:\n\n\
+@table @asis\n\
+@item @samp{MetadataCache}\n\
+A struct with the @samp{HitRate} of the metadata cache, its \
+@samp{MaxSize} and @samp{CurrentSize} in bytes and the number of \
+@samp{Entries}.\n\n\
+@item @samp{PageBuffer}\n\
+A struct with the number of @samp{Accesses}, @samp{Hits}, @samp{Misses}, \
+@samp{Evictions} and @samp{Bypasses} of the page buffer, each a vector \
+@code{[metadata raw]}, or [] if the file has no page buffer.\n\
+@end table\n\n\
+The counts are accumulated since the file was opened, or since the last \
+call with @qcode{\"reset\"}, which resets them after returning them. \
+If @var{filename} is not already open, it is opened read-only.\n\n\
+@seealso{h5fileaccess, h5open}\n@end deftypefn")
+{
+    int nargin = args.length();
+    if (nargin < 1 || nargin > 2)
+    {
+        print_usage();
+        return octave_value();
+    }
+    string filename = args(0).xstring_value("h5filestats: FILENAME must be a string");
+    bool reset = false;
+    if (nargin == 2)
+    {
+        if (args(1).string_value() != "reset")
+            error("h5filestats: the second argument must be \"reset\"");
+        reset = true;
+    }
+
+    octave_scalar_map stats;
+    try
+    {
+        H5::File file = h5o::file_cache::instance().open(filename, H5::File::ReadOnly);
+        hid_t fid = file.getId();
+
+        double hit_rate = 0;
+        size_t max_size = 0, min_clean_size = 0, cur_size = 0;
+        int nentries = 0;
+        H5Fget_mdc_hit_rate(fid, &hit_rate);
+        H5Fget_mdc_size(fid, &max_size, &min_clean_size, &cur_size, &nentries);
+        octave_scalar_map mdc;
+        mdc.assign("HitRate", hit_rate);
+        mdc.assign("MaxSize", double(max_size));
+        mdc.assign("CurrentSize", double(cur_size));
+        mdc.assign("Entries", double(nentries));
+        stats.assign("MetadataCache", mdc);
+
+        // the counts are [metadata raw]
+        unsigned accesses[2], hits[2], misses[2], evictions[2], bypasses[2];
+        herr_t err;
+        H5E_BEGIN_TRY
+        {
+            err = H5Fget_page_buffering_stats(fid, accesses, hits, misses, evictions, bypasses);
+        }
+        H5E_END_TRY;
+        if (err < 0)
+            stats.assign("PageBuffer", Matrix());
+        else
+        {
+            auto row = [](const unsigned *c)
+            {
+                RowVector r(2);
+                r(0) = c[0];
+                r(1) = c[1];
+                return r;
+            };
+            octave_scalar_map pb;
+            pb.assign("Accesses", row(accesses));
+            pb.assign("Hits", row(hits));
+            pb.assign("Misses", row(misses));
+            pb.assign("Evictions", row(evictions));
+            pb.assign("Bypasses", row(bypasses));
+            stats.assign("PageBuffer", pb);
+        }
+
+        if (reset)
+        {
+            H5Freset_mdc_hit_rate_stats(fid);
+            if (err >= 0)
+                H5Freset_page_buffering_stats(fid);
+        }
+    }
+    catch (const H5::Exception &e)
+    {
+        error("%s", e.what());
+    }
+    return octave_value(stats);
+}
+
+DEFUN_DLD(h5serialize, args, , "-*- texinfo -*- \n\
+@deftypefn {Loadable Function} {@var{bytes} =} h5serialize (@var{filename}) \n\n\
+Return the contents of an HDF5 file as a file image.\n\n\
+@var{bytes} is a uint8 row vector holding the file exactly as it would be \
+stored on disk, e.g. for sending it over the network. @var{filename} may be \
+a file on disk or a memory file, @qcode{\"mem://name\"}, created by \
+@code{h5create} or @code{h5deserialize}. The datasets extended by \
+@code{h5append} are trimmed first, as by @code{h5flush}.\n\n\
+@seealso{h5deserialize, h5create, h5close}\n@end deftypefn")
+{
+    if (args.length() != 1)
+    {
+        print_usage();
+        return octave_value();
+    }
+    string filename = args(0).xstring_value("h5serialize: FILENAME must be a string");
+
+    try
+    {
+        h5o::file_cache &cache = h5o::file_cache::instance();
+        cache.flush(filename);
+        H5::File file = cache.open(filename, H5::File::ReadOnly);
+        ssize_t size = H5Fget_file_image(file.getId(), nullptr, 0);
+        if (size < 0)
+            error("h5serialize: cannot get the file image of %s", filename.c_str());
+        uint8NDArray bytes(dim_vector(1, size));
+        if (H5Fget_file_image(file.getId(), bytes.fortran_vec(), size) < 0)
+            error("h5serialize: cannot get the file image of %s", filename.c_str());
+        return octave_value(bytes);
+    }
+    catch (const H5::Exception &e)
+    {
+        error("%s", e.what());
+    }
+    return octave_value();
+}
+
+DEFUN_DLD(h5deserialize, args, , "-*- texinfo -*- \n\
+@deftypefn {Loadable Function} {@var{name} =} h5deserialize (@var{bytes}) \n\
+@deftypefnx {Loadable Function} {@var{name} =} h5deserialize (@var{bytes}, @var{name}) \n\n\
+Open a file image as an HDF5 file in memory.\n\n\
+@var{bytes} is a uint8 array holding an HDF5 file, as returned by \
+@code{h5serialize} or read from a file. A copy of it is opened as the \
+memory file @var{name}, which must start with @qcode{\"mem://\"}; \
+if not given, a new name is returned. A memory file of the same name is \
+replaced.\n\n\
+The memory file can be read and written by all hdf5oct functions, e.g. \
+@code{h5read (@var{name}, '/data')}, and exists until it is closed with \
+@code{h5close}.\n\n\
+@seealso{h5serialize, h5close}\n@end deftypefn")
+{
+    int nargin = args.length();
+    if (nargin < 1 || nargin > 2)
+    {
+        print_usage();
+        return octave_value();
+    }
+    if (!args(0).is_uint8_type())
+        error("h5deserialize: BYTES must be a uint8 array");
+    uint8NDArray bytes = args(0).uint8_array_value();
+
+    static unsigned long count = 0;
+    h5o::file_cache &cache = h5o::file_cache::instance();
+    string name;
+    if (nargin == 2)
+    {
+        name = args(1).xstring_value("h5deserialize: NAME must be a string");
+        if (!h5o::isMemoryFile(name))
+            error("h5deserialize: NAME must start with \"mem://\"");
+    }
+    else
+    {
+        // a name not in use
+        vector<string> names = cache.names();
+        do
+            name = "mem://image" + std::to_string(++count);
+        while (std::find(names.begin(), names.end(), name) != names.end());
+    }
+
+    try
+    {
+        cache.openImage(name, bytes.data(), bytes.numel());
+    }
+    catch (const H5::Exception &e)
+    {
+        error("h5deserialize: %s", e.what());
+    }
+    return octave_value(name);
+}
+
+DEFUN_DLD(h5threads, args, , "-*- texinfo -*- \n\
+@deftypefn {Loadable Function} {@var{n} =} h5threads () \n\
+@deftypefnx {Loadable Function} {} h5threads (@var{n}) \n\n\
+Query or set the number of threads used to (de)compress chunked datasets.\n\n\
+When reading a chunked dataset with the @samp{deflate}, @samp{shuffle} \
+or @samp{fletcher32} filters, @code{h5read} and @code{h5load} \
+can decode the chunks in @var{n} parallel threads, while the raw chunks \
+are read from the file by the calling thread. \
+Likewise, @code{h5write} encodes the chunks in parallel and \
+writes them to the file in order. \
+The default @var{n} = 1 leaves (de)compression to the HDF5 library. \
+Use e.g. @code{h5threads (nproc)} to employ all processor cores.\n\n\
+The parallel path applies if no type conversion is needed. \
+For reading, all chunks touched by the selection must have been written. \
+For writing, the selection must consist of whole chunks, \
+except at the edges of the dataset. \
+Otherwise, and for other filters, the data is handled by the HDF5 library. \
+The chunks are encoded exactly as by the HDF5 library, \
+so the files can be read by any HDF5 application.\n\n\
+The @option{Threads} option of @code{h5read} and @code{h5write} \
+overrides this setting for a single call.\n\n\
+@seealso{h5read, h5write, h5load}\n@end deftypefn")
+{
+    int nargin = args.length();
+    if (nargin > 1)
+    {
+        print_usage();
+        return octave_value();
+    }
+
+    unsigned &nthreads = h5o::defaultThreads();
+    if (nargin == 1)
+    {
+        if (!(args(0).is_real_scalar() && args(0).double_value() >= 1 &&
+              args(0).double_value() == std::round(args(0).double_value())))
+            error("h5threads: the number of threads must be a positive integer");
+        nthreads = args(0).double_value();
+        return octave_value_list();
+    }
+    return octave_value(double(nthreads));
+}
+
+HighFive::DataType hdf5oct::h5type_from_spec(const std::string &dtype_spec)
+{
+    if (dtype_spec == "double")
+        return h5traits<double>::predType();
+    else if (dtype_spec == "single")
+        return h5traits<float>::predType();
+    else if (dtype_spec == "double complex")
+        return h5traits<std::complex<double>>::predType();
+    else if (dtype_spec == "single complex")
+        return h5traits<std::complex<float>>::predType();
+    else if (dtype_spec == "uint64")
+        return h5traits<uint64_t>::predType();
+    else if (dtype_spec == "int64")
+        return h5traits<int64_t>::predType();
+    else if (dtype_spec == "uint32")
+        return h5traits<uint32_t>::predType();
+    else if (dtype_spec == "int32")
+        return h5traits<int32_t>::predType();
+    else if (dtype_spec == "uint16")
+        return h5traits<uint16_t>::predType();
+    else if (dtype_spec == "int16")
+        return h5traits<int16_t>::predType();
+    else if (dtype_spec == "uint8")
+        return h5traits<uint8_t>::predType();
+    else if (dtype_spec == "int8")
+        return h5traits<int8_t>::predType();
+    else if (dtype_spec == "logical")
+        return h5traits<bool>::predType();
+    else if (dtype_spec == "string")
+        return h5traits<std::string>::predType();
+    return HighFive::DataType();
+}
+
+std::vector<size_t> hdf5oct::logicalDims(const H5::DataSet &ds)
+{
+    vector<size_t> dims = ds.getSpace().getDimensions();
+    if (ds.hasAttribute(appendSizeAttr))
+    {
+        vector<uint64_t> size;
+        ds.getAttribute(appendSizeAttr).read(size);
+        if (size.size() == dims.size())
+            for (size_t i = 0; i < dims.size(); i++)
+                dims[i] = std::min<size_t>(dims[i], size[i]);
+    }
+    return dims;
+}
+
+H5::DataSpace hdf5oct::logicalSpace(const H5::DataSet &ds)
+{
+    H5::DataSpace space = ds.getSpace();
+    if (!ds.hasAttribute(appendSizeAttr))
+        return space;
+    return H5::DataSpace(logicalDims(ds), space.getMaxDimensions());
+}
+
+bool hdf5oct::isSWMRWriter(const H5::File &f)
+{
+    unsigned intent = 0;
+    return H5Fget_intent(f.getId(), &intent) >= 0 && (intent & H5F_ACC_SWMR_WRITE);
+}
+
+void hdf5oct::refreshSWMR(const H5::DataSet &ds)
+{
+    hid_t fid = H5Iget_file_id(ds.getId());
+    if (fid < 0)
+        return;
+    unsigned intent = 0;
+    if (H5Fget_intent(fid, &intent) >= 0 && (intent & H5F_ACC_SWMR_READ))
+        H5Drefresh(ds.getId());
+    H5Fclose(fid);
+}
+
+void hdf5oct::trimDataset(H5::DataSet &ds)
+{
+    if (!ds.hasAttribute(appendSizeAttr))
+        return;
+    vector<size_t> dims = logicalDims(ds);
+    ds.deleteAttribute(appendSizeAttr);
+    ds.resize(dims);
+}
+
+uint64NDArray hdf5oct::getChunkSize(const H5::DataSet &ds)
+{
+    uint64NDArray chunksize;
+    H5::DataSetCreateProps dscpl = ds.getCreatePropertyList();
+    if (H5Pget_layout(dscpl.getId()) != H5D_CHUNKED)
+        return chunksize;
+    int ndim = ds.getSpace().getNumberDimensions();
+    vector<hsize_t> hdims(ndim);
+    if (ndim > 0 && H5Pget_chunk(dscpl.getId(), ndim, hdims.data()) == ndim)
+    {
+        chunksize = uint64NDArray(dim_vector(1, ndim));
+        for (int i = 0; i < ndim; i++)
+            chunksize(i) = hdims[ndim - 1 - i];
+    }
+    return chunksize;
+}
+
+template <typename T>
+static octave_value get_fill_value_impl(hid_t dcpl)
+{
+    typename h5o::h5traits<T>::OctaveArray A(dim_vector(1, 1));
+    herr_t err;
+    H5E_BEGIN_TRY
+    {
+        err = H5Pget_fill_value(dcpl, h5o::h5traits<T>::predType().getId(), A.fortran_vec());
+    }
+    H5E_END_TRY;
+    return err < 0 ? octave_value(Matrix()) : octave_value(A);
+}
+
+template <typename T>
+static bool set_fill_value_impl(hid_t dcpl, const octave_value &v)
+{
+    typename h5o::h5traits<T>::OctaveArray A = h5o::h5traits<T>::toOctaveArray(v);
+    return A.numel() == 1 &&
+           H5Pset_fill_value(dcpl, h5o::h5traits<T>::predType().getId(), A.data()) >= 0;
+}
+
+octave_value hdf5oct::getFillValue(const H5::DataSetCreateProps &dcpl, const string &dtype_spec)
+{
+    hid_t id = dcpl.getId();
+    H5D_fill_value_t status;
+    if (H5Pfill_value_defined(id, &status) < 0 || status == H5D_FILL_VALUE_UNDEFINED)
+        return Matrix();
+    if (dtype_spec == "double")
+        return get_fill_value_impl<double>(id);
+    else if (dtype_spec == "single")
+        return get_fill_value_impl<float>(id);
+    else if (dtype_spec == "double complex")
+        return get_fill_value_impl<std::complex<double>>(id);
+    else if (dtype_spec == "single complex")
+        return get_fill_value_impl<std::complex<float>>(id);
+    else if (dtype_spec == "uint64")
+        return get_fill_value_impl<uint64_t>(id);
+    else if (dtype_spec == "int64")
+        return get_fill_value_impl<int64_t>(id);
+    else if (dtype_spec == "uint32")
+        return get_fill_value_impl<uint32_t>(id);
+    else if (dtype_spec == "int32")
+        return get_fill_value_impl<int32_t>(id);
+    else if (dtype_spec == "uint16")
+        return get_fill_value_impl<uint16_t>(id);
+    else if (dtype_spec == "int16")
+        return get_fill_value_impl<int16_t>(id);
+    else if (dtype_spec == "uint8")
+        return get_fill_value_impl<uint8_t>(id);
+    else if (dtype_spec == "int8")
+        return get_fill_value_impl<int8_t>(id);
+    else if (dtype_spec == "logical")
+        return get_fill_value_impl<bool>(id);
+    else if (dtype_spec == "string")
+    {
+        // the library allocates the variable-length copy of the fill value
+        char *p = nullptr;
+        herr_t err;
+        H5E_BEGIN_TRY
+        {
+            err = H5Pget_fill_value(id, h5traits<string>::predType().getId(), &p);
+        }
+        H5E_END_TRY;
+        if (err < 0)
+            return Matrix();
+        string s = p ? p : "";
+        H5free_memory(p);
+        return s;
+    }
+    return Matrix();
+}
+
+bool hdf5oct::setFillValue(H5::DataSetCreateProps &dcpl, const string &dtype_spec,
+                           const octave_value &v)
+{
+    hid_t id = dcpl.getId();
+    if (dtype_spec == "double")
+        return set_fill_value_impl<double>(id, v);
+    else if (dtype_spec == "single")
+        return set_fill_value_impl<float>(id, v);
+    else if (dtype_spec == "double complex")
+        return set_fill_value_impl<std::complex<double>>(id, v);
+    else if (dtype_spec == "single complex")
+        return set_fill_value_impl<std::complex<float>>(id, v);
+    else if (dtype_spec == "uint64")
+        return set_fill_value_impl<uint64_t>(id, v);
+    else if (dtype_spec == "int64")
+        return set_fill_value_impl<int64_t>(id, v);
+    else if (dtype_spec == "uint32")
+        return set_fill_value_impl<uint32_t>(id, v);
+    else if (dtype_spec == "int32")
+        return set_fill_value_impl<int32_t>(id, v);
+    else if (dtype_spec == "uint16")
+        return set_fill_value_impl<uint16_t>(id, v);
+    else if (dtype_spec == "int16")
+        return set_fill_value_impl<int16_t>(id, v);
+    else if (dtype_spec == "uint8")
+        return set_fill_value_impl<uint8_t>(id, v);
+    else if (dtype_spec == "int8")
+        return set_fill_value_impl<int8_t>(id, v);
+    else if (dtype_spec == "logical")
+        return set_fill_value_impl<bool>(id, v);
+    else if (dtype_spec == "string")
+    {
+        string s = v.string_value();
+        const char *p = s.c_str();
+        return H5Pset_fill_value(id, h5traits<string>::predType().getId(), &p) >= 0;
+    }
+    return false;
+}
+
+bool hdf5oct::chunk_cache_t::assign(const octave_value &v)
+{
+    mode = None;
+    nbytes = nslots = 0;
+    w0 = 0.75;
+    if (v.is_undefined() || v.isempty())
+        return true;
+    if (v.is_string())
+    {
+        if (v.string_value() != "auto")
+        {
+            lastError = "ChunkCache must be 'auto' or [nbytes nslots w0]";
+            return false;
+        }
+        mode = Auto;
+        return true;
+    }
+    NDArray a = v.array_value();
+    if (a.numel() > 3 || a(0) < 0 ||
+        (a.numel() > 1 && a(1) < 0) ||
+        (a.numel() > 2 && (a(2) < 0 || a(2) > 1)))
+    {
+        lastError = "ChunkCache must be 'auto' or [nbytes nslots w0]";
+        return false;
+    }
+    mode = Manual;
+    nbytes = a(0);
+    if (a.numel() > 1)
+        nslots = a(1);
+    if (a.numel() > 2)
+        w0 = a(2);
+    return true;
+}
+
+void hdf5oct::chunk_cache_t::assign(const H5::DataSetAccessProps &dapl)
+{
+    H5Pget_chunk_cache(dapl.getId(), &nslots, &nbytes, &w0);
+}
+
+static size_t next_prime(size_t n)
+{
+    for (;; n++)
+    {
+        bool prime = n > 1;
+        for (size_t d = 2; prime && d * d <= n; d++)
+            prime = n % d;
+        if (prime)
+            return n;
+    }
+}
+
+void hdf5oct::chunk_cache_t::configure(const H5::DataSet &ds, const uint64NDArray &start,
+                                       const uint64NDArray &count, const uint64NDArray &stride)
+{
+    uint64NDArray chunk = getChunkSize(ds);
+    if (mode == None || chunk.isempty())
+        return; // the chunk cache is not used
+    int ndim = chunk.numel();
+    double chunk_bytes = ds.getDataType().getSize();
+    for (int i = 0; i < ndim; i++)
+        chunk_bytes *= size_t(chunk(i));
+
+    if (mode == Auto)
+    {
+        // count the chunks touched by the selection along each dimension
+        vector<size_t> fdims = ds.getSpace().getDimensions();
+        double nchunks = 1;
+        for (int i = 0; i < ndim; i++)
+        {
+            size_t k = chunk(i);
+            size_t s = start.isempty() ? 0 : size_t(start(i)) - 1;
+            size_t c = start.isempty() ? fdims[ndim - 1 - i] : size_t(count(i));
+            size_t t = stride.isempty() ? 1 : size_t(stride(i));
+            if (c == 0)
+                break;
+            // with stride >= chunk, each element is in a different chunk
+            size_t e = s + (c - 1) * t;
+            nchunks *= (t < k) ? e / k - s / k + 1 : c;
+        }
+        double sz = std::min(nchunks * chunk_bytes, double(max_auto_bytes));
+        nbytes = std::max(sz, 1024.0 * 1024);
+    }
+    if (nslots == 0)
+        nslots = next_prime(std::max(size_t(521), size_t(10 * nbytes / chunk_bytes)));
+}
+
+H5::DataSetAccessProps hdf5oct::chunk_cache_t::dapl() const
+{
+    H5::DataSetAccessProps p;
+    if (mode != None && nslots)
+        p.add(H5::Caching(nslots, nbytes, w0));
+    return p;
+}
+
+octave_scalar_map hdf5oct::chunk_cache_t::oct_map() const
+{
+    map<string, octave_value> M;
+    M["Size"] = double(nbytes);
+    M["Slots"] = double(nslots);
+    M["W0"] = w0;
+    return octave_scalar_map(M);
+}
+
+bool hdf5oct::file_access_t::assign(const octave_scalar_map &m)
+{
+    octave_value v = m.getfield("PageBufferSize");
+    if (v.is_defined())
+    {
+        if (!v.is_real_scalar() || v.double_value() < 0 || v.double_value() != std::floor(v.double_value()))
+        {
+            lastError = "PageBufferSize must be a non-negative integer";
+            return false;
+        }
+        page_buffer_size = v.double_value();
+    }
+    v = m.getfield("MetadataCacheSize");
+    if (v.is_defined())
+    {
+        // [] for the defaults, max or [initial max]
+        NDArray s = v.isempty() ? NDArray(dim_vector(1, 2), 0.) : v.array_value();
+        if (s.numel() == 1)
+        {
+            double max_size = s(0);
+            s = NDArray(dim_vector(1, 2), 0.);
+            s(1) = max_size;
+        }
+        bool ok = s.numel() == 2 && s(1) >= s(0);
+        for (int i = 0; ok && i < 2; i++)
+            ok = s(i) == 0 || (s(i) >= min_mdc_bytes && s(i) <= max_mdc_bytes);
+        if (!ok)
+        {
+            lastError = "MetadataCacheSize must be [initial max], "
+                        "with sizes between 1 KiB and 128 MiB";
+            return false;
+        }
+        mdc_initial_size = s(0);
+        mdc_max_size = s(1);
+    }
+    v = m.getfield("EvictOnClose");
+    if (v.is_defined())
+    {
+        if (!v.is_scalar_type() || !(v.islogical() || v.isreal()))
+        {
+            lastError = "EvictOnClose must be true or false";
+            return false;
+        }
+        evict_on_close = v.bool_value();
+    }
+    v = m.getfield("SWMR");
+    if (v.is_defined())
+    {
+        if (!v.is_scalar_type() || !(v.islogical() || v.isreal()))
+        {
+            lastError = "SWMR must be true or false";
+            return false;
+        }
+        swmr = v.bool_value();
+    }
+    v = m.getfield("Core");
+    if (v.is_defined())
+    {
+        if (!v.is_scalar_type() || !(v.islogical() || v.isreal()))
+        {
+            lastError = "Core must be true or false";
+            return false;
+        }
+        core = v.bool_value();
+    }
+    return true;
+}
+
+// Size of the metadata cache and eviction on close, for HighFive's
+// FileAccessProps::add()
+struct metadata_cache_property_t
+{
+    const hdf5oct::file_access_t &a;
+    void apply(hid_t fapl) const
+    {
+        H5AC_cache_config_t config;
+        config.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+        if (H5Pget_mdc_config(fapl, &config) < 0)
+            throw H5::PropertyException("could not get the metadata cache configuration");
+        if (a.mdc_max_size)
+        {
+            config.max_size = a.mdc_max_size;
+            config.min_size = std::min(config.min_size, config.max_size);
+        }
+        if (a.mdc_initial_size)
+        {
+            config.set_initial_size = true;
+            config.initial_size = a.mdc_initial_size;
+            config.min_size = std::min(config.min_size, config.initial_size);
+        }
+        config.initial_size = std::min(std::max(config.initial_size, config.min_size),
+                                       config.max_size);
+        if (H5Pset_mdc_config(fapl, &config) < 0)
+            throw H5::PropertyException("could not set the metadata cache configuration");
+        if (a.evict_on_close && H5Pset_evict_on_close(fapl, true) < 0)
+            throw H5::PropertyException("could not set evict on close");
+    }
+};
+
+H5::FileAccessProps hdf5oct::file_access_t::fapl(bool page_buffer) const
+{
+    H5::FileAccessProps p;
+    if (core)
+        p.add(core_driver_property_t{core_increment, false});
+    if (page_buffer && page_buffer_size > 0)
+        p.add(H5::PageBufferSize(page_buffer_size));
+    if (mdc_initial_size || mdc_max_size || evict_on_close)
+        p.add(metadata_cache_property_t{*this});
+    return p;
+}
+
+bool hdf5oct::file_access_t::operator==(const file_access_t &a) const
+{
+    return page_buffer_size == a.page_buffer_size && mdc_initial_size == a.mdc_initial_size &&
+           mdc_max_size == a.mdc_max_size && evict_on_close == a.evict_on_close &&
+           swmr == a.swmr && core == a.core;
+}
+
+octave_scalar_map hdf5oct::file_access_t::oct_map() const
+{
+    map<string, octave_value> M;
+    M["PageBufferSize"] = double(page_buffer_size);
+    RowVector mdc(2);
+    mdc(0) = mdc_initial_size;
+    mdc(1) = mdc_max_size;
+    M["MetadataCacheSize"] = mdc_max_size || mdc_initial_size ? octave_value(mdc) : octave_value(Matrix());
+    M["EvictOnClose"] = evict_on_close;
+    M["SWMR"] = swmr;
+    M["Core"] = core;
+    return octave_scalar_map(M);
+}
+
+std::vector<hsize_t> hdf5oct::guessChunkDims(const std::vector<size_t> &dims, size_t elem_size,
+                                             const std::string &access, size_t target_bytes)
+{
+    const double chunk_base = 16 * 1024, chunk_min = 8 * 1024, chunk_max = 1024 * 1024;
+
+    // unlimited dimensions are assumed to grow to 1024
+    size_t ndim = dims.size();
+    vector<hsize_t> chunk(ndim);
+    double nelem = 1;
+    for (size_t i = 0; i < ndim; i++)
+    {
+        chunk[i] = dims[i] ? dims[i] : 1024;
+        nelem *= chunk[i];
+    }
+
+    // target chunk size grows with the dataset size, unless given
+    double target = target_bytes, limit = 1.5 * target;
+    if (target_bytes == 0)
+    {
+        double dset_size = nelem * elem_size;
+        target = chunk_base * pow(2.0, log10(dset_size / (1024 * 1024)));
+        target = std::min(std::max(target, chunk_min), chunk_max);
+        limit = chunk_max;
+    }
+
+    // dimensions restricted to 1 by the access hint.
+    // Octave dimension i is HDF5 dimension ndim-1-i
+    vector<bool> thin(ndim, false);
+    if (ndim > 1)
+    {
+        if (access == "row")
+            thin[ndim - 1] = true;
+        else if (access == "column")
+            std::fill(thin.begin(), thin.end() - 1, true);
+        else if (access == "frame")
+            thin[0] = true;
+    }
+    double chunk_bytes = elem_size;
+    for (size_t i = 0; i < ndim; i++)
+    {
+        if (thin[i])
+            chunk[i] = 1;
+        chunk_bytes *= chunk[i];
+    }
+
+    // shrink the other dimensions, starting from the slowest varying
+    for (size_t idx = 0, n = 0; n < ndim; idx++)
+    {
+        if (chunk_bytes < 1.5 * target && chunk_bytes < limit)
+            break;
+        hsize_t &c = chunk[idx % ndim];
+        if (thin[idx % ndim] || c == 1)
+        {
+            n++; // stop when all dims are exhausted
+            continue;
+        }
+        n = 0;
+        chunk_bytes = chunk_bytes / c * ((c + 1) / 2);
+        c = (c + 1) / 2;
+    }
+
+    // grow the restricted dimensions, starting from the fastest varying,
+    // while the chunk stays below the target size
+    for (size_t idx = 0, n = 0; n < ndim; idx++)
+    {
+        size_t i = ndim - 1 - idx % ndim;
+        hsize_t c = chunk[i], c2 = dims[i] ? std::min<hsize_t>(2 * c, dims[i]) : 2 * c;
+        double bytes = chunk_bytes / c * c2;
+        if (!thin[i] || c2 == c || bytes >= 1.5 * target || bytes >= std::max(limit, target))
+        {
+            n++;
+            continue;
+        }
+        n = 0;
+        chunk[i] = c2;
+        chunk_bytes = bytes;
+    }
+    return chunk;
+}
+
+string h5_concat_path(const string &path, const string &obj_name)
+{
+    string p(path);
+    if (path.back() != '/')
+        p += '/';
+    p += obj_name;
+    return p;
+}
+
+struct link_iterate_data_t
+{
+    vector<hdf5oct::link_info_t> &links;
+    bool follow_external;
+};
+
+static herr_t get_link_info(hid_t gid, const char *name, const H5L_info_t *linfo, void *op_data)
+{
+    auto *data = static_cast<link_iterate_data_t *>(op_data);
+    hdf5oct::link_info_t l{name, linfo->type, H5O_TYPE_UNKNOWN};
+    if (linfo->type != H5L_TYPE_EXTERNAL || data->follow_external)
+    {
+        // the object header gives the type, soft links are resolved
+#if H5_VERSION_GE(1, 12, 0)
+        H5O_info2_t oinfo;
+#else
+        H5O_info_t oinfo;
+#endif
+        herr_t err;
+        H5E_BEGIN_TRY
+        {
+#if H5_VERSION_GE(1, 12, 0)
+            err = H5Oget_info_by_name3(gid, name, &oinfo, H5O_INFO_BASIC, H5P_DEFAULT);
+#elif H5_VERSION_GE(1, 10, 3)
+            err = H5Oget_info_by_name2(gid, name, &oinfo, H5O_INFO_BASIC, H5P_DEFAULT);
+#else
+            err = H5Oget_info_by_name(gid, name, &oinfo, H5P_DEFAULT);
+#endif
+        }
+        H5E_END_TRY;
+        if (err >= 0)
+            l.obj_type = oinfo.type;
+    }
+    data->links.push_back(l);
+    return 0;
+}
+
+std::vector<hdf5oct::link_info_t> hdf5oct::listGroupMembers(const H5::Group &g,
+                                                            bool follow_external)
+{
+    vector<link_info_t> links;
+    links.reserve(g.getNumberObjects());
+    link_iterate_data_t data{links, follow_external};
+    if (H5Literate(g.getId(), H5_INDEX_NAME, H5_ITER_INC, nullptr,
+                   get_link_info, &data) < 0)
+        H5::HDF5ErrMapper::ToException<H5::GroupException>(
+            "Error iterating over the members of group " + g.getPath());
+    return links;
+}
+
+struct group_members_t
+{
+    vector<string> &names;
+    vector<H5::Object> &objects;
+};
+
+static herr_t open_group_member(hid_t gid, const char *name, const H5L_info_t *, void *op_data)
+{
+    auto *members = static_cast<group_members_t *>(op_data);
+    hid_t id;
+    H5E_BEGIN_TRY
+    {
+        id = H5Oopen(gid, name, H5P_DEFAULT);
+    }
+    H5E_END_TRY;
+    if (id < 0)
+        return 0; // skip unresolvable links
+    members->names.push_back(name);
+    members->objects.push_back(H5::detail::make_object(id));
+    return 0;
+}
+
+void hdf5oct::openGroupMembers(const H5::Group &g, std::vector<std::string> &names,
+                               std::vector<H5::Object> &objects)
+{
+    names.clear();
+    objects.clear();
+    size_t n = g.getNumberObjects();
+    names.reserve(n);
+    objects.reserve(n);
+    group_members_t members{names, objects};
+    if (H5Literate(g.getId(), H5_INDEX_NAME, H5_ITER_INC, nullptr,
+                   open_group_member, &members) < 0)
+        H5::HDF5ErrMapper::ToException<H5::GroupException>(
+            "Error iterating over the members of group " + g.getPath());
+}
+
+void hdf5oct::dspace_info_t::assign(const H5::DataSpace &ds)
+{
+    int ndim;
+    switch (H5Sget_simple_extent_type(ds.getId()))
+    {
+    case H5S_SIMPLE:
+        extent_type = "Simple";
+        ndim = ds.getNumberDimensions();
+        size = uint64NDArray(dim_vector(1, ndim));
+        maxsize = uint64NDArray(dim_vector(1, ndim));
+        {
+            auto dims = ds.getDimensions();
+            auto maxdims = ds.getMaxDimensions();
+            for (octave_idx_type i = 0; i < ndim; i++)
+            {
+                size(i) = dims[ndim - 1 - i];
+                maxsize(i) = maxdims[ndim - i - 1];
+            }
+        }
+        break;
+    case H5S_SCALAR:
+        extent_type = "Scalar";
+        break;
+    case H5S_NULL:
+        extent_type = "Empty";
+        break;
+    default:
+        break;
+    }
+}
+octave_scalar_map hdf5oct::dspace_info_t::oct_map() const
+{
+    map<string, octave_value> M;
+    M["ExtentType"] = extent_type;
+    M["Size"] = size;
+    // Return maxsize as a double array to get the "inf" for unlimited dimensions
+    RowVector dmaxsize(maxsize.numel());
+    for (int i = 0; i < maxsize.numel(); i++)
+    {
+        dmaxsize(i) = hsize_t(maxsize(i)) == H5::DataSpace::UNLIMITED ? INFINITY : double(maxsize(i));
+    }
+    M["MaxSize"] = dmaxsize;
+    return octave_scalar_map(M);
+}
+bool hdf5oct::dspace_info_t::needs_chunk() const
+{
+    if (size.isempty())
+        return false;
+    int n = size.numel();
+    // HDF5 specs: chunking is needed if size!=maxsize OR maxsize==unlimited
+    for (int i = 0; i < n; i++)
+    {
+        if (size(i) != maxsize(i) || (size_t(maxsize(i)) == H5::DataSpace::UNLIMITED))
+            return true;
+    }
+    return false;
+}
+
+void hdf5oct::dtype_info_t::assign(const H5::DataType &dt)
+{
+    string s = dt.string();
+    switch (dt.getClass())
+    {
+    case H5::DataTypeClass::Integer:
+        h5class = "int";
+        {
+            bool isUnsigned = (H5Tget_sign(dt.getId()) == H5T_SGN_NONE);
+            signed_status = isUnsigned ? "unsigned" : "signed";
+            size = dt.getSize();
+            if (size <= 8)
+            {
+                octave_class = isUnsigned ? "uint" : "int";
+                octave_class += to_string(size * 8);
+            }
+        }
+        break;
+    case H5::DataTypeClass::Float:
+        h5class = "float";
+        {
+            size = dt.getSize();
+            if (size == 4)
+                octave_class = "single";
+            if (size == 8)
+                octave_class = "double";
+        }
+        break;
+    case H5::DataTypeClass::Time:
+        h5class = "time";
+        break;
+    case H5::DataTypeClass::String:
+        h5class = "string";
+        {
+            H5::StringType st = dt.asStringType();
+            size = st.isVariableStr() ? H5T_VARIABLE : st.getSize();
+            switch (st.getCharacterSet())
+            {
+            case H5::CharacterSet::Ascii:
+                cset = "ascii";
+                break;
+            case H5::CharacterSet::Utf8:
+                cset = "utf8";
+                break;
+            default:
+                break;
+            }
+            switch (st.getPadding())
+            {
+            case H5::StringPadding::NullTerminated:
+                pading = "nullterm";
+                break;
+            case H5::StringPadding::NullPadded:
+                pading = "nullpad";
+                break;
+            case H5::StringPadding::SpacePadded:
+                pading = "spacepad";
+                break;
+            default:
+                break;
+            }
+            octave_class = "string";
+        }
+        break;
+    case H5::DataTypeClass::BitField:
+        h5class = "bitfield";
+        break;
+    case H5::DataTypeClass::Opaque:
+        h5class = "opaque";
+        break;
+    case H5::DataTypeClass::Compound:
+        h5class = "compound";
+        if (dt == h5o::h5traits<std::complex<double>>::predType())
+        {
+            octave_class = "double complex";
+            size = dt.getSize();
+        }
+        else if (dt == h5o::h5traits<std::complex<float>>::predType())
+        {
+            octave_class = "single complex";
+            size = dt.getSize();
+        }
+        else
+        {
+            // a table, read into a struct with one field per member
+            H5::CompoundType ct{H5::DataType(dt)};
+            bool ok = true;
+            for (const auto &m : ct.getMembers())
+            {
+                dtype_info_t mi;
+                mi.assign(m.base_type);
+                ok = ok && !mi.octave_class.empty() && mi.octave_class != "struct";
+                fields.push_back(m.name);
+            }
+            if (ok && !fields.empty())
+            {
+                octave_class = "struct";
+                size = dt.getSize();
+            }
+            else
+                fields.clear();
+        }
+        break;
+    case H5::DataTypeClass::Reference:
+        h5class = "reference";
+        break;
+    case H5::DataTypeClass::Enum:
+        h5class = "enum";
+        if (dt == h5o::h5traits<bool>::predType())
+        {
+            octave_class = "logical";
+            size = dt.getSize();
+        }
+        break;
+    case H5::DataTypeClass::VarLen:
+        h5class = "vlen";
+        break;
+    case H5::DataTypeClass::Array:
+        h5class = "array";
+        break;
+    case H5::DataTypeClass::Invalid:
+    default:
+        break;
+    }
+}
+octave_scalar_map hdf5oct::dtype_info_t::oct_map() const
+{
+    map<string, octave_value> M;
+    M["Class"] = h5class;
+    M["OctaveClass"] = octave_class;
+    if (size)
+        M["Size"] = size == H5T_VARIABLE ? octave_value("H5T_VARIABLE") : octave_value(size);
+    if (!signed_status.empty())
+        M["Sign"] = signed_status;
+    if (!cset.empty())
+        M["charSet"] = cset;
+    if (!pading.empty())
+        M["Pading"] = pading;
+    if (!fields.empty())
+    {
+        Cell names(dim_vector(1, fields.size()));
+        for (size_t i = 0; i < fields.size(); i++)
+            names(i) = fields[i];
+        M["Fields"] = names;
+    }
+    return octave_scalar_map(M);
+}
+void hdf5oct::dset_info_t::assign(const H5::DataSet &ds, const string &path,
+                                  const info_opts_t &opts)
+{
+    name = path;
+    if (opts.attributes != info_opts_t::NoAttributes)
+        attributes = readAttributes(ds, opts.attributes == info_opts_t::AttributeValues);
+    details = opts.dataset_details;
+    if (!details)
+        return;
+    refreshSWMR(ds);
+    H5::DataType dt = ds.getDataType();
+    dtype_info.assign(dt);
+    dspace_info.assign(logicalSpace(ds));
+    // check creation properties
+    H5::DataSetCreateProps dscpl = ds.getCreatePropertyList();
+    chunksize = getChunkSize(ds);
+    if (!chunksize.isempty())
+        chunk_cache.assign(ds.getAccessPropertyList());
+    fillValue = getFillValue(dscpl, dtype_info.octave_class);
+    // get the filter pipeline
+    int nfilters = H5Pget_nfilters(dscpl.getId());
+    for (int i = 0; i < nfilters; i++)
+    {
+        unsigned flags;
+        size_t ncd = 16;
+        vector<unsigned> cd(ncd);
+        char fname[256] = "";
+        H5Z_filter_t id = H5Pget_filter2(dscpl.getId(), i, &flags, &ncd, cd.data(),
+                                         sizeof(fname), fname, nullptr);
+        if (id < 0)
+            continue;
+        cd.resize(std::min(ncd, cd.size()));
+        filter_info_t f{fname, cd};
+        if (f.name.empty())
+            f.name = "filter " + to_string(id);
+        filters.push_back(f);
+    }
+}
+octave_scalar_map hdf5oct::dset_info_t::oct_map() const
+{
+    // all map fields mandatory !!
+    map<string, octave_value> M;
+    M["Name"] = name;
+    M["Attributes"] = attributes;
+    if (!details)
+    {
+        for (const char *key : {"Datatype", "Dataspace", "ChunkSize", "ChunkCache", "FillValue", "Filters"})
+            M[key] = Matrix();
+        return octave_scalar_map(M);
+    }
+    M["Datatype"] = dtype_info.oct_map();
+    M["Dataspace"] = dspace_info.oct_map();
+    M["ChunkSize"] = chunksize;
+    M["ChunkCache"] = chunksize.isempty() ? octave_value(Matrix()) : octave_value(chunk_cache.oct_map());
+    M["FillValue"] = fillValue;
+    vector<string> keys{"Name", "Data"};
+    octave_map fmap(dim_vector(filters.size(), 1), keys);
+    for (size_t i = 0; i < filters.size(); i++)
+    {
+        octave_scalar_map f;
+        RowVector data(filters[i].cd_values.size());
+        for (octave_idx_type j = 0; j < data.numel(); j++)
+            data(j) = filters[i].cd_values[j];
+        f.assign("Name", filters[i].name);
+        f.assign("Data", data);
+        fmap.fast_elem_insert(i, f);
+    }
+    M["Filters"] = fmap;
+    return octave_scalar_map(M);
+}
+void hdf5oct::group_info_t::assign(const H5::Group &g, const string &path,
+                                   const info_opts_t &opts, int level)
+{
+    name = path;
+    if (opts.attributes != info_opts_t::NoAttributes)
+        attributes = readAttributes(g, opts.attributes == info_opts_t::AttributeValues);
+    // the members of groups below the requested depth are not listed
+    if (opts.depth >= 0 && level >= opts.depth)
+        return;
+
+    // names and types of all members in one pass over the links
+    vector<link_info_t> links = listGroupMembers(g, true);
+    size_t ngroups = 0, ndsets = 0, ndtypes = 0;
+    for (const auto &l : links)
+    {
+        ngroups += l.obj_type == H5O_TYPE_GROUP;
+        ndsets += l.obj_type == H5O_TYPE_DATASET;
+        ndtypes += l.obj_type == H5O_TYPE_NAMED_DATATYPE;
+    }
+    // children are built in place, the vectors are never reallocated
+    groups.reserve(ngroups);
+    datasets.reserve(ndsets);
+    datatypes.reserve(ndtypes);
+    for (const auto &l : links)
+    {
+        switch (l.obj_type)
+        {
+        case H5O_TYPE_GROUP:
+            groups.emplace_back();
+            groups.back().assign(g.getGroup(l.name),
+                                 h5_concat_path(path, l.name), opts, level + 1);
+            break;
+        case H5O_TYPE_DATASET:
+            datasets.emplace_back();
+            datasets.back().assign(g.getDataSet(l.name),
+                                   h5_concat_path(path, l.name), opts);
+            break;
+        case H5O_TYPE_NAMED_DATATYPE:
+            datatypes.emplace_back();
+            datatypes.back().assign(g.getDataType(l.name),
+                                    h5_concat_path(path, l.name));
+            break;
+        default: // external or dangling links
+            break;
+        }
+    }
+}
+octave_scalar_map hdf5oct::group_info_t::oct_map() const
+{
+    // all map fields mandatory !!
+    map<string, octave_value> M;
+    M["Name"] = name;
+
+    octave_map omap;
+
+    vector<string> keys{"Name", "Groups", "Datasets",
+                        "Datatypes", "Attributes"};
+    omap = octave_map(dim_vector(groups.size(), 1), keys);
+    for (int i = 0; i < groups.size(); i++)
+        omap.fast_elem_insert(i, groups[i].oct_map());
+    M["Groups"] = omap;
+
+    keys = {"Name", "Datatype", "Dataspace", "ChunkSize", "ChunkCache", "FillValue", "Filters", "Attributes"};
+    omap = octave_map(dim_vector(datasets.size(), 1), keys);
+    for (int i = 0; i < datasets.size(); i++)
+        omap.fast_elem_insert(i, datasets[i].oct_map());
+    M["Datasets"] = omap;
+
+    keys = {"Name"};
+    omap = octave_map(dim_vector(datatypes.size(), 1), keys);
+    for (int i = 0; i < datatypes.size(); i++)
+        omap.fast_elem_insert(i, datatypes[i].oct_map());
+    M["Datatypes"] = omap;
+
+    M["Attributes"] = attributes;
+
+    return octave_scalar_map(M);
+}
+
+// compatible means:
+// - same datatype spec
+// - same extent type (Scalar/Simple)
+// - same dimensionality
+// - same # of elements in each dim
+bool hdf5oct::data_exchange::isCompatible(const data_exchange &dx)
+{
+    if (dtype_spec != dx.dtype_spec)
+    {
+        lastError = "different datatype specs";
+        return false;
+    }
+    if (dtype.getSize() != dx.dtype.getSize())
+    {
+        lastError = "different datatype size";
+        return false;
+    }
+
+    // a list of elements is compatible with any array of the same number of elements
+    if (element_list || dx.element_list)
+    {
+        if (dv.numel() != dx.dv.numel())
+        {
+            lastError = "different number of elements";
+            return false;
+        }
+        return true;
+    }
+
+    if (dspace_info.extent_type != dx.dspace_info.extent_type)
+    {
+        lastError = "different dataspaces extent type";
+        return false;
+    }
+
+    if (dspace_info.isSimple())
+    {
+        int ndim = dspace.getNumberDimensions();
+        if (ndim != dx.dspace.getNumberDimensions())
+        {
+            lastError = "different dataspace dimensionality";
+            return false;
+        }
+        if (ndim == 1 && (dv(1) != dx.dv(1)))
+        {
+            lastError = "different number of elements";
+            return false;
+        }
+        if (ndim > 1)
+        {
+            for (int i = 0; i < ndim; i++)
+            {
+                if (dv(i) != dx.dv(i))
+                {
+                    lastError = "different number of elements";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void hdf5oct::data_exchange::reset()
+{
+    lastError = "";
+    ov = octave_value();
+    dset = nullptr;
+    attr = nullptr;
+    dtype = H5::DataType();
+    dtype_info = dtype_info_t();
+    dspace = H5::DataSpace::Null();
+    dspace_info = dspace_info_t();
+    dtype_spec = "";
+    xfer_props = H5::DataTransferProps();
+    element_list = false;
+    mapping.reset();
+}
+
+bool hdf5oct::data_exchange::assign(H5::DataSet *ds)
+{
+    reset();
+    dset = ds;
+    refreshSWMR(*ds);
+    if (!ds->hasAttribute(appendSizeAttr))
+        return assign(ds->getDataType(), ds->getSpace());
+
+    // over-allocated by h5append: select the elements within the logical size
+    if (!assign(ds->getDataType(), logicalSpace(*ds)))
+        return false;
+    vector<size_t> dims = logicalDims(*ds);
+    dspace = ds->getSpace();
+    if (std::find(dims.begin(), dims.end(), 0) != dims.end())
+        H5Sselect_none(dspace.getId());
+    else
+        dspace = H5::HyperSlab(H5::RegularHyperSlab(vector<size_t>(dims.size(), 0), dims))
+                     .apply(dspace);
+    return true;
+}
+
+bool hdf5oct::data_exchange::assign(const H5::Attribute *aattr)
+{
+    reset();
+    attr = aattr;
+    return assign(attr->getDataType(), attr->getSpace());
+}
+
+bool hdf5oct::data_exchange::assign(const H5::DataType &t, const H5::DataSpace &s)
+{
+    dtype = t;
+    dspace = s;
+
+    // check datatype
+    dtype_info.assign(dtype);
+    if (dtype_info.h5class.empty())
+    {
+        lastError = "Invalid HDF5 datatype";
+        return false;
+    }
+    if (dtype_info.octave_class.empty())
+    {
+        lastError = "Unsupported datatype '";
+        lastError += dtype_info.h5class;
+        lastError += "'";
+        return false;
+    }
+    dtype_spec = dtype_info.octave_class;
+
+    // check dataspace
+    dspace_info.assign(dspace);
+    if (dspace_info.extent_type.empty() ||
+        dspace_info.isNull())
+    {
+        lastError = "Empty HDF5 dataspace";
+        return false;
+    }
+    if (dspace_info.isScalar())
+        dv = dim_vector(1, 1);
+    if (dspace_info.isSimple())
+    {
+        size_t n = dspace_info.size.numel();
+        if (n == 1)
+            dv = dim_vector(1, dspace_info.size(0)); // 1D dataset -> [1xN] octave array
+        else
+        {
+            dv.resize(n);
+            for (size_t i = 0; i < n; i++)
+                dv(i) = dspace_info.size(i);
+        }
+    }
+
+    return true;
+}
+
+bool hdf5oct::data_exchange::selectHyperslab(uint64NDArray start,
+                                             uint64NDArray count, uint64NDArray stride, bool tryExtend)
+{
+    if (dspace_info.isNull())
+    {
+        lastError = "Hyperslab selection not possible. Dataset is NULL";
+        return false;
+    }
+    if (dspace_info.isScalar())
+    {
+        lastError = "Hyperslab selection not possible for scalar datasets";
+        return false;
+    }
+
+    int ndim = dspace_info.size.numel();
+    vector<size_t> hstart(ndim), hcount(ndim),
+        hstride(ndim),
+        fdims = logicalDims(*dset);
+
+    bool need_extend = false;
+    for (int i = 0; i < ndim; i++)
+    {
+        int j = ndim - 1 - i;
+        hstart[j] = size_t(start(i)) - 1;
+        hcount[j] = count(i);
+        hstride[j] = (stride.isempty()) ? 1 : size_t(stride(i));
+        size_t end = hstart[j] + 1 + (hcount[j] - 1) * hstride[j];
+        if (end > fdims[j])
+        {
+            if (tryExtend)
+            {
+                if (end < size_t(dspace_info.maxsize(i)))
+                {
+                    fdims[j] = end;
+                    need_extend = true;
+                }
+                else
+                {
+                    lastError = "Hyperslab selection superseeds size of non-extensible dataset";
+                    return false;
+                }
+            }
+            else
+            {
+                lastError = "hyperslab selection beyond the dataset's size";
+                return false;
+            }
+        }
+    }
+    if (need_extend)
+        dset->resize(fdims);
+    dspace = dset->getSpace();
+    H5::HyperSlab slab(H5::RegularHyperSlab(hstart, hcount, hstride));
+    dspace = slab.apply(dspace);
+    // adjust dim_vector
+    if (ndim == 1)
+        dv(1) = count(0); // special case of 1D h5 -> [1xN] octave
+    else
+        for (int i = 0; i < ndim; i++)
+            dv(i) = count(i);
+    return true;
+}
+
+bool hdf5oct::data_exchange::selectPoints(const uint64NDArray &P)
+{
+    if (!dspace_info.isSimple())
+    {
+        lastError = "point selection is possible only for simple dataspaces";
+        return false;
+    }
+
+    int rank = dspace.getNumberDimensions();
+    vector<size_t> fdims = logicalDims(*dset);
+    octave_idx_type n = P.rows(), nc = P.columns();
+    // a 1D dataset is a [1xN] octave array, so [1 j] or j are accepted
+    if (nc != rank && !(rank == 1 && nc == 2))
+    {
+        lastError = "the coordinates must have one column per dataset dimension";
+        return false;
+    }
+    vector<hsize_t> coords(n * rank);
+    for (octave_idx_type i = 0; i < n; i++)
+    {
+        if (rank == 1 && nc == 2 && P(i, 0) != 1)
+        {
+            lastError = "point coordinates beyond the dataset's size";
+            return false;
+        }
+        for (int k = 0; k < rank; k++)
+        {
+            uint64_t c = P(i, nc - 1 - k);
+            if (c < 1 || c > fdims[k])
+            {
+                lastError = "point coordinates beyond the dataset's size";
+                return false;
+            }
+            coords[i * rank + k] = c - 1;
+        }
+    }
+
+    dspace = dset->getSpace();
+    herr_t err = n > 0 ? H5Sselect_elements(dspace.getId(), H5S_SELECT_SET, n, coords.data())
+                       : H5Sselect_none(dspace.getId());
+    if (err < 0)
+    {
+        lastError = "H5Sselect_elements failed";
+        return false;
+    }
+    dv = dim_vector(n, 1);
+    element_list = true;
+    return true;
+}
+
+bool hdf5oct::data_exchange::selectMask(const boolNDArray &M)
+{
+    if (!dspace_info.isSimple())
+    {
+        lastError = "mask selection is possible only for simple dataspaces";
+        return false;
+    }
+
+    int rank = dspace.getNumberDimensions();
+    vector<size_t> fdims = logicalDims(*dset);
+    // the mask must have the dataset's size, trailing singleton dimensions aside
+    dim_vector mdv = M.dims();
+    bool same_size = M.numel() == dv.numel();
+    if (rank == 1)
+        same_size = same_size && mdv.ndims() == 2 && (mdv(0) == 1 || mdv(1) == 1);
+    else
+        for (int i = 0; same_size && i < std::max(rank, int(mdv.ndims())); i++)
+        {
+            size_t a = i < mdv.ndims() ? mdv(i) : 1;
+            size_t b = i < rank ? fdims[rank - 1 - i] : 1;
+            same_size = a == b;
+        }
+    if (!same_size)
+    {
+        lastError = "the mask must have the same size as the dataset";
+        return false;
+    }
+
+    // Runs of true values along the fastest varying dimension
+    // are selected as blocks, in the order of the elements
+    dspace = dset->getSpace();
+    hid_t sid = dspace.getId();
+    hsize_t start[H5S_MAX_RANK] = {}, count[H5S_MAX_RANK], block[H5S_MAX_RANK];
+    std::fill(count, count + rank, 1);
+    std::fill(block, block + rank, 1);
+    H5S_seloper_t op = H5S_SELECT_SET;
+    octave_idx_type nsel = 0;
+    size_t len = fdims[rank - 1];
+    size_t nlines = len ? M.numel() / len : 0;
+    const bool *m = M.data();
+    for (size_t l = 0; l < nlines; l++, m += len)
+    {
+        for (size_t j = 0; j < len;)
+        {
+            if (!m[j])
+            {
+                j++;
+                continue;
+            }
+            size_t k = j + 1;
+            while (k < len && m[k])
+                k++;
+            start[rank - 1] = j;
+            block[rank - 1] = k - j;
+            if (H5Sselect_hyperslab(sid, op, start, nullptr, count, block) < 0)
+            {
+                lastError = "H5Sselect_hyperslab failed";
+                return false;
+            }
+            op = H5S_SELECT_OR;
+            nsel += k - j;
+            j = k;
+        }
+        for (int d = rank - 2; d >= 0; d--)
+        {
+            if (++start[d] < fdims[d])
+                break;
+            start[d] = 0;
+        }
+    }
+    if (nsel == 0 && H5Sselect_none(sid) < 0)
+    {
+        lastError = "H5Sselect_none failed";
+        return false;
+    }
+    dv = dim_vector(nsel, 1);
+    element_list = true;
+    return true;
+}
+
+bool hdf5oct::data_exchange::assign(octave_value v)
+{
+
+    reset();
+
+    // find class
+    if (v.islogical())
+    {
+        dtype_spec = "logical";
+    }
+    else if (v.isinteger())
+    {
+        if (v.is_uint64_type())
+            dtype_spec = "uint64";
+        else if (v.is_int64_type())
+            dtype_spec = "int64";
+        else if (v.is_uint32_type())
+            dtype_spec = "uint32";
+        else if (v.is_int32_type())
+            dtype_spec = "int32";
+        else if (v.is_uint16_type())
+            dtype_spec = "uint16";
+        else if (v.is_int16_type())
+            dtype_spec = "int16";
+        else if (v.is_uint8_type())
+            dtype_spec = "uint8";
+        else if (v.is_int8_type())
+            dtype_spec = "int8";
+    }
+    else if (v.isreal())
+    {
+        if (v.is_double_type())
+            dtype_spec = "double";
+        else if (v.is_single_type())
+            dtype_spec = "single";
+    }
+    else if (v.iscomplex())
+    {
+        if (v.is_double_type())
+            dtype_spec = "double complex";
+        else if (v.is_single_type())
+            dtype_spec = "single complex";
+    }
+    else if (v.iscellstr())
+        dtype_spec = "string";
+
+    if (dtype_spec.empty())
+    {
+        lastError = "Unsupported Octave data of class '";
+        lastError += v.class_name();
+        lastError += "'";
+        return false;
+    }
+    // get h5 datatype
+    dtype = h5type_from_spec(dtype_spec);
+
+    // prepare h5 memory dataspace & octave dimensions
+    dspace = H5::DataSpace::Scalar();
+    dv = v.dims();
+    int ndim = dv.ndims();
+    // find # of data elements
+    hsize_t nelem = 1;
+    for (int i = 0; i < ndim; i++)
+        nelem *= dv(i);
+    if (nelem > 1) // if not scalar (octave 1x1)
+    {
+        vector<size_t> dims(ndim);
+        for (int i = 0; i < ndim; i++)
+            dims[ndim - 1 - i] = dv(i);
+        dspace = H5::DataSpace(dims);
+    }
+    dspace_info.assign(dspace);
+
+    ov = v;
+
+    return true;
+}
+
+void hdf5oct::data_exchange::write(const data_exchange &dxfile)
+{
+    write_buffer b;
+    prepareWrite(b);
+    if (b.hold)
+        writeRaw(dxfile.dset->getId(), b.mem_type.getId(), dspace.getId(),
+                 dxfile.dspace.getId(), b.data, nthreads);
+}
+
+void hdf5oct::data_exchange::prepareWrite(write_buffer &b) const
+{
+    if (dtype_spec == "double")
+        prepare_impl<double>(b);
+    else if (dtype_spec == "single")
+        prepare_impl<float>(b);
+    else if (dtype_spec == "double complex")
+        prepare_impl<std::complex<double>>(b);
+    else if (dtype_spec == "single complex")
+        prepare_impl<std::complex<float>>(b);
+    else if (dtype_spec == "uint64")
+        prepare_impl<uint64_t>(b);
+    else if (dtype_spec == "int64")
+        prepare_impl<int64_t>(b);
+    else if (dtype_spec == "uint32")
+        prepare_impl<uint32_t>(b);
+    else if (dtype_spec == "int32")
+        prepare_impl<int32_t>(b);
+    else if (dtype_spec == "uint16")
+        prepare_impl<uint16_t>(b);
+    else if (dtype_spec == "int16")
+        prepare_impl<int16_t>(b);
+    else if (dtype_spec == "uint8")
+        prepare_impl<uint8_t>(b);
+    else if (dtype_spec == "int8")
+        prepare_impl<int8_t>(b);
+    else if (dtype_spec == "logical")
+        prepare_impl<bool>(b);
+    else if (dtype_spec == "string")
+        prepare_string(b);
+}
+
+void hdf5oct::data_exchange::prepare_string(write_buffer &b) const
+{
+    struct strings_t
+    {
+        Array<string> A;
+        vector<const char *> p;
+    };
+    auto S = std::make_shared<strings_t>();
+    S->A = ov.cellstr_value();
+    if (transposed)
+        S->A = S->A.permute(reversal(dv.ndims()));
+    octave_idx_type n = S->A.numel();
+    S->p.resize(n);
+    for (octave_idx_type i = 0; i < n; i++)
+        S->p[i] = S->A(i).data();
+    b.mem_type = dtype;
+    b.data = S->p.data();
+    b.hold = S;
+}
+
+void hdf5oct::data_exchange::writeRaw(hid_t dset, hid_t mem_type, hid_t mem_space,
+                                      hid_t file_space, const void *buf, unsigned nthreads)
+{
+    if (nthreads < 2 || !writeChunksParallel(dset, mem_type, file_space, buf, nthreads))
+        H5::detail::h5d_write(dset, mem_type, mem_space, file_space, H5P_DEFAULT, buf);
+}
+
+void hdf5oct::string_arena::indexFixed(size_t n, size_t sz, H5T_str_t pad)
+{
+    pos.resize(n);
+    len.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        pos[i] = i * sz;
+        len[i] = pad == H5T_STR_SPACEPAD ? sz : strnlen(bytes.data() + pos[i], sz);
+    }
+}
+
+void hdf5oct::string_arena::append(char *const *p, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t l = p[i] ? strlen(p[i]) : 0;
+        pos.push_back(bytes.size());
+        len.push_back(l);
+        bytes.insert(bytes.end(), p[i], p[i] + l);
+    }
+}
+
+octave_value hdf5oct::string_arena::cellstr(const dim_vector &dv) const
+{
+    Cell C(dv);
+    for (size_t i = 0; i < size(); i++)
+        C(i) = octave_value(string(bytes.data() + pos[i], len[i]));
+    return octave_value(C);
+}
+
+octave_value hdf5oct::string_arena::charMatrix() const
+{
+    size_t n = size(), w = 0;
+    for (size_t i = 0; i < n; i++)
+        w = std::max(w, len[i]);
+    charNDArray M(dim_vector(n, w), ' ');
+    char *d = M.fortran_vec();
+    for (size_t i = 0; i < n; i++)
+        for (size_t k = 0; k < len[i]; k++)
+            d[i + k * n] = bytes[pos[i] + k];
+    return octave_value(M, '\'');
+}
+
+// The strings of S in the order and shape of the output of read()
+octave_value hdf5oct::data_exchange::string_value(string_arena &S)
+{
+    dim_vector odv = dv;
+    if (transposed)
+    {
+        // reorder the strings, which stay in place
+        odv = reversed(dv);
+        vector<size_t> pos(S.size()), len(S.size());
+        reverse(S.pos.data(), pos.data(), odv, sizeof(size_t));
+        reverse(S.len.data(), len.data(), odv, sizeof(size_t));
+        S.pos.swap(pos);
+        S.len.swap(len);
+    }
+    if (char_strings)
+        return S.charMatrix();
+    if (S.size() == 1)
+        return octave_value(string(S.bytes.data() + S.pos[0], S.len[0]));
+    return S.cellstr(odv);
+}
+
+octave_value hdf5oct::data_exchange::read_string()
+{
+    size_t n = 1;
+    for (octave_idx_type i = 0; i < dv.ndims(); i++)
+        n *= dv(i);
+
+    string_arena S;
+    H5::DataType mem_type = memType(dtype);
+    if (dtype_info.size != H5T_VARIABLE)
+    {
+        size_t sz = dtype_info.size;
+        S.bytes.resize(n * sz);
+        h5read(*dset, S.bytes.data(), mem_type, from_dim_vector(dv), dspace, xfer_props);
+        S.indexFixed(n, sz, H5Tget_strpad(dtype.getId()));
+        return string_value(S);
+    }
+
+    // Variable-length strings are read in batches along the slowest
+    // dimension longer than 1, so that the memory allocated by HDF5 for them is
+    // reclaimed as they are copied. Point selections are read at once
+    const hsize_t batch = 65536;
+    hid_t fid = dspace.getId();
+    int rank = H5Sget_simple_extent_ndims(fid), d = 0;
+    H5S_sel_type sel = H5Sget_select_type(fid);
+    hsize_t dims[H5S_MAX_RANK] = {1};
+    if (rank > 0)
+        H5Sget_simple_extent_dims(fid, dims, nullptr);
+    while (d < rank - 1 && dims[d] == 1)
+        d++;
+    hsize_t step = dims[d];
+    if (n > batch && rank > 0 && (sel == H5S_SEL_ALL || sel == H5S_SEL_HYPERSLABS))
+        step = std::max<hsize_t>(1, batch * dims[d] / n);
+
+    S.pos.reserve(n);
+    S.len.reserve(n);
+    vector<char *> p;
+    for (hsize_t r = 0; r < dims[d]; r += step)
+    {
+        H5::DataSpace fspace = dspace;
+        if (step < dims[d])
         {
-            octave_class = "logical";
-            size = dt.getSize();
+            hsize_t start[H5S_MAX_RANK] = {}, count[H5S_MAX_RANK];
+            std::copy(dims, dims + rank, count);
+            start[d] = r;
+            count[d] = std::min(step, dims[d] - r);
+            fspace = dspace.clone();
+            if (H5Sselect_hyperslab(fspace.getId(), H5S_SELECT_AND, start, nullptr, count,
+                                    nullptr) < 0)
+                throw H5::DataSpaceException("Failed to split the selection");
         }
-        break;
-    case H5::DataTypeClass::VarLen:
-        h5class = "vlen";
-        break;
-    case H5::DataTypeClass::Array:
-        h5class = "array";
-        break;
-    case H5::DataTypeClass::Invalid:
-    default:
-        break;
+        size_t m = rank > 0 ? H5Sget_select_npoints(fspace.getId()) : 1;
+        if (m == 0)
+            continue;
+        p.assign(m, nullptr);
+        H5::DataSpace mspace(vector<size_t>{m});
+        h5read(*dset, p.data(), mem_type, mspace, fspace, xfer_props);
+        S.append(p.data(), m);
+        if (H5Dvlen_reclaim(mem_type.getId(), mspace.getId(), H5P_DEFAULT, p.data()) < 0)
+        {
+            lastError = "Error in call to H5Dvlen_reclaim";
+            return octave_value();
+        }
+    }
+    return string_value(S);
+}
+
+octave_value hdf5oct::data_exchange::read_attribute()
+{
+    octave_value ret;
+    if (dtype_spec == "double")
+        ret = read_attr_impl<double>();
+    else if (dtype_spec == "single")
+        ret = read_attr_impl<float>();
+    else if (dtype_spec == "double complex")
+        ret = read_attr_impl<std::complex<double>>();
+    else if (dtype_spec == "single complex")
+        ret = read_attr_impl<std::complex<float>>();
+    else if (dtype_spec == "uint64")
+        ret = read_attr_impl<uint64_t>();
+    else if (dtype_spec == "int64")
+        ret = read_attr_impl<int64_t>();
+    else if (dtype_spec == "uint32")
+        ret = read_attr_impl<uint32_t>();
+    else if (dtype_spec == "int32")
+        ret = read_attr_impl<int32_t>();
+    else if (dtype_spec == "uint16")
+        ret = read_attr_impl<uint16_t>();
+    else if (dtype_spec == "int16")
+        ret = read_attr_impl<int16_t>();
+    else if (dtype_spec == "uint8")
+        ret = read_attr_impl<uint8_t>();
+    else if (dtype_spec == "int8")
+        ret = read_attr_impl<int8_t>();
+    else if (dtype_spec == "logical")
+        ret = read_attr_impl<bool>();
+    else if (dtype_spec == "string")
+        ret = read_string_attr();
+    return ret;
+}
+
+octave_value hdf5oct::data_exchange::read_string_attr()
+{
+    if (attr == nullptr)
+    {
+        lastError = "Read requested from null attribute";
+        return octave_value();
+    }
+    size_t n = 1;
+    for (octave_idx_type i = 0; i < dv.ndims(); i++)
+        n *= dv(i);
+
+    string_arena S;
+    if (dtype_info.size == H5T_VARIABLE)
+    {
+        vector<char *> p(n);
+        H5::DataSpace memspace = from_dim_vector(dv);
+        attr->read(p.data(), dtype);
+        S.append(p.data(), n);
+        herr_t ret = H5Dvlen_reclaim(dtype.getId(), memspace.getId(), H5P_DEFAULT, p.data());
+        if (ret < 0)
+        {
+            lastError = "Error in call to H5Dvlen_reclaim";
+            throw H5::AttributeException("Failed to reclaim HDF5 internal memory");
+            return octave_value();
+        }
+    }
+    else
+    {
+        size_t sz = dtype_info.size;
+        S.bytes.resize(n * sz);
+        attr->read(S.bytes.data(), dtype);
+        S.indexFixed(n, sz, H5Tget_strpad(dtype.getId()));
+    }
+    return n > 1 ? S.cellstr(dv) : octave_value(string(S.bytes.data() + S.pos[0], S.len[0]));
+}
+
+octave_value hdf5oct::data_exchange::read()
+{
+    octave_value ret;
+    if (dtype_spec == "double")
+        ret = read_impl<double>();
+    else if (dtype_spec == "single")
+        ret = read_impl<float>();
+    else if (dtype_spec == "double complex")
+        ret = read_impl<std::complex<double>>();
+    else if (dtype_spec == "single complex")
+        ret = read_impl<std::complex<float>>();
+    else if (dtype_spec == "uint64")
+        ret = read_impl<uint64_t>();
+    else if (dtype_spec == "int64")
+        ret = read_impl<int64_t>();
+    else if (dtype_spec == "uint32")
+        ret = read_impl<uint32_t>();
+    else if (dtype_spec == "int32")
+        ret = read_impl<int32_t>();
+    else if (dtype_spec == "uint16")
+        ret = read_impl<uint16_t>();
+    else if (dtype_spec == "int16")
+        ret = read_impl<int16_t>();
+    else if (dtype_spec == "uint8")
+        ret = read_impl<uint8_t>();
+    else if (dtype_spec == "int8")
+        ret = read_impl<int8_t>();
+    else if (dtype_spec == "logical")
+        ret = read_impl<bool>();
+    else if (dtype_spec == "string")
+        ret = read_string();
+    else if (dtype_spec == "struct")
+        ret = read_compound();
+    return ret;
+}
+
+// Each member is read with a compound memory type of that member alone,
+// directly into its own array
+octave_value hdf5oct::data_exchange::read_compound()
+{
+    H5::CompoundType ct{H5::DataType(dtype)};
+    const auto &members = ct.getMembers();
+    octave_scalar_map S;
+    for (const string &name : fields.empty() ? dtype_info.fields : fields)
+    {
+        auto m = std::find_if(members.begin(), members.end(),
+                              [&](const H5::CompoundType::member_def &md)
+                              { return md.name == name; });
+        if (m == members.end())
+            continue;
+        data_exchange fx(*this);
+        fx.fields.clear();
+        fx.field = name;
+        fx.dtype = m->base_type;
+        fx.dtype_info = dtype_info_t();
+        fx.dtype_info.assign(fx.dtype);
+        fx.dtype_spec = fx.dtype_info.octave_class;
+        S.assign(name, fx.read());
+    }
+    return octave_value(S);
+}
+
+bool hdf5oct::data_exchange::allocate(allocation &a, H5::DataType &mem_type)
+{
+    if (dtype_spec == "double")
+        alloc_impl<double>(a, mem_type);
+    else if (dtype_spec == "single")
+        alloc_impl<float>(a, mem_type);
+    else if (dtype_spec == "double complex")
+        alloc_impl<std::complex<double>>(a, mem_type);
+    else if (dtype_spec == "single complex")
+        alloc_impl<std::complex<float>>(a, mem_type);
+    else if (dtype_spec == "uint64")
+        alloc_impl<uint64_t>(a, mem_type);
+    else if (dtype_spec == "int64")
+        alloc_impl<int64_t>(a, mem_type);
+    else if (dtype_spec == "uint32")
+        alloc_impl<uint32_t>(a, mem_type);
+    else if (dtype_spec == "int32")
+        alloc_impl<int32_t>(a, mem_type);
+    else if (dtype_spec == "uint16")
+        alloc_impl<uint16_t>(a, mem_type);
+    else if (dtype_spec == "int16")
+        alloc_impl<int16_t>(a, mem_type);
+    else if (dtype_spec == "uint8")
+        alloc_impl<uint8_t>(a, mem_type);
+    else if (dtype_spec == "int8")
+        alloc_impl<int8_t>(a, mem_type);
+    else if (dtype_spec == "logical")
+        alloc_impl<bool>(a, mem_type);
+    else
+        return false;
+    return true;
+}
+
+bool hdf5oct::data_exchange::setOutputType(const std::string &out_spec)
+{
+    static const set<string> numeric_specs{"double", "single",
+                                           "uint64", "int64", "uint32", "int32",
+                                           "uint16", "int16", "uint8", "int8"};
+    if (out_spec.empty() || out_spec == "native" || out_spec == dtype_spec)
+        return true;
+
+    // dtype_spec selects the memory type of read(),
+    // HDF5 converts between numeric types while reading.
+    // Complex data stay complex, only the precision changes
+    bool ok = false;
+    if (numeric_specs.count(dtype_spec))
+        ok = numeric_specs.count(out_spec);
+    else if (dtype_spec == "double complex" || dtype_spec == "single complex")
+        ok = out_spec == "double" || out_spec == "single";
+    if (!ok)
+    {
+        lastError = "cannot convert '" + dtype_spec + "' to '" + out_spec + "'";
+        return false;
+    }
+    if (dtype_spec.find("complex") != string::npos)
+        dtype_spec = out_spec + " complex";
+    else
+        dtype_spec = out_spec;
+    return true;
+}
+
+bool hdf5oct::data_exchange::setConversionBuffer(size_t nbytes)
+{
+    if (nbytes == 0)
+        return true;
+    H5::RawPropertyList<H5::PropertyType::DATASET_XFER> plist;
+    try
+    {
+        plist.add(H5Pset_buffer, nbytes, nullptr, nullptr);
+    }
+    catch (const H5::PropertyException &)
+    {
+        lastError = "invalid conversion buffer size";
+        return false;
+    }
+    xfer_props = plist;
+    return true;
+}
+
+void hdf5oct::data_exchange::transpose(int ndim)
+{
+    dim_vector hdv = ov.dims();
+    if (hdv.ndims() < ndim)
+        hdv.resize(ndim, 1);
+    transposed = true;
+    dv = reversed(hdv);
+    if (dv.numel() > 1)
+    {
+        int n = hdv.ndims();
+        vector<size_t> dims(n);
+        for (int i = 0; i < n; i++)
+            dims[i] = hdv(i);
+        dspace = H5::DataSpace(dims);
+        dspace_info.assign(dspace);
+    }
+}
+
+dim_vector hdf5oct::data_exchange::reversed(const dim_vector &dv)
+{
+    int n = dv.ndims();
+    dim_vector r = dv;
+    for (int i = 0; i < n; i++)
+        r(i) = dv(n - 1 - i);
+    return r;
+}
+
+void hdf5oct::data_exchange::reverse(const void *src, void *dst, const dim_vector &dims,
+                                     size_t elem_size) const
+{
+    int n = dims.ndims();
+    vector<hsize_t> d(n);
+    for (int i = 0; i < n; i++)
+        d[i] = dims(i);
+    reverseDims(src, dst, n, d.data(), elem_size, nthreads);
+}
+
+H5::DataSpace hdf5oct::data_exchange::from_dim_vector(const dim_vector &dv)
+{
+    int ndim = dv.ndims();
+    if (ndim == 2 && dv(0) == 1 && dv(1) == 1)
+        return H5::DataSpace::Scalar();
+    if (ndim == 2 && dv(0) == 1)
+    { // [1xN] octave <-> 1D dataspace
+        vector<size_t> dims(1);
+        dims[0] = dv(1);
+        return H5::DataSpace(dims);
     }
+    vector<size_t> dims(ndim);
+    for (int i = 0; i < ndim; i++)
+        dims[ndim - 1 - i] = dv(i);
+    return H5::DataSpace(dims);
 }
-octave_scalar_map hdf5oct::dtype_info_t::oct_map() const
+
+bool hdf5oct::data_exchange::write_as_attribute(H5::Attribute &attr)
 {
-    map<string, octave_value> M;
-    M["Class"] = h5class;
-    M["OctaveClass"] = octave_class;
-    if (size)
-        M["Size"] = size == H5T_VARIABLE ? octave_value("H5T_VARIABLE") : octave_value(size);
-    if (!signed_status.empty())
-        M["Sign"] = signed_status;
-    if (!cset.empty())
-        M["charSet"] = cset;
-    if (!pading.empty())
-        M["Pading"] = pading;
-    return octave_scalar_map(M);
+    if (dtype_spec == "double")
+        write_attr_impl<double>(attr);
+    else if (dtype_spec == "single")
+        write_attr_impl<float>(attr);
+    else if (dtype_spec == "double complex")
+        write_attr_impl<std::complex<double>>(attr);
+    else if (dtype_spec == "single complex")
+        write_attr_impl<std::complex<float>>(attr);
+    else if (dtype_spec == "uint64")
+        write_attr_impl<uint64_t>(attr);
+    else if (dtype_spec == "int64")
+        write_attr_impl<int64_t>(attr);
+    else if (dtype_spec == "uint32")
+        write_attr_impl<uint32_t>(attr);
+    else if (dtype_spec == "int32")
+        write_attr_impl<int32_t>(attr);
+    else if (dtype_spec == "uint16")
+        write_attr_impl<uint16_t>(attr);
+    else if (dtype_spec == "int16")
+        write_attr_impl<int16_t>(attr);
+    else if (dtype_spec == "uint8")
+        write_attr_impl<uint8_t>(attr);
+    else if (dtype_spec == "int8")
+        write_attr_impl<int8_t>(attr);
+    else if (dtype_spec == "logical")
+        write_attr_impl<bool>(attr);
+    else if (dtype_spec == "string")
+        write_string_attr(attr);
+    return true;
 }
-void hdf5oct::dset_info_t::assign(const H5::DataSet &ds, const string &path)
+
+void hdf5oct::data_exchange::write_string_attr(H5::Attribute &attr)
 {
-    name = path;
-    H5::DataType dt = ds.getDataType();
-    dtype_info.assign(dt);
-    dspace_info.assign(ds.getSpace());
-    // check creation properties
-    H5::DataSetCreateProps dscpl = ds.getCreatePropertyList();
-    if (dspace_info.isSimple() && H5Pget_layout(dscpl.getId()) == H5D_CHUNKED)
-    {
-        int ndim = dspace_info.size.numel();
-        vector<hsize_t> hdims(ndim);
-        if (H5Pget_chunk(dscpl.getId(), ndim, hdims.data()) == ndim)
-        {
-            chunksize = uint64NDArray(dim_vector(1, ndim));
-            for (int i = 0; i < ndim; i++)
-                chunksize(i) = hdims[ndim - 1 - i];
-        }
-    }
-    attributes = readAttributes(ds);
+    Array<string> A = ov.cellstr_value();
+    octave_idx_type n = A.numel();
+    vector<const char *> p(n);
+    for (octave_idx_type i = 0; i < n; i++)
+        p[i] = A(i).data();
+    attr.write_raw(p.data(), dtype);
 }
-octave_scalar_map hdf5oct::dset_info_t::oct_map() const
+
+bool hdf5oct::locationExists(const H5::File &f, const std::string &loc)
 {
-    // all map fields mandatory !!
-    map<string, octave_value> M;
-    M["Name"] = name;
-    M["Datatype"] = dtype_info.oct_map();
-    M["Dataspace"] = dspace_info.oct_map();
-    M["ChunkSize"] = chunksize;
-    M["Attributes"] = attributes;
-    return octave_scalar_map(M);
+    map<string, bool> known;
+    return locationExists(f, loc, known);
 }
-void hdf5oct::group_info_t::assign(const H5::Group &g, const string &path)
+
+bool hdf5oct::locationExists(const H5::File &f, const std::string &loc,
+                             std::map<std::string, bool> &known)
 {
-    name = path;
-    size_t n = g.getNumberObjects();
-    vector<string> group_names, ds_names, dt_names, link_names;
-    for (hsize_t i = 0; i < n; i++)
+    auto exists = [&](const string &iloc)
     {
-        string obj_name = g.getObjectName(i);
-        H5::ObjectType type = g.getObjectType(obj_name);
-
-        switch (type)
-        {
-        case H5::ObjectType::Group:
-        {
-            group_info_t info;
-            info.assign(g.getGroup(obj_name),
-                        h5_concat_path(path, obj_name));
-            groups.push_back(info);
-        }
-        break;
-        case H5::ObjectType::Dataset:
-        {
-            dset_info_t info;
-            info.assign(g.getDataSet(obj_name),
-                        h5_concat_path(path, obj_name));
-            datasets.push_back(info);
-        }
-        break;
-        case H5::ObjectType::UserDataType:
-        {
-            named_dtype_info_t info;
-            info.assign(g.getDataType(obj_name),
-                        h5_concat_path(path, obj_name));
-            datatypes.push_back(info);
-        }
-        break;
-        case H5::ObjectType::Other:
-        default:
-            break;
+        auto it = known.find(iloc);
+        if (it == known.end())
+            it = known.emplace(iloc, f.exist(iloc)).first;
+        return it->second;
+    };
+    // check for intermediate groups
+    string::size_type pos = loc.find_first_of('/'), last_pos = 0;
+    while (pos != string::npos)
+    {
+        if (pos != 0)
+        { // skip checking if root exists
+            string iloc = loc.substr(0, pos);
+            if (!exists(iloc))
+                return false;
         }
+        last_pos = pos + 1;
+        pos = loc.find_first_of('/', last_pos);
     }
-    attributes = readAttributes(g);
+    if (last_pos < loc.size())
+        return exists(loc);
+    return true;
 }
-octave_scalar_map hdf5oct::group_info_t::oct_map() const
+
+bool hdf5oct::canCreate(const H5::File &f, const std::string &loc)
 {
-    // all map fields mandatory !!
-    map<string, octave_value> M;
-    M["Name"] = name;
+    // check for intermediate groups
+    string::size_type pos = loc.find_first_of('/'), last_pos = 0;
+    while (pos != string::npos)
+    {
+        if (pos != 0)
+        { // skip checking is root exists
+            string iloc = loc.substr(0, pos);
+            if (!f.exist(iloc))
+                return true; // ok, will be created
+            if (f.getObjectType(iloc) != H5::ObjectType::Group)
+                return false; // error, intermediate node is not a group
+        }
+        last_pos = pos + 1;
+        pos = loc.find_first_of('/', last_pos);
+    }
+    return true;
+}
 
-    octave_map omap;
+bool hdf5oct::validLocation(const std::string &loc)
+{
+    if (loc.find_first_of('/') != 0)
+    {
+        lastError = "dataset location should be specified "
+                    "as a full pathname with leading '/'";
+        return false;
+    }
+    return true;
+}
 
-    vector<string> keys{"Name", "Groups", "Datasets",
-                        "Datatypes", "Attributes"};
-    omap = octave_map(dim_vector(groups.size(), 1), keys);
-    for (int i = 0; i < groups.size(); i++)
-        omap.fast_elem_insert(i, groups[i].oct_map());
-    M["Groups"] = omap;
+bool hdf5oct::isMemoryFile(const std::string &filename)
+{
+    return filename.compare(0, 6, "mem://") == 0;
+}
 
-    keys = {"Name", "Datatype", "Dataspace", "ChunkSize", "Attributes"};
-    omap = octave_map(dim_vector(datasets.size(), 1), keys);
-    for (int i = 0; i < datasets.size(); i++)
-        omap.fast_elem_insert(i, datasets[i].oct_map());
-    M["Datasets"] = omap;
+hdf5oct::file_cache &hdf5oct::file_cache::instance()
+{
+    static file_cache cache;
+    // HDF5 is not thread-safe: let the asynchronous writes finish first
+    async_queue::waitIdle();
+    return cache;
+}
 
-    keys = {"Name"};
-    omap = octave_map(dim_vector(datatypes.size(), 1), keys);
-    for (int i = 0; i < datatypes.size(); i++)
-        omap.fast_elem_insert(i, datatypes[i].oct_map());
-    M["Datatypes"] = omap;
+hdf5oct::file_cache::file_cache()
+{
+    // Initialize the HDF5 library before the cache is constructed.
+    // Thus, at exit, the cache is destroyed (and the files closed)
+    // before the library is shut down
+    H5open();
+}
 
-    M["Attributes"] = attributes;
+hdf5oct::file_cache::~file_cache()
+{
+    try
+    {
+        close_all(); // trims the datasets of h5append
+    }
+    catch (const H5::Exception &)
+    {
+    }
+}
 
-    return octave_scalar_map(M);
+static string canonical_path(const string &filename)
+{
+    if (h5o::isMemoryFile(filename))
+        return filename;
+    string path = octave::sys::canonicalize_file_name(filename);
+    return path.empty() ? filename : path;
 }
 
-// compatible means:
-// - same datatype spec
-// - same extent type (Scalar/Simple)
-// - same dimensionality
-// - same # of elements in each dim
-bool hdf5oct::data_exchange::isCompatible(const data_exchange &dx)
+// HighFive cannot open a file for SWMR reading. It is opened with
+// H5Fopen and handed to a File through its protected constructor
+struct swmr_file_t : H5::File
 {
-    if (dtype_spec != dx.dtype_spec)
+    swmr_file_t(const string &filename, const H5::FileAccessProps &fapl)
+        : H5::File(H5Fopen(filename.c_str(), H5F_ACC_RDONLY | H5F_ACC_SWMR_READ, fapl.getId()))
     {
-        lastError = "different datatype specs";
-        return false;
+        if (getId() < 0)
+            throw H5::FileException("Unable to open file " + filename + " for SWMR reading");
     }
-    if (dtype.getSize() != dx.dtype.getSize())
+};
+
+// A memory file opened from a copy of a file image
+struct image_file_t : H5::File
+{
+    image_file_t(const string &name, const void *image, size_t size)
+        : H5::File(open_image(name, image, size))
     {
-        lastError = "different datatype size";
-        return false;
+        if (getId() < 0)
+            throw H5::FileException("Unable to open the file image as " + name);
     }
 
-    if (dspace_info.extent_type != dx.dspace_info.extent_type)
+private:
+    static hid_t open_image(const string &name, const void *image, size_t size)
     {
-        lastError = "different dataspaces extent type";
-        return false;
+        H5::FileAccessProps fapl;
+        fapl.add(core_driver_property_t{core_increment, false});
+        if (H5Pset_file_image(fapl.getId(), const_cast<void *>(image), size) < 0)
+            return H5I_INVALID_HID;
+        return H5Fopen(name.c_str(), H5F_ACC_RDWR, fapl.getId());
     }
+};
 
-    if (dspace_info.isSimple())
+// A new file in memory only, with the core driver without backing store
+static H5::File create_memory_file(const string &name, const H5::FileCreateProps &fcpl,
+                                   H5::FileAccessProps fapl)
+{
+    fapl.add(core_driver_property_t{core_increment, false});
+    return H5::File(name, H5::File::Truncate, fcpl, fapl);
+}
+
+static H5::File open_read_only(const string &filename, const h5o::file_access_t &a,
+                               bool page_buffer)
+{
+    if (a.swmr)
+        return swmr_file_t(filename, a.fapl(page_buffer));
+    return H5::File(filename, H5::File::ReadOnly, a.fapl(page_buffer));
+}
+
+// Open a file read-only with the given access properties
+static H5::File open_read_only(const string &filename, const h5o::file_access_t &a)
+{
+    if (a.page_buffer_size > 0)
     {
-        int ndim = dspace.getNumberDimensions();
-        if (ndim != dx.dspace.getNumberDimensions())
-        {
-            lastError = "different dataspace dimensionality";
-            return false;
-        }
-        if (ndim == 1 && (dv(1) != dx.dv(1)))
+        // the page buffer can only be used with files created with paged
+        // aggregation, and a page size not larger than the buffer
+        try
         {
-            lastError = "different number of elements";
-            return false;
+            H5::SilenceHDF5 silence;
+            return open_read_only(filename, a, true);
         }
-        if (ndim > 1)
+        catch (const H5::FileException &)
         {
-            for (int i = 0; i < ndim; i++)
-            {
-                if (dv(i) != dx.dv(i))
-                {
-                    lastError = "different number of elements";
-                    return false;
-                }
-            }
         }
     }
-    return true;
+    return open_read_only(filename, a, false);
 }
 
-void hdf5oct::data_exchange::reset()
+H5::File hdf5oct::file_cache::open(const std::string &filename, unsigned mode, bool pin,
+                                   const H5::FileCreateProps &fcpl, const H5::FileAccessProps &fapl)
 {
-    lastError = "";
-    ov = octave_value();
-    dset = nullptr;
-    attr = nullptr;
-    dtype = H5::DataType();
-    dtype_info = dtype_info_t();
-    dspace = H5::DataSpace::Null();
-    dspace_info = dspace_info_t();
-    dtype_spec = "";
+    bool create = mode & H5::File::Create;
+    bool writable = create || (mode & H5::File::ReadWrite);
+    // memory files exist only in the cache
+    bool memory = isMemoryFile(filename);
+
+    auto it = find(canonical_path(filename));
+    // a file opened read-only is re-opened if its access properties changed
+    file_access_t a = access(filename);
+    if (it != entries.end())
+    {
+        if (memory ||
+            (!create && !isStale(*it) && (it->writable || (!writable && it->access == a))))
+        {
+            // cache hit, move to front
+            it->pinned = it->pinned || pin;
+            entries.splice(entries.begin(), entries, it);
+            return it->file;
+        }
+        // the file has to be re-opened
+        pin = pin || it->pinned;
+        erase(it);
+    }
+
+    if (memory && !create)
+        throw H5::FileException("Unable to open file " + filename +
+                                " (memory file does not exist)");
+    pin = pin || memory;
+    writable = writable || memory;
+
+    H5::File file = memory     ? create_memory_file(filename, fcpl, fapl)
+                    : writable ? H5::File(filename, create ? unsigned(H5::File::OpenOrCreate)
+                                                           : H5::File::ReadWrite,
+                                          fcpl, fapl)
+                               : open_read_only(filename, a);
+
+    // get the path again, the file may have just been created
+    string path = canonical_path(filename);
+    if (create)
+    {
+        H5F_libver_t low, high;
+        if (fapl.getId() != H5P_DEFAULT &&
+            H5Pget_libver_bounds(fapl.getId(), &low, &high) >= 0 && low == H5F_LIBVER_LATEST)
+            latest_format.insert(path);
+        else
+            latest_format.erase(path);
+    }
+    else if (writable && latest_format.count(path) &&
+             H5Fset_libver_bounds(file.getId(), H5F_LIBVER_LATEST, H5F_LIBVER_LATEST) < 0)
+        H5::HDF5ErrMapper::ToException<H5::FileException>(
+            "Unable to set the latest format for file " + filename);
+    if (!pin && max_files == 0)
+        return file; // caching disabled
+
+    it = find(path);
+    if (it != entries.end())
+        erase(it);
+    octave::sys::file_stat fs(path);
+    entries.push_front(entry{path, file, writable, pin, a,
+                             fs.dev(), fs.ino(), fs.size(), fs.mtime().double_value(),
+                             {}, nullptr, {}});
+    evict();
+    return file;
 }
 
-bool hdf5oct::data_exchange::assign(H5::DataSet *ds)
+H5::File hdf5oct::file_cache::openImage(const std::string &name, const void *image, size_t size)
 {
-    reset();
-    dset = ds;
-    return assign(ds->getDataType(), ds->getSpace());
+    close(name);
+    H5::File file = image_file_t(name, image, size);
+    entries.push_front(entry{name, file, true, true, file_access_t(), 0, 0, 0, 0.,
+                             {}, nullptr, {}});
+    return file;
 }
 
-bool hdf5oct::data_exchange::assign(const H5::Attribute *aattr)
+// set once the queue exists, so that waitIdle() does not create it
+static std::atomic<bool> async_queue_started{false};
+// true in the I/O thread of the queue
+static thread_local bool in_io_thread = false;
+
+hdf5oct::async_queue &hdf5oct::async_queue::instance()
 {
-    reset();
-    attr = aattr;
-    return assign(attr->getDataType(), attr->getSpace());
+    static async_queue queue;
+    return queue;
 }
 
-bool hdf5oct::data_exchange::assign(const H5::DataType &t, const H5::DataSpace &s)
+hdf5oct::async_queue::async_queue()
 {
-    dtype = t;
-    dspace = s;
+    // Create the file cache first, so that at exit the queue is
+    // drained before the files are closed
+    file_cache::instance();
+    async_queue_started = true;
+}
 
-    // check datatype
-    dtype_info.assign(dtype);
-    if (dtype_info.h5class.empty())
+hdf5oct::async_queue::~async_queue()
+{
     {
-        lastError = "Invalid HDF5 datatype";
-        return false;
+        std::lock_guard<std::mutex> lk(m);
+        stop = true;
     }
-    if (dtype_info.octave_class.empty())
+    cv.notify_all();
+    if (worker.joinable())
+        worker.join();
+}
+
+void hdf5oct::async_queue::run()
+{
+    in_io_thread = true;
+    std::unique_lock<std::mutex> lk(m);
+    while (true)
     {
-        lastError = "Unsupported datatype '";
-        lastError += dtype_info.h5class;
-        lastError += "'";
-        return false;
+        cv.wait(lk, [this]
+                { return stop || next < jobs.size(); });
+        if (next == jobs.size())
+            return; // stopped, with all jobs done
+        // the job stays in the queue until it is done
+        job_t *j = jobs[next].get();
+        lk.unlock();
+        try
+        {
+            j->run();
+        }
+        catch (const std::exception &e)
+        {
+            j->err = e.what();
+        }
+        catch (...)
+        {
+            j->err = "unknown error";
+        }
+        lk.lock();
+        queued_bytes -= j->nbytes;
+        next++;
+        cv.notify_all();
     }
-    dtype_spec = dtype_info.octave_class;
+}
 
-    // check dataspace
-    dspace_info.assign(dspace);
-    if (dspace_info.extent_type.empty() ||
-        dspace_info.isNull())
+template <class Pred>
+void hdf5oct::async_queue::waitFor(std::unique_lock<std::mutex> &lk, Pred pred)
+{
+    while (!pred())
     {
-        lastError = "Empty HDF5 dataspace";
-        return false;
+        cv.wait_for(lk, std::chrono::milliseconds(100));
+        if (!pred())
+        {
+            lk.unlock();
+            octave_quit();
+            lk.lock();
+        }
     }
-    if (dspace_info.isScalar())
-        dv = dim_vector(1, 1);
-    if (dspace_info.isSimple())
+}
+
+template <class Pred>
+std::vector<std::string> hdf5oct::async_queue::collect(Pred pred)
+{
+    std::vector<std::string> errors;
+    for (size_t i = 0; i < next;)
     {
-        size_t n = dspace_info.size.numel();
-        if (n == 1)
-            dv = dim_vector(1, dspace_info.size(0)); // 1D dataset -> [1xN] octave array
-        else
+        if (pred(*jobs[i]))
         {
-            dv.resize(n);
-            for (size_t i = 0; i < n; i++)
-                dv(i) = dspace_info.size(i);
+            if (!jobs[i]->err.empty())
+                errors.push_back(jobs[i]->err);
+            jobs.erase(jobs.begin() + i);
+            next--;
         }
+        else
+            i++;
     }
+    return errors;
+}
 
-    return true;
+uint64_t hdf5oct::async_queue::submit(const std::string &filename, const octave_value &data,
+                                      std::function<void()> job)
+{
+    auto j = std::make_shared<job_t>();
+    j->path = canonical_path(filename);
+    j->data = data;
+    j->nbytes = data.byte_size();
+    j->run = std::move(job);
+    return submit(j);
 }
 
-bool hdf5oct::data_exchange::selectHyperslab(uint64NDArray start,
-                                             uint64NDArray count, uint64NDArray stride, bool tryExtend)
+uint64_t hdf5oct::async_queue::submit(const std::string &filename, size_t nbytes,
+                                      std::function<void()> job)
+{
+    auto j = std::make_shared<job_t>();
+    j->path = canonical_path(filename);
+    j->nbytes = nbytes;
+    j->run = std::move(job);
+    return submit(j);
+}
+
+uint64_t hdf5oct::async_queue::submit(std::shared_ptr<job_t> j)
+{
+    std::unique_lock<std::mutex> lk(m);
+    // release the data of finished jobs, keeping the failed ones
+    collect([](const job_t &d)
+            { return d.err.empty(); });
+    // wait for room in the queue, a large job waits for an empty queue
+    waitFor(lk, [&]
+            { return queued_bytes == 0 || queued_bytes + j->nbytes <= max_bytes; });
+    if (!worker.joinable())
+        worker = std::thread(&async_queue::run, this);
+    j->id = next_id++;
+    queued_bytes += j->nbytes;
+    jobs.push_back(j);
+    cv.notify_all();
+    return j->id;
+}
+
+std::vector<std::string> hdf5oct::async_queue::wait(uint64_t id)
+{
+    std::unique_lock<std::mutex> lk(m);
+    waitFor(lk, [&]
+            { return next == jobs.size() || (id && jobs[next]->id > id); });
+    return collect([id](const job_t &d)
+                   { return !id || d.id == id || d.err.empty(); });
+}
+
+std::vector<std::string> hdf5oct::async_queue::waitFile(const std::string &filename)
+{
+    string path = canonical_path(filename);
+    std::unique_lock<std::mutex> lk(m);
+    waitFor(lk, [&]
+            { return std::none_of(jobs.begin() + next, jobs.end(),
+                                  [&](const std::shared_ptr<job_t> &d)
+                                  { return d->path == path; }); });
+    return collect([&](const job_t &d)
+                   { return d.path == path || d.err.empty(); });
+}
+
+void hdf5oct::async_queue::waitIdle()
+{
+    if (!async_queue_started || in_io_thread)
+        return;
+    async_queue &q = instance();
+    std::unique_lock<std::mutex> lk(q.m);
+    q.waitFor(lk, [&]
+              { return q.next == q.jobs.size(); });
+}
+
+void hdf5oct::async_queue::set_capacity(size_t nbytes)
 {
-    if (dspace_info.isNull())
-    {
-        lastError = "Hyperslab selection not possible. Dataset is NULL";
-        return false;
-    }
-    if (dspace_info.isScalar())
     {
-        lastError = "Hyperslab selection not possible for scalar datasets";
-        return false;
+        std::lock_guard<std::mutex> lk(m);
+        max_bytes = nbytes;
     }
+    cv.notify_all();
+}
 
-    int ndim = dspace_info.size.numel();
-    vector<size_t> hstart(ndim), hcount(ndim),
-        hstride(ndim),
-        fdims = dspace.getDimensions();
+void hdf5oct::file_cache::sync(const H5::File &f)
+{
+    H5F_scope_t scope;
+    if (syncScope(f, scope))
+        H5::detail::h5f_flush(f.getId(), scope);
+}
 
-    bool need_extend = false;
-    for (int i = 0; i < ndim; i++)
+bool hdf5oct::file_cache::syncScope(const H5::File &f, H5F_scope_t &scope)
+{
+    for (auto &e : entries)
     {
-        int j = ndim - 1 - i;
-        hstart[j] = size_t(start(i)) - 1;
-        hcount[j] = count(i);
-        hstride[j] = (stride.isempty()) ? 1 : size_t(stride(i));
-        size_t end = hstart[j] + 1 + (hcount[j] - 1) * hstride[j];
-        if (end > fdims[j])
+        if (e.file.getId() == f.getId())
         {
-            if (tryExtend)
-            {
-                if (end < size_t(dspace_info.maxsize(i)))
-                {
-                    fdims[j] = end;
-                    need_extend = true;
-                }
-                else
-                {
-                    lastError = "Hyperslab selection superseeds size of non-extensible dataset";
-                    return false;
-                }
-            }
-            else
+            if (!e.pinned)
             {
-                lastError = "hyperslab selection beyond the dataset's size";
-                return false;
+                trim(e);
+                scope = H5F_SCOPE_GLOBAL;
+                return true;
             }
+            scope = H5F_SCOPE_LOCAL; // publish to the SWMR readers
+            return isSWMRWriter(e.file);
         }
     }
-    if (need_extend)
-        dset->resize(fdims);
-    dspace = dset->getSpace();
-    H5::HyperSlab slab(H5::RegularHyperSlab(hstart, hcount, hstride));
-    dspace = slab.apply(dspace);
-    // adjust dim_vector
-    if (ndim == 1)
-        dv(1) = count(0); // special case of 1D h5 -> [1xN] octave
-    else
-        for (int i = 0; i < ndim; i++)
-            dv(i) = count(i);
+    // not cached: the file is closed when the last reference is dropped
+    return false;
+}
+
+bool hdf5oct::file_cache::close(const std::string &filename)
+{
+    string path = canonical_path(filename);
+    file_access.erase(path);
+    auto it = find(path);
+    if (it == entries.end())
+        return false;
+    erase(it);
     return true;
 }
 
-bool hdf5oct::data_exchange::assign(octave_value v)
+void hdf5oct::file_cache::close_all()
 {
+    file_access.clear();
+    while (!entries.empty())
+        erase(entries.begin());
+}
 
-    reset();
+bool hdf5oct::file_cache::flush(const std::string &filename)
+{
+    auto it = find(canonical_path(filename));
+    if (it == entries.end())
+        return false;
+    if (it->writable)
+        flush(*it);
+    return true;
+}
 
-    // find class
-    if (v.islogical())
-    {
-        dtype_spec = "logical";
-    }
-    else if (v.isinteger())
-    {
-        if (v.is_uint64_type())
-            dtype_spec = "uint64";
-        else if (v.is_int64_type())
-            dtype_spec = "int64";
-        else if (v.is_uint32_type())
-            dtype_spec = "uint32";
-        else if (v.is_int32_type())
-            dtype_spec = "int32";
-        else if (v.is_uint16_type())
-            dtype_spec = "uint16";
-        else if (v.is_int16_type())
-            dtype_spec = "int16";
-        else if (v.is_uint8_type())
-            dtype_spec = "uint8";
-        else if (v.is_int8_type())
-            dtype_spec = "int8";
-    }
-    else if (v.isreal())
+void hdf5oct::file_cache::flush_all()
+{
+    for (auto &e : entries)
+        if (e.writable)
+            flush(e);
+}
+
+bool hdf5oct::file_cache::trackAppend(const H5::File &f, const std::string &loc)
+{
+    for (auto &e : entries)
     {
-        if (v.is_double_type())
-            dtype_spec = "double";
-        else if (v.is_single_type())
-            dtype_spec = "single";
+        if (e.file.getId() == f.getId())
+        {
+            e.appended.insert(loc);
+            return true;
+        }
     }
-    else if (v.iscomplex())
+    return false;
+}
+
+void hdf5oct::file_cache::trim(entry &e)
+{
+    for (const auto &loc : e.appended)
     {
-        if (v.is_double_type())
-            dtype_spec = "double complex";
-        else if (v.is_single_type())
-            dtype_spec = "single complex";
+        try
+        {
+            H5::DataSet ds = e.file.getDataSet(loc);
+            trimDataset(ds);
+        }
+        catch (const H5::Exception &)
+        {
+            // the dataset has been deleted or moved
+        }
     }
-    else if (v.iscellstr())
-        dtype_spec = "string";
+    e.appended.clear();
+}
 
-    if (dtype_spec.empty())
-    {
-        lastError = "Unsupported Octave data of class '";
-        lastError += v.class_name();
-        lastError += "'";
+void hdf5oct::file_cache::flush(entry &e)
+{
+    trim(e);
+    e.file.flush();
+}
+
+std::list<hdf5oct::file_cache::entry>::iterator
+hdf5oct::file_cache::erase(std::list<entry>::iterator it)
+{
+    if (it->writable)
+        trim(*it);
+    return entries.erase(it);
+}
+
+void hdf5oct::file_cache::set_capacity(size_t n)
+{
+    max_files = n;
+    evict();
+}
+
+std::vector<std::string> hdf5oct::file_cache::names() const
+{
+    vector<string> v;
+    for (const auto &e : entries)
+        v.push_back(e.path);
+    return v;
+}
+
+hdf5oct::file_access_t hdf5oct::file_cache::access(const std::string &filename) const
+{
+    auto it = file_access.find(canonical_path(filename));
+    return it != file_access.end() ? it->second : default_access;
+}
+
+void hdf5oct::file_cache::set_access(const std::string &filename, const file_access_t &a)
+{
+    file_access[canonical_path(filename)] = a;
+}
+
+std::list<hdf5oct::file_cache::entry>::iterator hdf5oct::file_cache::find(const std::string &path)
+{
+    auto it = entries.begin();
+    while (it != entries.end() && it->path != path)
+        ++it;
+    return it;
+}
+
+bool hdf5oct::file_cache::isStale(const entry &e) const
+{
+    if (isMemoryFile(e.path))
         return false;
-    }
-    // get h5 datatype
-    dtype = h5type_from_spec(dtype_spec);
+    octave::sys::file_stat fs(e.path);
+    if (!fs || fs.dev() != e.dev || fs.ino() != e.ino)
+        return true; // deleted or replaced
+    // a file opened read-only may have been modified by another process.
+    // Files opened for writing are modified by us, so they are not checked,
+    // nor are files opened for SWMR reading, whose datasets are refreshed.
+    return !e.writable && !e.access.swmr &&
+           (fs.size() != e.size || fs.mtime().double_value() != e.mtime);
+}
 
-    // prepare h5 memory dataspace & octave dimensions
-    dspace = H5::DataSpace::Scalar();
-    dv = v.dims();
-    int ndim = dv.ndims();
-    // find # of data elements
-    hsize_t nelem = 1;
-    for (int i = 0; i < ndim; i++)
-        nelem *= dv(i);
-    if (nelem > 1) // if not scalar (octave 1x1)
+H5::DataSet hdf5oct::file_cache::openDataSet(const H5::File &f, const std::string &loc,
+                                             const chunk_cache_t &cache)
+{
+    auto it = entries.begin();
+    while (it != entries.end() && it->file.getId() != f.getId())
+        ++it;
+    if (it != entries.end())
     {
-        vector<size_t> dims(ndim);
-        for (int i = 0; i < ndim; i++)
-            dims[ndim - 1 - i] = dv(i);
-        dspace = H5::DataSpace(dims);
+        auto d = it->datasets.find(loc);
+        if (d != it->datasets.end())
+        {
+            chunk_cache_t held;
+            held.assign(d->second.getAccessPropertyList());
+            if ((held.nbytes == cache.nbytes && held.nslots == cache.nslots && held.w0 == cache.w0) ||
+                (cache.mode == chunk_cache_t::Auto && held.nbytes >= cache.nbytes))
+                return d->second;
+            it->datasets.erase(d);
+        }
     }
-    dspace_info.assign(dspace);
+    H5::DataSet ds = f.getDataSet(loc, cache.dapl());
+    if (it != entries.end())
+        it->datasets.emplace(loc, ds);
+    return ds;
+}
 
-    ov = v;
+std::shared_ptr<const hdf5oct::file_mapping> hdf5oct::file_cache::mapFile(const H5::File &f)
+{
+    unsigned intent = 0;
+    if (H5Fget_intent(f.getId(), &intent) >= 0 && (intent & H5F_ACC_RDWR))
+        H5Fflush(f.getId(), H5F_SCOPE_LOCAL);
 
-    return true;
+    auto it = entries.begin();
+    while (it != entries.end() && it->file.getId() != f.getId())
+        ++it;
+    string path = it != entries.end() ? it->path : canonical_path(f.getName());
+    octave::sys::file_stat fs(path);
+    if (!fs)
+        return nullptr;
+    if (it != entries.end() && it->mapping && it->mapping->size() == size_t(fs.size()))
+        return it->mapping;
+
+    auto m = std::make_shared<const file_mapping>(path);
+    if (!m->isValid())
+        return nullptr;
+    if (it != entries.end())
+        it->mapping = m;
+    return m;
 }
 
-void hdf5oct::data_exchange::write(const data_exchange &dxfile)
-{
-    if (dtype_spec == "double")
-        write_impl<double>(dxfile);
-    else if (dtype_spec == "single")
-        write_impl<float>(dxfile);
-    else if (dtype_spec == "double complex")
-        write_impl<std::complex<double>>(dxfile);
-    else if (dtype_spec == "single complex")
-        write_impl<std::complex<float>>(dxfile);
-    else if (dtype_spec == "uint64")
-        write_impl<uint64_t>(dxfile);
-    else if (dtype_spec == "int64")
-        write_impl<int64_t>(dxfile);
-    else if (dtype_spec == "uint32")
-        write_impl<uint32_t>(dxfile);
-    else if (dtype_spec == "int32")
-        write_impl<int32_t>(dxfile);
-    else if (dtype_spec == "uint16")
-        write_impl<uint16_t>(dxfile);
-    else if (dtype_spec == "int16")
-        write_impl<int16_t>(dxfile);
-    else if (dtype_spec == "uint8")
-        write_impl<uint8_t>(dxfile);
-    else if (dtype_spec == "int8")
-        write_impl<int8_t>(dxfile);
-    else if (dtype_spec == "logical")
-        write_impl<bool>(dxfile);
-    else if (dtype_spec == "string")
-        write_string(dxfile);
+void hdf5oct::file_cache::evict()
+{
+    // keep the max_files most recently used unpinned entries
+    size_t n = 0;
+    auto it = entries.begin();
+    while (it != entries.end())
+    {
+        if (!it->pinned && ++n > max_files)
+            it = erase(it);
+        else
+            ++it;
+    }
 }
 
-void hdf5oct::data_exchange::write_string(const data_exchange &dxfile)
+// Open an existing dataset for h5writer or h5blocks
+static H5::DataSet open_existing_dataset(const H5::File &file, const string &location,
+                                         const char *caller)
 {
-    Array<string> A = ov.cellstr_value();
-    octave_idx_type n = A.numel();
-    vector<const char *> p(n);
-    for (octave_idx_type i = 0; i < n; i++)
-        p[i] = A(i).data();
-    // dxfile.dset.write(p.data(), dtype, dspace, dxfile.dspace);
-    // dxfile.dset.write_raw(p.data(), dtype);
-    h5write(*dxfile.dset, p.data(), dtype, dspace, dxfile.dspace);
+    if (!h5o::validLocation(location))
+        error("%s: %s", caller, h5o::lastError.c_str());
+    if (!h5o::locationExists(file, location))
+        error("%s: location %s does not exist", caller, location.c_str());
+    else if (file.getObjectType(location) != H5::ObjectType::Dataset)
+        error("%s: location '%s' is not a Dataset", caller, location.c_str());
+    return file.getDataSet(location);
 }
 
-octave_value hdf5oct::data_exchange::read_string()
+hdf5oct::dataset_writer::dataset_writer(const std::string &filename, const std::string &location)
+    : file(file_cache::instance().open(filename, H5::File::ReadWrite)),
+      dset(open_existing_dataset(file, location, "h5writer"))
 {
-    octave_idx_type n = 1;
-    for (octave_idx_type i = 0; i < dv.ndims(); i++)
-        n *= dv(i);
+    // a dataset extended by h5append is trimmed to its logical size
+    trimDataset(dset);
+    if (!dxfile.assign(&dset))
+        error("h5writer: dataset %s: %s", location.c_str(), lastError.c_str());
+    if (!dxfile.dspace_info.isSimple())
+        error("h5writer: dataset %s is not an array", location.c_str());
+    H5::DataSpace space = dset.getSpace();
+    extent = space.getDimensions();
+    maxdims = space.getMaxDimensions();
+}
 
-    if (dtype_info.size == H5T_VARIABLE)
+hdf5oct::dataset_writer::~dataset_writer()
+{
+    async_queue::waitIdle();
+    try
     {
-        vector<char *> p(n);
-        Array<string> A(dv);
-        H5::DataSpace memspace = from_dim_vector(dv);
-        h5read(*dset, p.data(), dtype, memspace, dspace);
-        for (octave_idx_type i = 0; i < n; i++)
-            A(i) = p[i] ? string(p[i]) : string();
-        herr_t ret = H5Dvlen_reclaim(dtype.getId(), memspace.getId(), H5P_DEFAULT, p.data());
-        if (ret < 0)
-        {
-            lastError = "Error in call to H5Dvlen_reclaim";
-            return octave_value();
-        }
-        return (n > 1) ? octave_value(A) : octave_value(A(0));
+        file.flush();
     }
-    else
+    catch (const H5::Exception &)
     {
-        octave_idx_type sz = dtype_info.size;
-        vector<char> buff(n * sz, '\0');
-        H5::DataSpace memspace = from_dim_vector(dv);
-        h5read(*dset, buff.data(), dtype, memspace, dspace);
-        Array<string> A(dv);
-        const char *p = buff.data();
-        for (octave_idx_type i = 0; i < n; i++)
-        {
-            A(i) = string(p, sz);
-            p += sz;
-        }
-        return n > 1 ? octave_value(A) : octave_value(A(0));
+        // nothing to do in a destructor
     }
 }
 
-octave_value hdf5oct::data_exchange::read_attribute()
+void hdf5oct::dataset_writer::prepare(const octave_value &block, const uint64NDArray &start)
 {
-    octave_value ret;
-    if (dtype_spec == "double")
-        ret = read_attr_impl<double>();
-    else if (dtype_spec == "single")
-        ret = read_attr_impl<float>();
-    else if (dtype_spec == "double complex")
-        ret = read_attr_impl<std::complex<double>>();
-    else if (dtype_spec == "single complex")
-        ret = read_attr_impl<std::complex<float>>();
-    else if (dtype_spec == "uint64")
-        ret = read_attr_impl<uint64_t>();
-    else if (dtype_spec == "int64")
-        ret = read_attr_impl<int64_t>();
-    else if (dtype_spec == "uint32")
-        ret = read_attr_impl<uint32_t>();
-    else if (dtype_spec == "int32")
-        ret = read_attr_impl<int32_t>();
-    else if (dtype_spec == "uint16")
-        ret = read_attr_impl<uint16_t>();
-    else if (dtype_spec == "int16")
-        ret = read_attr_impl<int16_t>();
-    else if (dtype_spec == "uint8")
-        ret = read_attr_impl<uint8_t>();
-    else if (dtype_spec == "int8")
-        ret = read_attr_impl<int8_t>();
-    else if (dtype_spec == "logical")
-        ret = read_attr_impl<bool>();
-    else if (dtype_spec == "string")
-        ret = read_string_attr();
-    return ret;
+    // the block must have the rank of the dataset, except for trailing
+    // singleton dimensions. A 1D dataset takes a vector
+    int rank = extent.size();
+    dim_vector bdv = block.dims();
+    uint64NDArray bcount(dim_vector(rank, 1));
+    if (rank == 1)
+    {
+        if (bdv.ndims() > 2 || (bdv(0) != 1 && bdv(1) != 1))
+            error("h5writer: data must be a vector for a 1D dataset");
+        bcount(0) = block.numel();
+    }
+    else
+    {
+        if (bdv.ndims() > rank)
+            error("h5writer: data has more dimensions than the dataset");
+        for (int i = 0; i < rank; i++)
+            bcount(i) = i < bdv.ndims() ? bdv(i) : 1;
+    }
+
+    if (!dxfile.selectHyperslab(start, bcount, uint64NDArray(), true))
+        error("h5writer: hyperslab selection: %s", lastError.c_str());
+    dxmem = data_exchange();
+    if (!dxmem.assign(block))
+        error("h5writer: octave data: %s", lastError.c_str());
+    if (dxmem.dtype_spec == "string" && dxfile.dtype_info.size != H5T_VARIABLE)
+        error("h5writer: export of string data is supported only to variable size HDF5 string datasets");
+    // the block may lack trailing singleton dimensions
+    dxmem.element_list = true;
+    if (!dxmem.isCompatible(dxfile))
+        error("h5writer: incompatible dataset and octave data: %s", lastError.c_str());
+
+    cls = block.class_name();
+    cplx = block.iscomplex();
+    count.assign(rank, 0);
+    offset.assign(rank, 0);
+    for (int i = 0; i < rank; i++)
+        count[rank - 1 - i] = bcount(i);
+    extent = dset.getSpace().getDimensions();
 }
 
-octave_value hdf5oct::data_exchange::read_string_attr()
+void hdf5oct::dataset_writer::write(const octave_value &block, const uint64NDArray &start)
 {
-    if (attr == nullptr)
+    async_queue::waitIdle();
+    int rank = extent.size();
+    // a 1D dataset is a [1xN] octave array, so [1 j] or j are accepted
+    octave_idx_type n = start.numel();
+    if (!(n == rank || (rank == 1 && n == 2)))
+        error("h5writer: start must have one element per dataset dimension");
+    uint64NDArray st(dim_vector(rank, 1));
+    for (int i = 0; i < rank; i++)
     {
-        lastError = "Read requested from null attribute";
-        return octave_value();
+        st(i) = start(n - rank + i);
+        if (st(i) < 1)
+            error("h5writer: start must contain positive indices");
     }
-    octave_idx_type n = 1;
-    for (octave_idx_type i = 0; i < dv.ndims(); i++)
-        n *= dv(i);
 
-    Array<string> A(dv);
-    if (dtype_info.size == H5T_VARIABLE)
+    // a block of a new class or size is checked and the memory dataspace rebuilt
+    if (count.empty() || block.dims() != dxmem.dv || block.class_name() != cls ||
+        block.iscomplex() != cplx)
     {
-        vector<char *> p(n);
-        H5::DataSpace memspace = from_dim_vector(dv);
-        attr->read(p.data(), dtype);
-        for (octave_idx_type i = 0; i < n; i++)
-            A(i) = p[i] ? string(p[i]) : string();
-        herr_t ret = H5Dvlen_reclaim(dtype.getId(), memspace.getId(), H5P_DEFAULT, p.data());
-        if (ret < 0)
-        {
-            lastError = "Error in call to H5Dvlen_reclaim";
-            throw H5::AttributeException("Failed to reclaim HDF5 internal memory");
-            return octave_value();
-        }
+        prepare(block, st);
     }
     else
     {
-        octave_idx_type sz = dtype_info.size;
-        vector<char> buff(n * sz, '\0');
-        attr->read(buff.data(), dtype);
-        const char *p = buff.data();
-        for (octave_idx_type i = 0; i < n; i++)
+        bool need_extend = false;
+        for (int i = 0; i < rank; i++)
+        {
+            int j = rank - 1 - i;
+            offset[j] = st(i) - 1;
+            size_t end = offset[j] + count[j];
+            if (end > extent[j])
+            {
+                if (end > maxdims[j])
+                    error("h5writer: hyperslab selection beyond the size of non-extensible dataset");
+                extent[j] = end;
+                need_extend = true;
+            }
+        }
+        if (need_extend)
         {
-            A(i) = string(p, sz);
-            p += sz;
+            dset.resize(extent);
+            dxfile.dspace = dset.getSpace();
         }
+        if (H5Sselect_hyperslab(dxfile.dspace.getId(), H5S_SELECT_SET, offset.data(),
+                                nullptr, count.data(), nullptr) < 0)
+            error("h5writer: hyperslab selection failed");
     }
-    return n > 1 ? octave_value(A) : octave_value(A(0));
+    dxmem.ov = block;
+    dxmem.write(dxfile);
 }
 
-octave_value hdf5oct::data_exchange::read()
+void hdf5oct::h5writer::print(std::ostream &os, bool pr_as_read_syntax)
 {
-    octave_value ret;
-    if (dtype_spec == "double")
-        ret = read_impl<double>();
-    else if (dtype_spec == "single")
-        ret = read_impl<float>();
-    else if (dtype_spec == "double complex")
-        ret = read_impl<std::complex<double>>();
-    else if (dtype_spec == "single complex")
-        ret = read_impl<std::complex<float>>();
-    else if (dtype_spec == "uint64")
-        ret = read_impl<uint64_t>();
-    else if (dtype_spec == "int64")
-        ret = read_impl<int64_t>();
-    else if (dtype_spec == "uint32")
-        ret = read_impl<uint32_t>();
-    else if (dtype_spec == "int32")
-        ret = read_impl<int32_t>();
-    else if (dtype_spec == "uint16")
-        ret = read_impl<uint16_t>();
-    else if (dtype_spec == "int16")
-        ret = read_impl<int16_t>();
-    else if (dtype_spec == "uint8")
-        ret = read_impl<uint8_t>();
-    else if (dtype_spec == "int8")
-        ret = read_impl<int8_t>();
-    else if (dtype_spec == "logical")
-        ret = read_impl<bool>();
-    else if (dtype_spec == "string")
-        ret = read_string();
-    return ret;
+    print_raw(os, pr_as_read_syntax);
+    newline(os);
 }
 
-H5::DataSpace hdf5oct::data_exchange::from_dim_vector(const dim_vector &dv)
+void hdf5oct::h5writer::print_raw(std::ostream &os, bool) const
 {
-    int ndim = dv.ndims();
-    if (ndim == 2 && dv(0) == 1 && dv(1) == 1)
-        return H5::DataSpace::Scalar();
-    if (ndim == 2 && dv(0) == 1)
-    { // [1xN] octave <-> 1D dataspace
-        vector<size_t> dims(1);
-        dims[0] = dv(1);
-        return H5::DataSpace(dims);
-    }
-    vector<size_t> dims(ndim);
-    for (int i = 0; i < ndim; i++)
-        dims[ndim - 1 - i] = dv(i);
-    return H5::DataSpace(dims);
+    indent(os);
+    os << "<h5writer " << name << (w ? "" : " (closed)") << ">";
 }
 
-bool hdf5oct::data_exchange::write_as_attribute(H5::Attribute &attr)
+octave_value hdf5oct::h5writer::subsref(const std::string &type,
+                                        const std::list<octave_value_list> &idx)
 {
-    if (dtype_spec == "double")
-        write_attr_impl<double>(attr);
-    else if (dtype_spec == "single")
-        write_attr_impl<float>(attr);
-    else if (dtype_spec == "double complex")
-        write_attr_impl<std::complex<double>>(attr);
-    else if (dtype_spec == "single complex")
-        write_attr_impl<std::complex<float>>(attr);
-    else if (dtype_spec == "uint64")
-        write_attr_impl<uint64_t>(attr);
-    else if (dtype_spec == "int64")
-        write_attr_impl<int64_t>(attr);
-    else if (dtype_spec == "uint32")
-        write_attr_impl<uint32_t>(attr);
-    else if (dtype_spec == "int32")
-        write_attr_impl<int32_t>(attr);
-    else if (dtype_spec == "uint16")
-        write_attr_impl<uint16_t>(attr);
-    else if (dtype_spec == "int16")
-        write_attr_impl<int16_t>(attr);
-    else if (dtype_spec == "uint8")
-        write_attr_impl<uint8_t>(attr);
-    else if (dtype_spec == "int8")
-        write_attr_impl<int8_t>(attr);
-    else if (dtype_spec == "logical")
-        write_attr_impl<bool>(attr);
-    else if (dtype_spec == "string")
-        write_string_attr(attr);
-    return true;
+    octave_value_list retval = subsref(type, idx, 1);
+    return retval.length() > 0 ? retval(0) : octave_value();
 }
 
-void hdf5oct::data_exchange::write_string_attr(H5::Attribute &attr)
+octave_value_list hdf5oct::h5writer::subsref(const std::string &type,
+                                             const std::list<octave_value_list> &idx, int)
 {
-    Array<string> A = ov.cellstr_value();
-    octave_idx_type n = A.numel();
-    vector<const char *> p(n);
-    for (octave_idx_type i = 0; i < n; i++)
-        p[i] = A(i).data();
-    attr.write_raw(p.data(), dtype);
-}
+    // w.method or w.method(args)
+    if (type.empty() || type[0] != '.' || type.size() > 2 ||
+        (type.size() == 2 && type[1] != '('))
+        error("h5writer: invalid use of a h5writer object, call w.write(data, start) or w.close()");
+    string method = idx.front()(0).string_value();
+    octave_value_list args = type.size() == 2 ? idx.back() : octave_value_list();
 
-bool hdf5oct::locationExists(const H5::File &f, const std::string &loc)
-{
-    // check for intermediate groups
-    string::size_type pos = loc.find_first_of('/'), last_pos = 0;
-    while (pos != string::npos)
+    if (method == "write")
     {
-        if (pos != 0)
-        { // skip checking if root exists
-            string iloc = loc.substr(0, pos);
-            if (!f.exist(iloc))
-                return false;
+        if (args.length() != 2)
+            error("h5writer: usage: w.write(data, start)");
+        if (!w)
+            error("h5writer: %s is closed", name.c_str());
+        if (args(0).is_string())
+            error("h5writer: string data must be passed as a cell array");
+        try
+        {
+            w->write(args(0), args(1).uint64_array_value());
+        }
+        catch (const H5::Exception &e)
+        {
+            error("%s", e.what());
         }
-        last_pos = pos + 1;
-        pos = loc.find_first_of('/', last_pos);
     }
-    if (last_pos < loc.size())
-        return f.exist(loc);
-    return true;
+    else if (method == "close")
+    {
+        if (args.length() != 0)
+            error("h5writer: usage: w.close()");
+        w.reset();
+    }
+    else
+        error("h5writer: unknown method '%s'", method.c_str());
+    return octave_value_list();
 }
 
-bool hdf5oct::canCreate(const H5::File &f, const std::string &loc)
+DEFINE_OV_TYPEID_FUNCTIONS_AND_DATA(hdf5oct::h5writer, "h5writer", "h5writer");
+
+hdf5oct::block_reader::block_reader(const std::string &filename, const std::string &location,
+                                    int dim, size_t blocksize)
+    : fname(filename),
+      file(file_cache::instance().open(filename, H5::File::ReadOnly)),
+      dset(open_existing_dataset(file, location, "h5blocks"))
 {
-    // check for intermediate groups
-    string::size_type pos = loc.find_first_of('/'), last_pos = 0;
-    while (pos != string::npos)
+    dset_info_t info;
+    info_opts_t opts;
+    opts.attributes = info_opts_t::NoAttributes;
+    info.assign(dset, location, opts);
+    if (!info.dspace_info.isSimple())
+        error("h5blocks: dataset %s is not an array", location.c_str());
+    if (!dx.assign(&dset))
+        error("h5blocks: dataset %s: %s", location.c_str(), lastError.c_str());
+
+    size = info.dspace_info.size;
+    int rank = size.numel();
+    if (rank > 1 && dim > rank)
+        error("h5blocks: dataset %s has %d dimensions", location.c_str(), rank);
+    d = (rank == 1 || dim == 0) ? rank - 1 : dim - 1;
+    len = size(d);
+
+    // whole chunks along d. For contiguous datasets the default is ~1 MiB
+    if (!info.chunksize.isempty())
     {
-        if (pos != 0)
-        { // skip checking is root exists
-            string iloc = loc.substr(0, pos);
-            if (!f.exist(iloc))
-                return true; // ok, will be created
-            if (f.getObjectType(iloc) != H5::ObjectType::Group)
-                return false; // error, intermediate node is not a group
-        }
-        last_pos = pos + 1;
-        pos = loc.find_first_of('/', last_pos);
+        size_t c = info.chunksize(d);
+        bsize = blocksize == 0 ? c : (blocksize + c - 1) / c * c;
     }
-    return true;
+    else if (blocksize == 0)
+    {
+        size_t slice = dset.getDataType().getSize();
+        for (int i = 0; i < rank; i++)
+            if (i != d)
+                slice *= size_t(size(i));
+        bsize = std::max(size_t(1), (size_t(1) << 20) / std::max(slice, size_t(1)));
+    }
+    else
+        bsize = blocksize;
+
+    if (hasNext())
+        prefetch();
 }
 
-bool hdf5oct::validLocation(const std::string &loc)
+hdf5oct::block_reader::~block_reader()
 {
-    if (loc.find_first_of('/') != 0)
+    // the I/O thread may still be reading into the block
+    if (job)
+        async_queue::instance().wait(job);
+    async_queue::waitIdle();
+}
+
+void hdf5oct::block_reader::prefetch()
+{
+    int rank = size.numel();
+    uint64NDArray st(dim_vector(rank, 1), 1), cnt(size);
+    st(d) = pos + 1;
+    cnt(d) = std::min(bsize, len - pos);
+    if (!dx.selectHyperslab(st, cnt, uint64NDArray(), false))
+        error("h5blocks: hyperslab selection: %s", lastError.c_str());
+    if (!dx.allocate(block, mem_type))
+        error("h5blocks: only numeric and logical datasets can be read in blocks");
+    mem_space = dx.memSpace();
+
+    // The I/O thread gets only the ids and the buffer. The objects stay
+    // here, and are released after the job is done
+    hid_t ds = dset.getId(), mt = mem_type.getId(), ms = mem_space.getId(),
+          fs = dx.dspace.getId();
+    void *buf = block.data();
+    unsigned nthreads = dx.nthreads;
+    auto e = err = std::make_shared<std::string>();
+    job = async_queue::instance().submit(
+        fname, block.nbytes(),
+        [=]()
+        {
+            try
+            {
+                if (!(nthreads > 1 && readChunksParallel(ds, mt, fs, buf, nthreads)) &&
+                    H5Dread(ds, mt, ms, fs, H5P_DEFAULT, buf) < 0)
+                    *e = "h5blocks: reading a block failed";
+            }
+            catch (const std::exception &x)
+            {
+                *e = x.what();
+            }
+        });
+}
+
+octave_value hdf5oct::block_reader::next(uint64NDArray &start)
+{
+    if (!hasNext())
+        error("h5blocks: no more blocks");
+    if (!job)
+        prefetch(); // the previous prefetch failed
+    async_queue::instance().wait(job);
+    job = 0;
+    if (!err->empty())
+        error("%s", err->c_str());
+
+    octave_value v = block.value();
+    block = data_exchange::allocation();
+    start = uint64NDArray(dim_vector(1, size.numel()), 1);
+    start(d) = pos + 1;
+    pos += std::min(bsize, len - pos);
+
+    // read the next block while octave processes this one
+    async_queue::waitIdle();
+    if (hasNext())
+        prefetch();
+    return v;
+}
+
+void hdf5oct::h5blocks::print(std::ostream &os, bool pr_as_read_syntax)
+{
+    print_raw(os, pr_as_read_syntax);
+    newline(os);
+}
+
+void hdf5oct::h5blocks::print_raw(std::ostream &os, bool) const
+{
+    indent(os);
+    os << "<h5blocks " << name << (r ? "" : " (closed)") << ">";
+}
+
+octave_value hdf5oct::h5blocks::subsref(const std::string &type,
+                                        const std::list<octave_value_list> &idx)
+{
+    octave_value_list retval = subsref(type, idx, 1);
+    return retval.length() > 0 ? retval(0) : octave_value();
+}
+
+octave_value_list hdf5oct::h5blocks::subsref(const std::string &type,
+                                             const std::list<octave_value_list> &idx, int)
+{
+    // it.method or it.method()
+    if (type.empty() || type[0] != '.' || type.size() > 2 ||
+        (type.size() == 2 && type[1] != '('))
+        error("h5blocks: invalid use of a h5blocks object, call it.hasNext(), it.next() or it.close()");
+    string method = idx.front()(0).string_value();
+    if (type.size() == 2 && idx.back().length() != 0)
+        error("h5blocks: method %s takes no arguments", method.c_str());
+
+    octave_value_list retval;
+    if (method == "hasNext")
+        retval(0) = r && r->hasNext();
+    else if (method == "next")
     {
-        lastError = "dataset location should be specified "
-                    "as a full pathname with leading '/'";
-        return false;
+        if (!r)
+            error("h5blocks: %s is closed", name.c_str());
+        uint64NDArray start;
+        try
+        {
+            retval(0) = r->next(start);
+        }
+        catch (const H5::Exception &e)
+        {
+            error("%s", e.what());
+        }
+        retval(1) = octave_value(NDArray(start));
     }
-    return true;
+    else if (method == "close")
+        r.reset();
+    else
+        error("h5blocks: unknown method '%s'", method.c_str());
+    return retval;
 }
+
+DEFINE_OV_TYPEID_FUNCTIONS_AND_DATA(hdf5oct::h5blocks, "h5blocks", "h5blocks");
@@ -27,14 +27,29 @@
 #define _hdf5oct_h_
 
 #include <octave/oct.h>
+#include <octave/file-ops.h>
+#include <octave/file-stat.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
 
 // #if defined (HAVE_HDF5) && defined (HAVE_HDF5_18)
 #include <highfive/highfive.hpp>
 
+#include "h5chunks.h"
+
 namespace hdf5oct
 {
 
-    static std::string lastError;
+    // The error of the last failed call, per thread: the asynchronous
+    // writes of async_queue fail in their own thread
+    static thread_local std::string lastError;
 
     // Helper type traits template
     template <typename T>
@@ -143,6 +158,29 @@ namespace hdf5oct
     // Translate an octave-like type spec, e.g. 'uint32', to H5 datatype
     HighFive::DataType h5type_from_spec(const std::string &dtype_spec);
 
+    /**
+     * @brief Guess a chunk shape for a dataset
+     *
+     * Uses the same heuristic as h5py: the chunk dimensions are halved
+     * in turn, starting from the slowest varying, until the chunk
+     * is close to a target size. Unless given, the target is between
+     * 8 KiB and 1 MiB and grows with the size of the dataset.
+     *
+     * The access hint restricts the chunk to a single
+     * row ("row"), column ("column") or frame, i.e. the slice along
+     * the last Octave dimension ("frame"). The remaining dimensions are
+     * then shrunk as above, while the restricted ones are grown again
+     * if the chunk would fall short of the target size.
+     *
+     * @param dims The dataset dimensions in HDF5 order, 0 for unlimited
+     * @param elem_size The size of a data element in bytes
+     * @param access The access hint, "row", "column", "frame" or empty
+     * @param target_bytes The target chunk size in bytes, 0 for automatic
+     * @return The chunk dimensions in HDF5 order
+     */
+    std::vector<hsize_t> guessChunkDims(const std::vector<size_t> &dims, size_t elem_size,
+                                        const std::string &access = "", size_t target_bytes = 0);
+
     /**
      * @brief Check if a location exists in a HDF5 file.
      *
@@ -155,6 +193,57 @@ namespace hdf5oct
      */
     bool locationExists(const HighFive::File &f, const std::string &loc);
 
+    /**
+     * @brief Check if a location exists, remembering the intermediate paths
+     *
+     * Same as above, but the existence of each path is looked up in, or
+     * stored into, @p known. Thus, when checking many locations in the
+     * same file, the common intermediate groups are checked only once.
+     *
+     * @param f The HDF5 file object
+     * @param loc The location path
+     * @param known Paths already checked and whether they exist
+     * @return true If the specified location exists
+     */
+    bool locationExists(const HighFive::File &f, const std::string &loc,
+                        std::map<std::string, bool> &known);
+
+    // A link in a group and the type of the object it points to
+    struct link_info_t
+    {
+        std::string name;
+        H5L_type_t link_type;
+        H5O_type_t obj_type; // H5O_TYPE_UNKNOWN for dangling and unresolved external links
+    };
+
+    /**
+     * @brief List the members of a group in a single pass
+     *
+     * Iterates over the links of the group with H5Literate, in increasing
+     * name order, and gets the type of each object from its header,
+     * without opening it.
+     *
+     * @param g The group
+     * @param follow_external If false, the type of external links is not resolved
+     * @return The links of the group
+     */
+    std::vector<link_info_t> listGroupMembers(const HighFive::Group &g,
+                                              bool follow_external = false);
+
+    /**
+     * @brief Open all members of a group in a single pass
+     *
+     * Iterates over the links of the group with H5Literate, in increasing
+     * name order, and opens the object of each link. Links that cannot
+     * be resolved (e.g. dangling soft links) are skipped.
+     *
+     * @param g The group
+     * @param names The names of the members
+     * @param objects The opened member objects, same order as @p names
+     */
+    void openGroupMembers(const HighFive::Group &g, std::vector<std::string> &names,
+                          std::vector<HighFive::Object> &objects);
+
     /**
      * @brief Check if a location can be created in a HDF5 file.
      *
@@ -171,6 +260,344 @@ namespace hdf5oct
 
     bool validLocation(const std::string &loc);
 
+    // true for the names of the files held in memory, "mem://name"
+    bool isMemoryFile(const std::string &filename);
+
+    // Chunk dimensions of a dataset in octave order, empty if not chunked
+    uint64NDArray getChunkSize(const HighFive::DataSet &ds);
+
+    /**
+     * Fill value of a dataset creation property list, converted to the
+     * octave type spec, e.g. 'uint32' or 'string'. HDF5 reports 0 (an
+     * empty string) if no fill value was set, while an undefined fill
+     * value, or one that cannot be converted, is returned empty.
+     */
+    octave_value getFillValue(const HighFive::DataSetCreateProps &dcpl,
+                              const std::string &dtype_spec);
+    // Set the fill value from an octave scalar converted to the type spec
+    bool setFillValue(HighFive::DataSetCreateProps &dcpl, const std::string &dtype_spec,
+                      const octave_value &v);
+
+    /**
+     * Datasets extended by h5append are over-allocated along the append
+     * dimension. Their logical size (in HDF5 order) is kept in this
+     * attribute until they are trimmed to it, when the file is flushed
+     * or closed. All functions reading a dataset use the logical size.
+     */
+    static const char *const appendSizeAttr = "HDF5OCT_APPEND_SIZE";
+    // Dimensions of a dataset (HDF5 order), the logical size if over-allocated
+    std::vector<size_t> logicalDims(const HighFive::DataSet &ds);
+    // The dataspace of a dataset with its logical size
+    HighFive::DataSpace logicalSpace(const HighFive::DataSet &ds);
+    // Resize an over-allocated dataset to its logical size
+    void trimDataset(HighFive::DataSet &ds);
+
+    /**
+     * In SWMR (single writer, multiple readers) mode, set by h5open, a
+     * writer appends to the existing datasets of a file, flushing it
+     * after each write, while other processes read it. No objects or
+     * attributes may be created, so h5append grows the extent exactly.
+     * Readers refresh each dataset they access, to see its current
+     * extent and data.
+     */
+    bool isSWMRWriter(const HighFive::File &f);
+    // Refresh a dataset if its file is open for SWMR reading
+    void refreshSWMR(const HighFive::DataSet &ds);
+
+    /**
+     * @brief Chunk cache settings of a dataset
+     *
+     * Set from the 'ChunkCache' option of h5read/h5write, which is
+     * either [nbytes nslots w0] (nslots and w0 are optional) or 'auto'.
+     * In auto mode the cache is sized so that all chunks touched by the
+     * hyperslab selection fit, between 1 MiB and max_auto_bytes.
+     * If nslots is not given, it is set to a prime number ~10x the
+     * number of chunks that fit in the cache.
+     */
+    struct chunk_cache_t
+    {
+        enum mode_t
+        {
+            None,
+            Manual,
+            Auto
+        };
+        static constexpr size_t max_auto_bytes = 256 * 1024 * 1024;
+
+        mode_t mode{None};
+        size_t nbytes{0};
+        size_t nslots{0};
+        double w0{0.75};
+
+        bool assign(const octave_value &v);
+        void assign(const HighFive::DataSetAccessProps &dapl);
+        // compute nbytes (auto mode) and nslots for the dataset & selection
+        void configure(const HighFive::DataSet &ds, const uint64NDArray &start,
+                       const uint64NDArray &count, const uint64NDArray &stride);
+        HighFive::DataSetAccessProps dapl() const;
+        octave_scalar_map oct_map() const;
+    };
+
+    /**
+     * @brief Access properties of files opened read-only
+     *
+     * The size of the page buffer, which holds whole file pages of files
+     * created with paged aggregation, the initial and maximum size of
+     * the metadata cache (0 for the HDF5 defaults) and whether the
+     * metadata of an object are evicted from the cache when it is closed,
+     * and whether the file is opened for SWMR reading.
+     * Set for all files by h5fileaccess and for a single file by h5open.
+     */
+    struct file_access_t
+    {
+        // limits of the metadata cache size in HDF5 (H5C__MIN/MAX_MAX_CACHE_SIZE)
+        static constexpr size_t min_mdc_bytes = 1024;
+        static constexpr size_t max_mdc_bytes = 128 * 1024 * 1024;
+
+        size_t page_buffer_size{0};
+        size_t mdc_initial_size{0};
+        size_t mdc_max_size{0};
+        bool evict_on_close{false};
+        bool swmr{false};
+        // read the whole file into memory with the core driver
+        bool core{false};
+
+        // set the fields given in the map: PageBufferSize,
+        // MetadataCacheSize (max or [initial max]), EvictOnClose, SWMR and Core
+        bool assign(const octave_scalar_map &m);
+        // the access property list, optionally without the page buffer
+        HighFive::FileAccessProps fapl(bool page_buffer = true) const;
+        bool operator==(const file_access_t &a) const;
+        bool operator!=(const file_access_t &a) const { return !(*this == a); }
+        octave_scalar_map oct_map() const;
+    };
+
+    /**
+     * @brief Cache of open HDF5 files shared by all hdf5oct functions
+     *
+     * Files are kept open between calls, so that repeated access to the
+     * same file does not pay for H5Fopen/H5Fclose every time.
+     * There is one entry per file, keyed by its canonical path.
+     * Unpinned entries are evicted in least-recently-used order when
+     * more than capacity() of them are open. Files opened with h5open
+     * are pinned and stay open until h5close.
+     *
+     * A cached file is closed and re-opened when:
+     * - the file on disk has been deleted or replaced (device/inode changed)
+     * - it was opened read-only and its size or modification time changed
+     * - write access is requested on a file opened read-only (mode upgrade)
+     *
+     * Files named "mem://name" exist only in memory (HDF5 core driver
+     * without a backing store). They are created on the first write
+     * access, or from a file image by openImage(), are always writable
+     * and pinned, and are discarded by close().
+     *
+     * @code {.cpp}
+     * H5::File file = file_cache::instance().open(filename, H5::File::ReadWrite);
+     * ... write to file ...
+     * file_cache::instance().sync(file); // flush, unless pinned
+     * @endcode
+     */
+    class file_cache
+    {
+    public:
+        static file_cache &instance();
+
+        /**
+         * @brief Get an open file from the cache, opening it if needed
+         *
+         * Files created with the latest file format (by a fapl with the
+         * low bound H5F_LIBVER_LATEST) are re-opened for writing with the
+         * latest format, so that the objects added to them later in the
+         * session also use it. Files opened read-only use the access
+         * properties set by set_access() for all files, or for this file.
+         *
+         * @param filename The HDF5 file name
+         * @param mode HighFive open flags: ReadOnly, ReadWrite or Create
+         * @param pin If true, the file will not be evicted until close()
+         * @param fcpl, fapl The properties of a file being created
+         * @return The open file object
+         */
+        HighFive::File open(const std::string &filename, unsigned mode, bool pin = false,
+                            const HighFive::FileCreateProps &fcpl = HighFive::FileCreateProps::Default(),
+                            const HighFive::FileAccessProps &fapl = HighFive::FileAccessProps::Default());
+        /**
+         * @brief Open a copy of a file image as the memory file @p name
+         *
+         * A file of the same name is closed first.
+         */
+        HighFive::File openImage(const std::string &name, const void *image, size_t size);
+        // flush a file after write operations, unless it is pinned
+        void sync(const HighFive::File &f);
+        // The scope in which sync() would flush f, for flushing it later
+        // in another thread. The datasets of h5append are trimmed now.
+        // Returns false if f would not be flushed
+        bool syncScope(const HighFive::File &f, H5F_scope_t &scope);
+        // close a cached file, return false if it was not open
+        bool close(const std::string &filename);
+        void close_all();
+        // flush a cached file, return false if it was not open
+        bool flush(const std::string &filename);
+        void flush_all();
+
+        size_t capacity() const { return max_files; }
+        void set_capacity(size_t n);
+        // canonical names of the open files, most recently used first
+        std::vector<std::string> names() const;
+
+        // access properties of files opened read-only from now on
+        const file_access_t &access() const { return default_access; }
+        void set_access(const file_access_t &a) { default_access = a; }
+        // access properties of one file, until it is closed
+        file_access_t access(const std::string &filename) const;
+        void set_access(const std::string &filename, const file_access_t &a);
+
+        /**
+         * @brief Open a dataset with the given chunk cache settings
+         *
+         * If the file is cached, the dataset is kept open together with it,
+         * so that its chunk cache is preserved between calls.
+         * Other calls opening the same dataset share the chunk cache.
+         * A dataset already held open is re-used if its cache has the
+         * same settings (or is large enough, in auto mode). Otherwise it
+         * is closed and re-opened. Thus, the caller must not hold other
+         * handles to it, or else the new settings are not applied.
+         */
+        HighFive::DataSet openDataSet(const HighFive::File &f, const std::string &loc,
+                                      const chunk_cache_t &cache);
+
+        /**
+         * @brief Get a memory mapping of a file, for reading contiguous datasets
+         *
+         * The mapping is kept together with the cached file and renewed
+         * when the file size changes. Files open for writing are flushed
+         * first, so that the mapping shows all data written.
+         * Returns a null pointer if the file cannot be mapped.
+         */
+        std::shared_ptr<const file_mapping> mapFile(const HighFive::File &f);
+
+        /**
+         * @brief Register a dataset over-allocated by h5append
+         *
+         * The dataset is trimmed to its logical size when the file is
+         * flushed, closed or evicted. Returns false if the file is not
+         * cached, in which case the caller must trim it right away.
+         */
+        bool trackAppend(const HighFive::File &f, const std::string &loc);
+
+    private:
+        struct entry
+        {
+            std::string path;
+            HighFive::File file;
+            bool writable;
+            bool pinned;
+            // the access properties of a file opened read-only
+            file_access_t access;
+            dev_t dev;
+            ino_t ino;
+            off_t size;
+            double mtime;
+            // datasets held open with custom access properties
+            std::map<std::string, HighFive::DataSet> datasets;
+            std::shared_ptr<const file_mapping> mapping;
+            // datasets over-allocated by h5append
+            std::set<std::string> appended;
+        };
+        // most recently used first
+        std::list<entry> entries;
+        size_t max_files{8};
+        file_access_t default_access;
+        // access properties of single files, by canonical path
+        std::map<std::string, file_access_t> file_access;
+        // files created by us with the latest format, by canonical path
+        std::set<std::string> latest_format;
+
+        file_cache();
+        ~file_cache();
+        std::list<entry>::iterator find(const std::string &path);
+        // trim the datasets of h5append, then flush or close the file
+        static void trim(entry &e);
+        void flush(entry &e);
+        std::list<entry>::iterator erase(std::list<entry>::iterator it);
+        bool isStale(const entry &e) const;
+        void evict();
+    };
+
+    /**
+     * @brief Queue of asynchronous writes, run by a background I/O thread
+     *
+     * The HDF5 library is not thread-safe, so while writes are queued the
+     * I/O thread makes all HDF5 calls: file_cache::instance() waits for
+     * the queue to empty when called from any other thread. A queued job
+     * keeps a reference to the octave data, which are therefore neither
+     * copied nor changed (octave copies them on modification) until written.
+     *
+     * The total size of the queued data is limited to capacity() bytes,
+     * submit() blocks until there is room. Failed jobs are kept until their
+     * errors are collected by wait() or waitFile().
+     */
+    class async_queue
+    {
+    public:
+        static async_queue &instance();
+
+        /**
+         * @brief Queue a job writing data to a file
+         *
+         * @param filename The file written by the job
+         * @param data The octave data, referenced until the job is done
+         * @param job The job, called by the I/O thread. Errors are thrown as std::exception
+         * @return The job id, a positive number
+         */
+        uint64_t submit(const std::string &filename, const octave_value &data,
+                        std::function<void()> job);
+        // Queue a job on a buffer of nbytes, which the caller keeps until the job is done
+        uint64_t submit(const std::string &filename, size_t nbytes, std::function<void()> job);
+        // Wait for the job id, or all jobs if id == 0. Returns the errors of failed jobs
+        std::vector<std::string> wait(uint64_t id);
+        // Wait for the jobs writing to a file. Returns the errors of failed jobs
+        std::vector<std::string> waitFile(const std::string &filename);
+        // Wait until the queue is empty, unless called by the I/O thread
+        static void waitIdle();
+
+        size_t capacity() const { return max_bytes; }
+        void set_capacity(size_t nbytes);
+
+    private:
+        struct job_t
+        {
+            uint64_t id;
+            std::string path;
+            octave_value data;
+            size_t nbytes;
+            std::function<void()> run;
+            std::string err;
+        };
+        std::mutex m;
+        std::condition_variable cv;
+        // submitted jobs in order, removed by the submitting thread when done.
+        // The jobs before next are done, jobs[next] is running or waiting
+        std::deque<std::shared_ptr<job_t>> jobs;
+        size_t next{0};
+        uint64_t next_id{1};
+        size_t queued_bytes{0};
+        size_t max_bytes{size_t(256) << 20};
+        bool stop{false};
+        std::thread worker;
+
+        async_queue();
+        ~async_queue();
+        uint64_t submit(std::shared_ptr<job_t> j);
+        void run();
+        // wait until pred() holds, interruptible by Ctrl-C
+        template <class Pred>
+        void waitFor(std::unique_lock<std::mutex> &lk, Pred pred);
+        // remove the done jobs for which pred(job) is true, returning their errors
+        template <class Pred>
+        std::vector<std::string> collect(Pred pred);
+    };
+
     // structures with info on H5 objects (DataSpace,DataType,DataSet,Group)
     // oct_map() function returns this info as a (key,value) map
     // for reporting back to Octave in h5info
@@ -197,9 +624,29 @@ namespace hdf5oct
         std::string signed_status;
         std::string cset;
         std::string pading;
+        std::vector<std::string> fields; // members of a compound type read as a struct
         void assign(const HighFive::DataType &dtype);
         octave_scalar_map oct_map() const;
     };
+    // Options of h5info, controlling how much information is collected
+    struct info_opts_t
+    {
+        enum attr_mode_t
+        {
+            NoAttributes,
+            AttributeNames,
+            AttributeValues
+        };
+        int depth{-1};                          // levels of groups to list, <0 for all
+        attr_mode_t attributes{AttributeValues}; // attributes to read
+        bool dataset_details{true};             // datatype, dataspace, chunking etc.
+    };
+    // Filter in a dataset's filter pipeline
+    struct filter_info_t
+    {
+        std::string name;
+        std::vector<unsigned> cd_values;
+    };
     // DataSet
     struct dset_info_t
     {
@@ -207,9 +654,13 @@ namespace hdf5oct
         dtype_info_t dtype_info;
         dspace_info_t dspace_info;
         uint64NDArray chunksize;
+        chunk_cache_t chunk_cache;
+        std::vector<filter_info_t> filters;
         octave_value fillValue;
         std::map<std::string, octave_value> attributes;
-        void assign(const HighFive::DataSet &ds, const std::string &path);
+        bool details{true};
+        void assign(const HighFive::DataSet &ds, const std::string &path,
+                    const info_opts_t &opts = info_opts_t());
         octave_scalar_map oct_map() const;
     };
     // Named DataType (not fully implemented)
@@ -237,10 +688,35 @@ namespace hdf5oct
         std::vector<dset_info_t> datasets;
         std::vector<named_dtype_info_t> datatypes;
         std::map<std::string, octave_value> attributes;
-        void assign(const HighFive::Group &g, const std::string &path);
+        void assign(const HighFive::Group &g, const std::string &path,
+                    const info_opts_t &opts = info_opts_t(), int level = 0);
         octave_scalar_map oct_map() const;
     };
 
+    /**
+     * @brief Strings read from HDF5, copied into one buffer
+     *
+     * The output cellstr or char matrix is built directly from the
+     * buffer, without a std::string per element.
+     */
+    struct string_arena
+    {
+        std::vector<char> bytes;
+        // position and length in bytes of each string
+        std::vector<size_t> pos, len;
+
+        size_t size() const { return pos.size(); }
+        // Index n fixed-length strings of size sz, read into bytes.
+        // Null padding is not part of the strings
+        void indexFixed(size_t n, size_t sz, H5T_str_t pad);
+        // Append n variable-length strings
+        void append(char *const *p, size_t n);
+        // A cell array of dimensions dv
+        octave_value cellstr(const dim_vector &dv) const;
+        // A char matrix with one string per row, padded with blanks
+        octave_value charMatrix() const;
+    };
+
     /**
      * @brief The data_exchage structure facilitates IO operations between H5 & Octave
      *
@@ -279,6 +755,23 @@ namespace hdf5oct
         dspace_info_t dspace_info;
         std::string dtype_spec;
         dim_vector dv;
+        HighFive::DataTransferProps xfer_props;
+        // Threads for decoding/encoding filtered chunks in read()/write(),
+        // see readChunksParallel() and writeChunksParallel()
+        unsigned nthreads{defaultThreads()};
+        // true for point or mask selections, read/written as a list of elements
+        bool element_list{false};
+        // if set, contiguous datasets are read from this mapping, see readMapped()
+        std::shared_ptr<const file_mapping> mapping;
+        // The octave array has the dimensions in HDF5 (row-major) order:
+        // read() returns it so and write() takes it so, see transpose()
+        bool transposed{false};
+        // read() returns strings as a padded char matrix instead of a cellstr
+        bool char_strings{false};
+        // Members of a compound dataset to read(), all if empty
+        std::vector<std::string> fields;
+        // The member read by this object, for the fields of a compound dataset
+        std::string field;
 
         bool assign(octave_value v);
         bool assign(HighFive::DataSet *ds);
@@ -293,11 +786,61 @@ namespace hdf5oct
             return dv.ndims() == 2 && dv(0) == 1 && dv(1) == 1;
         }
         bool selectHyperslab(uint64NDArray start, uint64NDArray count, uint64NDArray stride, bool tryResize);
+        // Select the elements at the 1-based coordinates in the rows of P
+        bool selectPoints(const uint64NDArray &P);
+        // Select the true elements of a logical mask of the size of the dataset
+        bool selectMask(const boolNDArray &M);
+        // Read into an octave array of class out_spec, HDF5 converts the data
+        bool setOutputType(const std::string &out_spec);
+        // Size of the HDF5 type conversion buffer, 0 for the default 1 MiB
+        bool setConversionBuffer(size_t nbytes);
+        // For data to be written that are given in HDF5 dimension order:
+        // reverse dv to octave order, after padding the dimensions of
+        // the value with singletons to ndim
+        void transpose(int ndim);
+        // An octave array allocated by allocate(), for reading data into.
+        // The octave_value is made by value() only after the read, as the
+        // octave_value constructor may narrow the array (1x1 to a scalar,
+        // complex to real) and free the buffer
+        class allocation
+        {
+        public:
+            void *data() const { return buf; }
+            size_t nbytes() const { return size; }
+            octave_value value() const { return array ? array() : octave_value(); }
+
+        private:
+            friend struct data_exchange;
+            void *buf{nullptr};
+            size_t size{0};
+            // holds a reference to the array
+            std::function<octave_value()> array;
+        };
+        // Allocate the octave array for read() without reading.
+        // Returns false for types that are not read into a plain buffer (strings)
+        bool allocate(allocation &a, HighFive::DataType &mem_type);
+        HighFive::DataSpace memSpace() const { return from_dim_vector(dv); }
 
         octave_value read();
         octave_value read_attribute();
         void write(const data_exchange &dxfile);
 
+        // The data of write() in memory: the elements, or the string
+        // pointers, in the order of the file and of type mem_type.
+        // hold keeps the arrays alive, so that another thread can write them
+        struct write_buffer
+        {
+            const void *data{nullptr};
+            HighFive::DataType mem_type;
+            std::shared_ptr<const void> hold;
+        };
+        // Convert the octave data for write() into b
+        void prepareWrite(write_buffer &b) const;
+        // Write buf to the selection file_space of dset, with nthreads
+        // encoding whole chunks if possible. Makes no octave calls
+        static void writeRaw(hid_t dset, hid_t mem_type, hid_t mem_space, hid_t file_space,
+                             const void *buf, unsigned nthreads);
+
         template <class Derivate>
         bool write_as_attribute(Derivate &obj, const std::string &name)
         {
@@ -324,30 +867,64 @@ namespace hdf5oct
                                        xfer_props.getId(),
                                        data);
         }
-        static void h5write(const HighFive::DataSet &dset,
-                            const void *data,
-                            const HighFive::DataType &mem_type, const HighFive::DataSpace &mem_space,
-                            const HighFive::DataSpace &file_space,
-                            const HighFive::DataTransferProps &xfer_props = HighFive::DataTransferProps())
-        {
-            HighFive::detail::h5d_write(dset.getId(),
-                                        mem_type.getId(),
-                                        mem_space.getId(),
-                                        file_space.getId(),
-                                        xfer_props.getId(),
-                                        data);
-        }
 
         bool assign(const HighFive::DataType &t, const HighFive::DataSpace &s);
 
+        static dim_vector reversed(const dim_vector &dv);
+        // The memory type t, or for a compound member, a compound of t
+        // alone, so that HDF5 reads only that member
+        HighFive::DataType memType(const HighFive::DataType &t) const
+        {
+            if (field.empty())
+                return t;
+            return HighFive::CompoundType({{field, t, 0}}, t.getSize());
+        }
+        // Copy src in C order to dst in Fortran order, both of dimensions dims
+        void reverse(const void *src, void *dst, const dim_vector &dims, size_t elem_size) const;
+
+        void read_raw(void *buf, const HighFive::DataType &mem_type)
+        {
+            bool done = (mapping && readMapped(dset->getId(), mem_type.getId(), dspace.getId(),
+                                               buf, *mapping)) ||
+                        (nthreads > 1 && readChunksParallel(dset->getId(), mem_type.getId(),
+                                                            dspace.getId(), buf, nthreads));
+            if (!done)
+                h5read(*dset, buf, mem_type, from_dim_vector(dv), dspace, xfer_props);
+        }
         template <class T>
         octave_value read_impl()
         {
+            HighFive::DataType mem_type = memType(h5traits<T>::predType());
+            if (transposed)
+            {
+                // Decoded chunks are stored with the dimensions reversed.
+                // Otherwise the selection is read as usual and then reversed
+                typename h5traits<T>::OctaveArray A(reversed(dv));
+                if (!(nthreads > 1 && readChunksParallel(dset->getId(), mem_type.getId(),
+                                                         dspace.getId(), A.fortran_vec(),
+                                                         nthreads, true)))
+                {
+                    typename h5traits<T>::OctaveArray B(dv);
+                    read_raw(B.fortran_vec(), mem_type);
+                    reverse(B.data(), A.fortran_vec(), reversed(dv), sizeof(T));
+                }
+                return octave_value(A);
+            }
             typename h5traits<T>::OctaveArray A(dv);
-            h5read(*dset, A.fortran_vec(), h5traits<T>::predType(), from_dim_vector(dv), dspace);
+            read_raw(A.fortran_vec(), mem_type);
             return octave_value(A);
         }
         template <class T>
+        void alloc_impl(allocation &a, HighFive::DataType &mem_type)
+        {
+            typename h5traits<T>::OctaveArray A(dv);
+            a.buf = A.fortran_vec();
+            a.size = A.numel() * sizeof(T);
+            a.array = [A]()
+            { return octave_value(A); };
+            mem_type = h5traits<T>::predType();
+        }
+        template <class T>
         octave_value read_attr_impl()
         {
             typename h5traits<T>::OctaveArray A(dv);
@@ -356,12 +933,24 @@ namespace hdf5oct
         }
         octave_value read_string();
         octave_value read_string_attr();
+        octave_value string_value(string_arena &S);
+        octave_value read_compound();
 
         template <typename T>
-        void write_impl(const data_exchange &dxfile)
+        void prepare_impl(write_buffer &b) const
         {
-            auto A = h5traits<T>::toOctaveArray(ov);
-            h5write(*dxfile.dset, A.fortran_vec(), h5traits<T>::predType(), dspace, dxfile.dspace);
+            auto A = std::make_shared<typename h5traits<T>::OctaveArray>(h5traits<T>::toOctaveArray(ov));
+            b.mem_type = h5traits<T>::predType();
+            b.data = A->data();
+            b.hold = A;
+            if (transposed)
+            {
+                // Fortran order of the octave dimensions dv is C order in the file
+                auto tmp = std::make_shared<std::vector<unsigned char>>(A->numel() * sizeof(T));
+                reverse(A->data(), tmp->data(), dv, sizeof(T));
+                b.data = tmp->data();
+                b.hold = tmp;
+            }
         }
         template <typename T>
         void write_attr_impl(HighFive::Attribute &att)
@@ -369,17 +958,189 @@ namespace hdf5oct
             auto A = h5traits<T>::toOctaveArray(ov);
             att.write_raw(A.fortran_vec(), h5traits<T>::predType());
         }
-        void write_string(const data_exchange &dxfile);
+        void prepare_string(write_buffer &b) const;
         void write_string_attr(HighFive::Attribute &attr);
         bool write_as_attribute(HighFive::Attribute &attr);
     };
 
+    /**
+     * @brief Writes a stream of blocks to a dataset
+     *
+     * The dataset stays open, together with the file and memory
+     * dataspaces prepared for the last block. A block of the same class
+     * and size as the previous one is written by selecting the hyperslab
+     * at the new start and a single H5Dwrite, without re-opening the
+     * dataset or re-checking the data. The file is flushed on destruction.
+     */
+    class dataset_writer
+    {
+    public:
+        dataset_writer(const std::string &filename, const std::string &location);
+        ~dataset_writer();
+        dataset_writer(const dataset_writer &) = delete;
+        dataset_writer &operator=(const dataset_writer &) = delete;
+
+        // Write block at the 1-based start (octave order), extending the dataset if needed
+        void write(const octave_value &block, const uint64NDArray &start);
+
+    private:
+        HighFive::File file;
+        HighFive::DataSet dset;
+        data_exchange dxfile, dxmem;
+        // class of the last block
+        std::string cls;
+        bool cplx{false};
+        // size of the last block, current and maximum extent (HDF5 order)
+        std::vector<hsize_t> count, offset;
+        std::vector<size_t> extent, maxdims;
+
+        void prepare(const octave_value &block, const uint64NDArray &start);
+    };
+
+    /**
+     * @brief The octave handle of a dataset_writer, returned by h5writer
+     *
+     * Supports the methods w.write(block, start) and w.close().
+     * Copies of the handle share the writer, which is destroyed
+     * by close() or when the last copy is cleared.
+     */
+    class h5writer : public octave_base_value
+    {
+    public:
+        // a closed handle, needed for registering the type
+        h5writer() = default;
+        h5writer(const std::string &filename, const std::string &location)
+            : w(std::make_shared<dataset_writer>(filename, location)),
+              name(filename + ":" + location) {}
+
+        octave_base_value *clone() const override { return new h5writer(*this); }
+        octave_base_value *empty_clone() const override { return new h5writer(); }
+
+        dim_vector dims() const override { return dim_vector(1, 1); }
+        bool is_defined() const override { return true; }
+        bool is_constant() const override { return true; }
+        bool print_as_scalar() const override { return true; }
+        void print(std::ostream &os, bool pr_as_read_syntax = false) override;
+        void print_raw(std::ostream &os, bool pr_as_read_syntax = false) const override;
+
+        octave_value subsref(const std::string &type,
+                             const std::list<octave_value_list> &idx) override;
+        octave_value_list subsref(const std::string &type,
+                                  const std::list<octave_value_list> &idx, int nargout) override;
+
+    private:
+        std::shared_ptr<dataset_writer> w;
+        // file:location, for display
+        std::string name;
+
+        DECLARE_OV_TYPEID_FUNCTIONS_AND_DATA
+    };
+
+    /**
+     * @brief Reads a dataset in consecutive blocks along one dimension
+     *
+     * The blocks span the whole dataset along the other dimensions and,
+     * for chunked datasets, consist of whole chunks along the block
+     * dimension. While a block is returned by next(), the following one is
+     * read by the I/O thread of async_queue, overlapping I/O with the
+     * processing of the current block in octave.
+     */
+    class block_reader
+    {
+    public:
+        /**
+         * @param filename The HDF5 file
+         * @param location The dataset
+         * @param dim The octave dimension along which the dataset is split, 0 for the last one
+         * @param blocksize The number of elements along dim, rounded up to whole chunks.
+         * 0 for a single chunk
+         */
+        block_reader(const std::string &filename, const std::string &location,
+                     int dim, size_t blocksize);
+        ~block_reader();
+        block_reader(const block_reader &) = delete;
+        block_reader &operator=(const block_reader &) = delete;
+
+        bool hasNext() const { return pos < len; }
+        // The next block and its 1-based start (octave order)
+        octave_value next(uint64NDArray &start);
+
+    private:
+        std::string fname;
+        HighFive::File file;
+        HighFive::DataSet dset;
+        data_exchange dx;
+        // size of the dataset (octave order), block dimension (octave index),
+        // its length and the block size along it
+        uint64NDArray size;
+        int d{0};
+        size_t len{0}, bsize{0};
+        // start of the next block to return
+        size_t pos{0};
+        // the block being read by the I/O thread, its memory type and space.
+        // Read errors are kept in err and reported by next(), so that they
+        // are not taken by h5flush or h5wait
+        uint64_t job{0};
+        data_exchange::allocation block;
+        std::shared_ptr<std::string> err;
+        HighFive::DataType mem_type;
+        HighFive::DataSpace mem_space{HighFive::DataSpace::Null()};
+
+        void prefetch();
+    };
+
+    /**
+     * @brief The octave handle of a block_reader, returned by h5blocks
+     *
+     * Supports the methods it.hasNext(), [x, start] = it.next() and it.close().
+     */
+    class h5blocks : public octave_base_value
+    {
+    public:
+        // a closed handle, needed for registering the type
+        h5blocks() = default;
+        h5blocks(const std::string &filename, const std::string &location,
+                 int dim, size_t blocksize)
+            : r(std::make_shared<block_reader>(filename, location, dim, blocksize)),
+              name(filename + ":" + location) {}
+
+        octave_base_value *clone() const override { return new h5blocks(*this); }
+        octave_base_value *empty_clone() const override { return new h5blocks(); }
+
+        dim_vector dims() const override { return dim_vector(1, 1); }
+        bool is_defined() const override { return true; }
+        bool is_constant() const override { return true; }
+        bool print_as_scalar() const override { return true; }
+        void print(std::ostream &os, bool pr_as_read_syntax = false) override;
+        void print_raw(std::ostream &os, bool pr_as_read_syntax = false) const override;
+
+        octave_value subsref(const std::string &type,
+                             const std::list<octave_value_list> &idx) override;
+        octave_value_list subsref(const std::string &type,
+                                  const std::list<octave_value_list> &idx, int nargout) override;
+
+    private:
+        std::shared_ptr<block_reader> r;
+        // file:location, for display
+        std::string name;
+
+        DECLARE_OV_TYPEID_FUNCTIONS_AND_DATA
+    };
+
+    // Read the attributes of an object, or only their names (with empty values)
     template <class H5Obj>
-    std::map<std::string, octave_value> readAttributes(const H5Obj &obj)
+    std::map<std::string, octave_value> readAttributes(const H5Obj &obj, bool values = true)
     {
         std::map<std::string, octave_value> M;
         for (auto &attr_name : obj.listAttributeNames())
         {
+            if (attr_name == appendSizeAttr)
+                continue;
+            if (!values)
+            {
+                M[attr_name] = Matrix();
+                continue;
+            }
             hdf5oct::data_exchange dx;
             octave_value ov;
             HighFive::Attribute attr = obj.getAttribute(attr_name);
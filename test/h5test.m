@@ -36,11 +36,22 @@ function test_help(funcname)
 endfunction
 test_help('h5create');
 test_help('h5write');
+test_help('h5append');
+test_help('h5writer');
+test_help('h5blocks');
 test_help('h5writeatt');
 test_help('h5read');
 test_help('h5readatt');
 test_help('h5info');
 test_help('h5disp');
+test_help('h5ls');
+test_help('h5threads');
+test_help('h5wait');
+test_help('h5writequeue');
+test_help('h5fileaccess');
+test_help('h5filestats');
+test_help('h5serialize');
+test_help('h5deserialize');
 
 disp("------------ test functionality: ----------------")
 function ret = insert_chunk_at(mat, chunk, start)
@@ -317,3 +328,773 @@ catch
   disp(["error catched: ", lasterror.message])
 end
 
+disp("------------ test blocks: ----------------")
+% the %! blocks below, each of which creates its own files
+[npass, ntest] = test (fullfile (fileparts (mfilename ("fullpath")), "h5test.m"));
+if (npass < ntest)
+  error ("h5test: %d of %d test blocks failed", ntest - npass, ntest);
+endif
+
+
+%!function f = group_file ()
+%!  # a file with nested groups, string and numeric datasets and attributes
+%!  f = tempname ();
+%!  h5create(f,'/T1/D1',[1 10],'Datatype','uint32');
+%!  h5write(f,'/T1/D1',uint32(1:10));
+%!  h5create(f,'/T1/D4',[5 1],'Datatype','string');
+%!  h5write(f,'/T1/D4',{"ένα"; "δύο"; "τρία"; "τέσσερα"; "πέντε"});
+%!  h5create(f,'/T2/G1/G2/D1',[Inf 15],'ChunkSize',[5 15]);
+%!  h5write(f,'/T2/G1/G2/D1',reshape(1:80,10,8),[11 1],[10 8],[1 2]);
+%!  h5create(f,'/T2/D4',[3 4 Inf],'ChunkSize',[3 4 1]);
+%!  h5write(f,'/T2/D4',reshape(1:60,3,4,5),[1 1 1],[3 4 5]);
+%!  h5writeatt(f,'/T2/G1/G2/D1','A1',1:10);
+%!  h5writeatt(f,'/T2/G1/G2','A2',"Χαρακτηριστικό");
+%!  h5writeatt(f,'/T2/G1','A3',{"1ο Χαρακτηριστικό"; "2ο Χαρακτηριστικό"});
+%!  for i=1:5
+%!    h5create(f,sprintf('/T8/G1/D%d',i),[10 20]);
+%!    h5write(f,sprintf('/T8/G1/D%d',i),i*reshape(1:200,10,20));
+%!  endfor
+%!endfunction
+
+%!test
+%! # files opened with h5open stay open until h5close
+%! f = tempname ();
+%! h5create(f,'/D1',[2 3]);
+%! h5open(f);
+%! [~, files] = h5filecache ();
+%! assert (any (strcmp (files, canonicalize_file_name (f))));
+%! # write to a file opened read-only
+%! x = reshape(1:6,2,3);
+%! h5write(f,'/D1',x);
+%! h5flush(f);
+%! assert (h5read(f,'/D1'), x);
+%! h5close(f);
+%! [~, files] = h5filecache ();
+%! assert (!any (strcmp (files, canonicalize_file_name (f))));
+%! assert (h5read(f,'/D1'), x);
+%! h5close(f);
+%! fail ("h5open (f, 'w')", "invalid mode");
+%! delete (f);
+
+%!test
+%! # a cached file that is replaced on disk is re-opened
+%! if (ispc ()) return; endif # open files cannot be deleted
+%! f = tempname ();
+%! h5create(f,'/D1',[2 3]);
+%! h5write(f,'/D1',ones(2,3));
+%! assert (h5read(f,'/D1'), ones(2,3));
+%! delete (f);
+%! h5create(f,'/D1',[2 3]);
+%! h5write(f,'/D1',2*ones(2,3));
+%! assert (h5read(f,'/D1'), 2*ones(2,3));
+%! h5close(f);
+%! delete (f);
+
+%!test
+%! # caching can be disabled
+%! n = h5filecache ();
+%! h5filecache (0);
+%! f = tempname ();
+%! h5create(f,'/D1',[2 3]);
+%! [~, files] = h5filecache ();
+%! assert (isempty (files));
+%! h5filecache (n);
+%! assert (h5filecache (), n);
+%! delete (f);
+
+%!error <cache size> h5filecache (-1)
+%!error <cache size> h5filecache (1.5)
+%!error <cache size> h5filecache (Inf)
+%!error <cache size> h5filecache (NaN)
+
+%!test
+%! # compressed dataset with automatic chunking
+%! f = tempname ();
+%! x = reshape(1:1e4, 100, 100);
+%! h5create(f,'/D1',size(x),'Deflate',6,'Shuffle',true,'Fletcher32',true);
+%! h5write(f,'/D1',x);
+%! assert (h5read(f,'/D1'), x);
+%! info = h5info(f,'/D1');
+%! assert (!isempty (info.ChunkSize));
+%! assert ({info.Filters.Name}, {"shuffle", "deflate", "fletcher32"});
+%! assert (info.Filters(2).Data, 6);
+%! delete (f);
+
+%!error <scalar dataset> h5create (tempname (), '/D1', 1, 'Deflate', 1)
+%!error <Deflate> h5create (tempname (), '/D1', [2 2], 'Deflate', 10)
+
+%!test
+%! # chunk cache settings are kept while the file is open
+%! f = tempname ();
+%! x = reshape(1:1e4, 100, 100);
+%! h5create(f,'/D1',size(x),'ChunkSize',[10 10]);
+%! h5write(f,'/D1',x,'ChunkCache',[2^20 1009 0.5]);
+%! info = h5info(f,'/D1');
+%! assert (info.ChunkCache.Size, 2^20);
+%! assert (info.ChunkCache.Slots, 1009);
+%! assert (info.ChunkCache.W0, 0.5);
+%! y = h5read(f,'/D1',[1 1],[100 50],[1 2],'ChunkCache','auto');
+%! assert (y, x(:,1:2:end));
+%! y = h5read(f,'/D1','ChunkCache',[2^22 0 1]);
+%! assert (y, x);
+%! info = h5info(f,'/D1');
+%! assert (info.ChunkCache.Size, 2^22);
+%! h5create(f,'/D2',[1 10]);
+%! assert (isempty (h5info(f,'/D2').ChunkCache));
+%! fail ("h5read (f, '/D1', 'ChunkCache', 'big')", "ChunkCache");
+%! delete (f);
+
+%!test
+%! # automatic chunk shapes
+%! f = tempname ();
+%! h5create(f,'/D1',[Inf 100]);
+%! x = rand(10,100);
+%! h5write(f,'/D1',x,[1 1],size(x));
+%! assert (h5read(f,'/D1'), x);
+%! assert (numel (h5info(f,'/D1').ChunkSize), 2);
+%! h5create(f,'/D2',[1000 100],'ChunkAccess','column');
+%! assert (double (h5info(f,'/D2').ChunkSize), [1000 2]);
+%! h5create(f,'/D3',[1000 100],'ChunkSize','auto','ChunkAccess','row');
+%! assert (double (h5info(f,'/D3').ChunkSize), [16 100]);
+%! h5create(f,'/D4',[512 512 Inf],'Datatype','single','ChunkAccess','frame');
+%! assert (double (h5info(f,'/D4').ChunkSize), [256 128 1]);
+%! h5create(f,'/D5',[1024 1024],'ChunkSize','auto','ChunkBytes',2^20);
+%! assert (prod (double (h5info(f,'/D5').ChunkSize))*8, 2^20);
+%! delete (f);
+
+%!error <ChunkSize> h5create (tempname (), '/D1', [2 2], 'ChunkSize', 'big')
+%!error <ChunkAccess> h5create (tempname (), '/D1', [2 2], 'ChunkAccess', 'diagonal')
+%!error <ChunkBytes> h5create (tempname (), '/D1', [2 2], 'ChunkSize', [1 1], 'ChunkBytes', 1024)
+%!error <scalar dataset> h5create (tempname (), '/D1', 1, 'ChunkSize', 'auto')
+
+%!test
+%! # type conversion while reading
+%! f = tempname ();
+%! h5create(f,'/D1',[1 10],'Datatype','uint32');
+%! h5write(f,'/D1',uint32(1:10));
+%! assert (h5read(f,'/D1','OutputType','single'), single(1:10));
+%! h5create(f,'/D2',[10 15]);
+%! h5write(f,'/D2',reshape(1:150,10,15));
+%! y = h5read(f,'/D2',[1 1],[10 2],'OutputType','int8','ConversionBuffer',4096);
+%! assert (y, int8(reshape(1:20,10,2)));
+%! x = [1 2 3e10];
+%! h5create(f,'/D3',size(x));
+%! h5write(f,'/D3',x);
+%! assert (h5read(f,'/D3','OutputType','int32'), int32([1 2 intmax('int32')]));
+%! x = complex(1:3, 3:-1:1);
+%! h5create(f,'/D4',size(x),'Datatype','double complex');
+%! h5write(f,'/D4',x);
+%! assert (h5read(f,'/D4','OutputType','single'), single(x));
+%! assert (h5read(f,'/D4','OutputType','native'), x);
+%! h5create(f,'/D5',[2 1],'Datatype','string');
+%! h5write(f,'/D5',{"one"; "two"});
+%! fail ("h5read (f, '/D5', 'OutputType', 'double')", "cannot convert");
+%! fail ("h5read (f, '/D1', 'OutputType', 'char')", "OutputType");
+%! fail ("h5read (f, '/D1', 'ConversionBuffer', -1)", "ConversionBuffer");
+%! delete (f);
+
+%!test
+%! # read several datasets in one call
+%! f = group_file ();
+%! locs = arrayfun(@(i) sprintf('/T8/G1/D%d',i), 1:5, 'UniformOutput', false);
+%! y = h5readmulti(f,locs);
+%! assert (size (y), [1 5]);
+%! for i=1:5
+%!   assert (y{i}, i*reshape(1:200,10,20));
+%! endfor
+%! # same frame from all datasets
+%! y = h5readmulti(f,locs,[1 3],[10 1],'OutputType','single');
+%! assert (y{4}, single(4*(21:30)'));
+%! # per dataset selection, strings read along
+%! y = h5readmulti(f,{'/T8/G1/D1'; '/T1/D4'; '/T1/D1'},{[2 2], [], [1 3]},{[1 2], [], [1 2]});
+%! assert (y{1}, [12 22]);
+%! assert (y{2}, {"ένα"; "δύο"; "τρία"; "τέσσερα"; "πέντε"});
+%! assert (y{3}, uint32([3 4]));
+%! fail ("h5readmulti (f, {'/T1/D1', '/T8/G2/D1'})", "does not exist");
+%! fail ("h5readmulti (f, {'/T1/D1', '/T1/D4'}, {1}, {1})", "one entry per dataset");
+%! delete (f);
+
+%!test
+%! # scalars and complex arrays, which octave may narrow
+%! f = tempname ();
+%! h5create(f,'/D1',1);
+%! h5write(f,'/D1',pi);
+%! h5create(f,'/D2',[2 3],'Datatype','double complex');
+%! h5write(f,'/D2',complex(reshape(1:6,2,3),[1 0 1; 0 1 0]));
+%! h5create(f,'/D3',[1 2],'Datatype','single complex');
+%! y = h5readmulti(f,{'/D1', '/D2', '/D3', '/D2'},{[], [], [], [2 3]},{[], [], [], [1 1]});
+%! assert (y{1}, pi);
+%! assert (y{2}, complex(reshape(1:6,2,3),[1 0 1; 0 1 0]));
+%! assert (y{3}, complex(single([0 0])));
+%! assert (y{4}, 6);
+%! delete (f);
+
+%!test
+%! # load a group, with and without attributes
+%! f = group_file ();
+%! data = h5load(f,'/T8');
+%! assert (fieldnames (data), {"G1"});
+%! assert (fieldnames (data.G1), {"D1"; "D2"; "D3"; "D4"; "D5"});
+%! assert (data.G1.D3, 3*reshape(1:200,10,20));
+%! assert (h5load(f,'/T1/D1'), uint32(1:10));
+%! [data, attr] = h5load(f,'/T2');
+%! assert ({attr.Name}, {"/T2/G1", "/T2/G1/G2", "/T2/G1/G2/D1"});
+%! assert (attr(3).Attributes.A1, 1:10);
+%! assert (attr(2).Attributes.A2, "Χαρακτηριστικό");
+%! fail ("h5load (f, '/T9')", "does not exist");
+%! delete (f);
+
+%!test
+%! # limited h5info
+%! f = group_file ();
+%! info = h5info(f,'/T2','Depth',1,'Attributes','names','Datasets','names');
+%! assert ({info.Groups.Name}, {"/T2/G1"});
+%! assert (info.Groups(1).Attributes, struct("A3", []));
+%! assert (isempty (info.Groups(1).Groups));
+%! assert ({info.Datasets.Name}, {"/T2/D4"});
+%! assert (isempty (info.Datasets(1).Dataspace));
+%! info = h5info(f,'/T2','Depth',Inf,'Attributes',false);
+%! assert (numfields (info.Groups(1).Groups(1).Attributes), 0);
+%! assert (! isempty (info.Groups(1).Groups(1).Datasets(1).Dataspace));
+%! info = h5info(f,'/T2/G1/G2/D1','Attributes',true);
+%! assert (info.Attributes.A1, 1:10);
+%! fail ("h5info (f, '/', 'Depth', -1)", "Depth");
+%! fail ("h5info (f, '/', 'Attributes', 'all')", "Attributes");
+%! fail ("h5info (f, '/', 'Foo', 1)", "unknown option");
+%! delete (f);
+
+%!test
+%! # list group members
+%! f = group_file ();
+%! [names, types] = h5ls(f,'/T2');
+%! assert (names, {"D4"; "G1"});
+%! assert (types, {"Dataset"; "Group"});
+%! s = evalc ("h5ls (f, '/T8/G1')");
+%! assert (numel (strsplit (strtrim (s), "\n")), 5);
+%! s = evalc ("h5disp (f, '/T2')");
+%! assert (! isempty (strfind (s, "'A3'")));
+%! s = evalc ("h5disp (f, '/T2', 'Attributes', 'values')");
+%! assert (! isempty (strfind (s, "1ο Χαρακτηριστικό")));
+%! fail ("h5ls (f, '/T1/D1')", "not a Group");
+%! delete (f);
+
+%!test
+%! # parallel decompression of chunks
+%! f = tempname ();
+%! x = int32(reshape(1:6e4, 200, 300));
+%! h5create(f,'/D1',size(x),'Datatype','int32','ChunkSize',[30 40], ...
+%!          'Deflate',4,'Shuffle',true,'Fletcher32',true);
+%! h5write(f,'/D1',x);
+%! assert (h5read(f,'/D1','Threads',4), x);
+%! assert (h5read(f,'/D1',[5 7],[50 60],[3 4],'Threads',3), ...
+%!         x(5:3:152, 7:4:243));
+%! assert (h5read(f,'/D1','Threads',4,'OutputType','double'), double(x));
+%! n = h5threads();
+%! h5threads(2);
+%! assert (h5threads(), 2);
+%! assert (h5read(f,'/D1',[1 1],[200 1]), x(:,1));
+%! h5threads(n);
+%! fail ("h5read (f, '/D1', 'Threads', 1.5)", "Threads");
+%! delete (f);
+
+%!error <positive integer> h5threads (0)
+
+%!test
+%! # parallel compression of whole chunks
+%! f = tempname ();
+%! x = reshape(1:6.3e4, 210, 300);
+%! h5create(f,'/D1',size(x),'ChunkSize',[40 50],'Deflate',6,'Shuffle',true);
+%! h5write(f,'/D1',x,'Threads',4);
+%! assert (h5read(f,'/D1','Threads',1), x);
+%! # chunk-aligned block and an edge block
+%! y = -x(41:120, 51:200);
+%! h5write(f,'/D1',y,[41 51],size(y),'Threads',3);
+%! x(41:120, 51:200) = y;
+%! assert (h5read(f,'/D1'), x);
+%! h5write(f,'/D1',x(161:210, 251:300),[161 251],[50 50],'Threads',2);
+%! # unaligned block, written by HDF5
+%! h5write(f,'/D1',zeros(10),[3 3],[10 10],'Threads',2);
+%! x(3:12, 3:12) = 0;
+%! assert (h5read(f,'/D1'), x);
+%! fail ("h5write (f, '/D1', 1, [1 1], [1 1], 'Threads', -1)", "Threads");
+%! delete (f);
+
+%!test
+%! # parallel writes pad the partial edge chunks with the fill value
+%! f = tempname ();
+%! h5create(f,'/D1',[10 Inf],'ChunkSize',[10 4],'Deflate',1,'FillValue',-1);
+%! h5write(f,'/D1',ones(10,6),[1 1],[10 6],'Threads',2);
+%! h5write(f,'/D1',2*ones(10,1),[1 9],[10 1]);
+%! assert (h5read(f,'/D1'), [ones(10,6) -ones(10,2) 2*ones(10,1)]);
+%! delete (f);
+
+%!test
+%! # point and mask selections
+%! f = tempname ();
+%! x = reshape(1:120, 4, 5, 6);
+%! h5create(f,'/D1',size(x));
+%! h5write(f,'/D1',x);
+%! P = [4 5 6; 1 1 1; 2 3 4; 1 1 1];
+%! assert (h5read(f,'/D1',P), x(sub2ind(size(x), P(:,1), P(:,2), P(:,3))));
+%! m = mod(x, 7) < 3;
+%! assert (h5read(f,'/D1',m), x(m));
+%! assert (h5read(f,'/D1',false(size(x))), zeros(0,1));
+%! h5write(f,'/D1',[-1 -2],[2 2 2; 3 3 3]);
+%! h5write(f,'/D1',zeros(1,nnz(m)),m);
+%! x(2,2,2) = -1; x(3,3,3) = -2; x(m) = 0;
+%! assert (h5read(f,'/D1'), x);
+%! fail ("h5read (f, '/D1', [5 1 1])", "beyond the dataset's size");
+%! fail ("h5read (f, '/D1', [1 1])", "one column per dataset dimension");
+%! fail ("h5read (f, '/D1', true(4,5))", "same size as the dataset");
+%! fail ("h5write (f, '/D1', [1 2 3], [1 1 1; 2 2 2])", "number of elements");
+%! fail ("h5read (f, '/D1', {1})", "point coordinates");
+%! # 1-D dataset
+%! h5create(f,'/D2',20,'Datatype','int16');
+%! h5write(f,'/D2',int16(1:20));
+%! assert (h5read(f,'/D2',[3; 1; 20]), int16([3; 1; 20]));
+%! assert (h5read(f,'/D2',[1 7]), int16(7));
+%! assert (h5read(f,'/D2',mod(1:20,3)==0), int16(3:3:18)');
+%! delete (f);
+
+%!test
+%! # reading from a memory mapping
+%! f = tempname ();
+%! x = reshape(1:2400, 20, 30, 4);
+%! h5create(f,'/D1',size(x));
+%! h5write(f,'/D1',x);
+%! assert (h5read(f,'/D1','MMap',true), x);
+%! assert (h5read(f,'/D1',[2 3 1],[5 6 2],[3 4 2],'MMap',true), ...
+%!         x(2:3:14, 3:4:23, 1:2:3));
+%! assert (h5read(f,'/D1',[1 1 2],[20 30 1],'MMap',true,'OutputType','int16'), ...
+%!         int16(x(:,:,2)));
+%! # updated data are seen through the mapping
+%! h5write(f,'/D1',-x(:,:,4),[1 1 4],[20 30 1]);
+%! assert (h5read(f,'/D1',[1 1 4],[20 30 1],'MMap',true), -x(:,:,4));
+%! # chunked datasets fall back to HDF5
+%! y = int32(reshape(1:6e3, 20, 300));
+%! h5create(f,'/D2',size(y),'Datatype','int32','ChunkSize',[20 40],'Deflate',1);
+%! h5write(f,'/D2',y);
+%! assert (h5read(f,'/D2','MMap',true), y);
+%! fail ("h5read (f, '/D1', 'MMap', 'yes')", "MMap");
+%! delete (f);
+
+%!test
+%! # appending blocks to an extendable dataset
+%! f = tempname ();
+%! h5create(f,'/D1',[3 Inf],'ChunkSize',[3 4]);
+%! h5create(f,'/D2',Inf,'Datatype','int32','ChunkSize',8);
+%! h5open(f,'r+');
+%! x = reshape(1:30, 3, 10);
+%! for k = 1:10
+%!   h5append(f,'/D1',x(:,k));
+%!   h5append(f,'/D2',int32(1:k));
+%! endfor
+%! # readers see the logical size only
+%! assert (h5read(f,'/D1'), x);
+%! assert (h5read(f,'/D1',[1 9],[3 2]), x(:,9:10));
+%! assert (h5info(f,'/D1').Dataspace.Size, [3 10]);
+%! assert (isempty (h5info(f,'/D1').Attributes));
+%! assert (numel (h5read(f,'/D2')), 55);
+%! # the datasets are trimmed on h5flush
+%! h5flush(f);
+%! h5close(f);
+%! assert (h5info(f,'/D1').Dataspace.Size, [3 10]);
+%! assert (h5read(f,'/D2'), int32(cell2mat(arrayfun(@(k) 1:k, 1:10, 'UniformOutput', false))));
+%! # appending to a file that is not open
+%! h5append(f,'/D1',x(:,1:2)*10);
+%! assert (h5read(f,'/D1'), [x x(:,1:2)*10]);
+%! fail ("h5append (f, '/D1', zeros(4,1))", "size of dataset");
+%! h5create(f,'/D3',[4 5]);
+%! fail ("h5append (f, '/D3', zeros(4,5))", "cannot be extended");
+%! delete (f);
+
+%!test
+%! # streaming blocks through a h5writer handle
+%! f = tempname ();
+%! h5create(f,'/D1',[4 Inf],'ChunkSize',[4 8],'Datatype','int16');
+%! x = int16(reshape(1:200, 4, 50));
+%! w = h5writer(f,'/D1');
+%! for k = 1:5:46
+%!   w.write(x(:,k:k+4),[1 k]);
+%! endfor
+%! # a block of another size
+%! w.write(x(:,1),[1 50]);
+%! w.close();
+%! x(:,50) = x(:,1);
+%! assert (h5read(f,'/D1'), x);
+%! assert (h5info(f,'/D1').Dataspace.Size, [4 50]);
+%! # the data are flushed when the handle is cleared
+%! w = h5writer(f,'/D1');
+%! w.write(-x(:,1:2),[1 51]);
+%! clear w
+%! assert (h5read(f,'/D1',[1 49],[4 4]), [x(:,49:50) -x(:,1:2)]);
+%! fail ("h5writer (f, '/none')", "not exist");
+%! h5create(f,'/D2',[4 5 6]);
+%! fail ("w = h5writer (f, '/D2'); w.write (zeros (4,5), [1 1 7])", "non-extensible");
+%! fail ("w = h5writer (f, '/D2'); w.close (); w.write (zeros (4,5), [1 1 1])", "closed");
+%! delete (f);
+
+%!test
+%! # asynchronous writes
+%! f = tempname ();
+%! h5create(f,'/D1',[100 Inf],'ChunkSize',[100 10]);
+%! x = rand(100, 200);
+%! h = zeros(1, 20);
+%! for k = 1:20
+%!   y = x(:,10*k-9:10*k);
+%!   h(k) = h5write(f,'/D1',y,[1 10*k-9],[100 10],'Async',true);
+%!   y(:) = 0; # the queued data are not affected
+%! endfor
+%! h5wait(h(1));
+%! h5flush(f);
+%! assert (h5read(f,'/D1'), x);
+%! # the data and the selection are checked by h5write itself,
+%! # and nothing is queued then
+%! fail ("h5write (f, '/D1', zeros(3,3), [1 1], [4 4], 'Async', true)", "incompatible");
+%! fail ("h5write (f, '/D2', 1, 'Async', true)", "does not exist");
+%! h5wait ();
+%! h5flush (f);
+%! # a large compressed write, with the data changed after the submit
+%! h5create(f,'/D2',[1e3 2e3],'Deflate',9,'ChunkSize',[1e3 100]);
+%! x = rand(1e3, 2e3);
+%! y = x;
+%! h = h5write(f,'/D2',y,'Async',true);
+%! y(:) = 0;
+%! h5wait(h);
+%! assert (h5read(f,'/D2'), x);
+%! h5close(f);
+%! assert (h5read(f,'/D2'), x);
+%! delete (f);
+
+%!test
+%! n = h5writequeue ();
+%! h5writequeue (1e6);
+%! assert (h5writequeue (), 1e6);
+%! h5writequeue (n);
+
+%!error <positive integer> h5wait (0)
+%!error <queue size> h5writequeue (-1)
+%!error <queue size> h5writequeue (Inf)
+%!error <queue size> h5writequeue (NaN)
+%!error <queue size> h5writequeue (1.5)
+
+%!test
+%! # reading a dataset in chunk-aligned blocks
+%! f = tempname ();
+%! x = reshape(1:6000, 20, 300);
+%! h5create(f,'/D1',size(x),'ChunkSize',[20 40]);
+%! h5write(f,'/D1',x);
+%! it = h5blocks(f,'/D1',2,50); # rounded up to 80
+%! y = [];
+%! k = 1;
+%! while it.hasNext()
+%!   [b, start] = it.next();
+%!   assert (start, [1 k]);
+%!   assert (columns(b), min(80, 301-k));
+%!   y = [y b];
+%!   k += columns(b);
+%! endwhile
+%! assert (y, x);
+%! # along the first dimension, of a contiguous dataset
+%! h5create(f,'/D2',size(x),'Datatype','int32');
+%! h5write(f,'/D2',int32(x));
+%! it = h5blocks(f,'/D2',1,7);
+%! y = [];
+%! while it.hasNext()
+%!   y = [y; it.next()];
+%! endwhile
+%! assert (y, int32(x));
+%! it.close();
+%! assert (! it.hasNext());
+%! h5create(f,'/D3',[4 5 6]);
+%! fail ("it = h5blocks (f, '/D3', 3, 6); it.next (); it.next ()", "no more blocks");
+%! fail ("h5blocks (f, '/D3', 4)", "dimensions");
+%! delete (f);
+
+%!test
+%! # single-element and complex blocks, with h5flush between blocks
+%! f = tempname ();
+%! z = complex(1:5, [0 1 0 2 0]);
+%! h5create(f,'/D1',[1 5],'Datatype','double complex','ChunkSize',[1 1]);
+%! h5write(f,'/D1',z);
+%! it = h5blocks(f,'/D1',2,1);
+%! for k=1:5
+%!   h5flush(f);
+%!   assert (it.next(), z(k));
+%! endfor
+%! it.close();
+%! delete (f);
+
+%!test
+%! # data in the row-major order of the file
+%! f = tempname ();
+%! x = reshape(1:24, 2, 3, 4);
+%! h5create(f,'/D1',size(x),'Transpose',true);
+%! h5write(f,'/D1',x,'Transpose',true);
+%! assert (h5read(f,'/D1'), permute(x, [3 2 1]));
+%! assert (h5read(f,'/D1','Transpose',true), x);
+%! assert (h5read(f,'/D1',[2 1 2],[1 3 2],'Transpose',true), x(2,:,2:3));
+%! assert (h5read(f,'/D1',[1 2 3; 2 3 4],'Transpose',true), [x(1,2,3); x(2,3,4)]);
+%! # a frame with a leading singleton dimension
+%! h5write(f,'/D1',zeros(1,3,4),[2 1 1],[1 3 4],'Transpose',true);
+%! x(2,:,:) = 0;
+%! assert (h5read(f,'/D1','Transpose',true), x);
+%! # compressed chunks, stored transposed by the decoding threads
+%! y = rand(50, 60, 7);
+%! h5create(f,'/D2',size(y),'Transpose',true,'ChunkSize',[10 20 7],'Deflate',1);
+%! h5write(f,'/D2',y,'Transpose',true);
+%! assert (h5read(f,'/D2','Transpose',true,'Threads',3), y);
+%! assert (h5read(f,'/D2',[3 5 2],[20 30 4],[2 1 1],'Transpose',true,'Threads',2), ...
+%!         y(3:2:41,5:34,2:5));
+%! s = {"a", "bb", "ccc"; "d", "ee", "fff"};
+%! h5create(f,'/D3',size(s),'Datatype','string','Transpose',true);
+%! h5write(f,'/D3',s,'Transpose',true);
+%! assert (h5read(f,'/D3'), s.');
+%! assert (h5read(f,'/D3','Transpose',true), s);
+%! fail ("h5read (f, '/D1', 'Transpose', 'yes')", "Transpose");
+%! delete (f);
+
+%!error <Transpose> h5create (tempname (), '/D1', [2 3], 'Transpose', [1 1])
+
+%!test
+%! # strings as a char matrix, and in batches
+%! f = tempname ();
+%! s = {"one", "δύο", ""; "four", "five", "sixsixsix"};
+%! h5create(f,'/S1',size(s),'Datatype','string');
+%! h5write(f,'/S1',s);
+%! assert (h5read(f,'/S1'), s);
+%! assert (h5read(f,'/S1','TextType','char'), char(s(:)));
+%! assert (h5read(f,'/S1',[1 2],[2 2],'TextType','char'), char(s(:,2:3)(:)));
+%! n = 1e5 + 7;
+%! c = arrayfun(@(k) sprintf("%d", k), 1:n, 'UniformOutput', false);
+%! h5create(f,'/S2',[1 n],'Datatype','string');
+%! h5write(f,'/S2',c);
+%! assert (h5read(f,'/S2'), c);
+%! assert (h5read(f,'/S2',[1 3],[1 n-3],[1 1]), c(3:n-1));
+%! assert (h5read(f,'/S2','TextType','char'), char(c));
+%! fail ("h5read (f, '/S1', 'TextType', 'string')", "TextType");
+%! delete (f);
+
+%!test
+%! # compound datasets are read as structs of columns; Octave stores
+%! # complex arrays as compounds of 'real' and 'imag' members
+%! f = tempname ();
+%! z = [1+2i, 3-4i, 5; 6i, 7, 8-9i];
+%! h5wait (); # save does not wait for the writes of other tests
+%! save ('-hdf5', f, 'z');
+%! info = h5info (f, '/z/value');
+%! assert (info.Datatype.OctaveClass, 'struct');
+%! assert (info.Datatype.Fields, {'real', 'imag'});
+%! assert (h5read (f, '/z/value'), struct ('real', real (z), 'imag', imag (z)));
+%! assert (h5read (f, '/z/value', 'Fields', 'imag'), struct ('imag', imag (z)));
+%! assert (h5read (f, '/z/value', 'Fields', {'imag', 'real'}), ...
+%!         struct ('imag', imag (z), 'real', real (z)));
+%! assert (h5read (f, '/z/value', [1 2], [2 2], 'Fields', {'real'}), ...
+%!         struct ('real', real (z(:,2:3))));
+%! assert (h5read (f, '/z/value', [2 1; 1 3]), struct ('real', [0; 5], 'imag', [6; 0]));
+%! fail ("h5read (f, '/z/value', 'Fields', {'r'})", "no field 'r'");
+%! fail ("h5read (f, '/z/value', 'Fields', 1)", "Fields");
+%! h5create(f,'/D1',[2 2]);
+%! fail ("h5read (f, '/D1', 'Fields', {'a'})", "compound");
+%! delete (f);
+
+%!test
+%! # typed fill values and the allocation policy
+%! f = tempname ();
+%! h5create(f,'/D1',[4 5],'Datatype','int16','FillValue',-7);
+%! h5write(f,'/D1',int16([1 2; 3 4]),[1 1],[2 2]);
+%! x = repmat(int16(-7),4,5);
+%! x(1:2,1:2) = [1 2; 3 4];
+%! assert (h5read(f,'/D1'), x);
+%! assert (h5info(f,'/D1').FillValue, int16(-7));
+%! h5create(f,'/D2',[10 10],'FillValue',NaN,'ChunkSize',[5 5],'AllocTime','early','FillTime','alloc');
+%! assert (all (isnan (h5read(f,'/D2')(:))));
+%! assert (isnan (h5info(f,'/D2').FillValue));
+%! h5create(f,'/D3',[3 1],'Datatype','single complex','FillValue',1-2i);
+%! assert (h5read(f,'/D3'), single([1-2i; 1-2i; 1-2i]));
+%! h5create(f,'/D4',[1 3],'Datatype','string','FillValue','n/a');
+%! h5write(f,'/D4',{'a'},[1 2],[1 1]);
+%! assert (h5read(f,'/D4'), {'n/a', 'a', 'n/a'});
+%! assert (h5info(f,'/D4').FillValue, 'n/a');
+%! h5create(f,'/D5',[2 2]);
+%! assert (h5info(f,'/D5').FillValue, 0);
+%! h5create(f,'/D6',[1e4 1e4],'Datatype','uint8','AllocTime','late','FillTime','never');
+%! h5write(f,'/D6',uint8(5),[3 4],[1 1]);
+%! assert (h5read(f,'/D6',[3 4],[1 1]), uint8(5));
+%! delete (f);
+
+%!error <FillValue> h5create (tempname (), '/D1', [2 3], 'FillValue', [1 2])
+%!error <FillValue> h5create (tempname (), '/D1', [2 3], 'Datatype', 'string', 'FillValue', 1)
+%!error <complex> h5create (tempname (), '/D1', [2 3], 'FillValue', 1i)
+%!error <AllocTime> h5create (tempname (), '/D1', [2 3], 'AllocTime', 'now')
+%!error <FillTime> h5create (tempname (), '/D1', [2 3], 'FillTime', 'always')
+%!error <string> h5create (tempname (), '/D1', [2 3], 'Datatype', 'string', 'FillTime', 'never')
+
+%!test
+%! # file creation properties
+%! f = tempname ();
+%! h5create(f,'/G1/G2/D1',[3 4],'FileSpaceStrategy','page','FileSpacePageSize',16384, ...
+%!          'LatestFormat',true,'MetadataBlockSize',65536,'LinkCreationOrder',true);
+%! h5write(f,'/G1/G2/D1',magic(4)(1:3,:));
+%! h5close(f);
+%! # objects added after re-opening the file
+%! h5create(f,'/G1/D2',[1 10],'Datatype','int32','LinkCreationOrder',true);
+%! h5write(f,'/G1/D2',int32(1:10));
+%! h5close(f);
+%! assert (h5read(f,'/G1/G2/D1'), magic(4)(1:3,:));
+%! assert (h5read(f,'/G1/D2'), int32(1:10));
+%! assert (h5ls(f,'/G1'), {'D2'; 'G2'});
+%! delete (f);
+
+%!error <FileSpaceStrategy> h5create (tempname (), '/D1', [2 3], 'FileSpaceStrategy', 'paged')
+%!error <FileSpacePageSize> h5create (tempname (), '/D1', [2 3], 'FileSpacePageSize', 4096)
+%!error <FileSpacePageSize> h5create (tempname (), '/D1', [2 3], 'FileSpaceStrategy', 'page', 'FileSpacePageSize', 100)
+%!error <LatestFormat> h5create (tempname (), '/D1', [2 3], 'LatestFormat', 'yes')
+%!error <MetadataBlockSize> h5create (tempname (), '/D1', [2 3], 'MetadataBlockSize', -1)
+
+%!test
+%! # page buffer and metadata cache of files opened read-only
+%! f = tempname ();
+%! h5create(f,'/D1',[1 10],'FileSpaceStrategy','page');
+%! h5write(f,'/D1',1:10);
+%! h5close(f);
+%! old = h5fileaccess ();
+%! unwind_protect
+%!   h5fileaccess('PageBufferSize',2^20,'MetadataCacheSize',[2^16 2^20]);
+%!   s = h5fileaccess ();
+%!   assert (s.PageBufferSize, 2^20);
+%!   assert (s.MetadataCacheSize, [2^16 2^20]);
+%!   assert (h5read(f,'/D1'), 1:10);
+%!   st = h5filestats(f,'reset');
+%!   assert (st.PageBuffer.Accesses(1) > 0);
+%!   assert (st.MetadataCache.MaxSize <= 2^20);
+%!   assert (h5filestats(f).PageBuffer.Accesses, [0 0]);
+%! unwind_protect_cleanup
+%!   h5fileaccess('PageBufferSize',old.PageBufferSize,'MetadataCacheSize',old.MetadataCacheSize, ...
+%!                'EvictOnClose',old.EvictOnClose);
+%! end_unwind_protect
+%! h5close(f);
+%! # a single file, re-opened with the new settings
+%! fail ("h5open (f, 'r', 'PageSize', 1)", "invalid option");
+%! h5open(f,'r','PageBufferSize',2^16,'EvictOnClose',true);
+%! assert (h5read(f,'/D1',[1 3],[1 2]), [3 4]);
+%! assert (isstruct (h5filestats(f).PageBuffer));
+%! h5close(f);
+%! assert (isempty (h5filestats(f).PageBuffer));
+%! h5close(f);
+%! # files without paged aggregation are read without a page buffer
+%! g = tempname ();
+%! h5create(g,'/D1',[1 10]);
+%! h5close(g);
+%! h5open(g,'r','PageBufferSize',2^16);
+%! assert (h5read(g,'/D1'), zeros(1,10));
+%! assert (isempty (h5filestats(g).PageBuffer));
+%! h5close(g);
+%! delete (f);
+%! delete (g);
+
+%!error <PageBufferSize> h5fileaccess ('PageBufferSize', -1)
+%!error <MetadataCacheSize> h5fileaccess ('MetadataCacheSize', [2^20 2^16])
+%!error <invalid option> h5fileaccess ('PageSize', 1)
+
+%!test
+%! # SWMR: another Octave process appends while this one reads
+%! f = tempname ();
+%! h5create(f,'/D1',[4 Inf],'ChunkSize',[4 16],'LatestFormat',true);
+%! h5close(f);
+%! octave = fullfile (OCTAVE_HOME (), "bin", "octave-cli");
+%! if (! exist (octave, "file"))
+%!   octave = "octave-cli";
+%! endif
+%! code = sprintf (["addpath('%s','%s'); h5open('%s','r+','SWMR',true); " ...
+%!                  "fclose(fopen('%s.ready','w')); " ...
+%!                  "for k=1:50, h5append('%s','/D1',k*ones(4,1)); pause(0.02); end; " ...
+%!                  "h5close('%s');"], ...
+%!                 fileparts (which ("h5append")), fileparts (which ("__h5append__")), ...
+%!                 f, f, f, f);
+%! system (sprintf ('"%s" -q --no-gui --eval "%s" &', octave, code));
+%! t0 = tic;
+%! while (! exist ([f ".ready"], "file") && toc (t0) < 60)
+%!   pause (0.05);
+%! endwhile
+%! h5open(f,'r','SWMR',true);
+%! n = 0;
+%! while (n < 50 && toc (t0) < 60)
+%!   n = h5info(f,'/D1').Dataspace.Size(2);
+%!   if (n > 0)
+%!     x = h5read(f,'/D1',[1 1],[4 n]);
+%!     assert (x, repmat(1:n, 4, 1));
+%!   endif
+%!   pause (0.01);
+%! endwhile
+%! h5close(f);
+%! assert (n, 50);
+%! delete ([f ".ready"]);
+%! delete (f);
+
+%!test
+%! # SWMR writing requires the latest file format
+%! f = tempname ();
+%! h5create(f,'/D1',[1 Inf]);
+%! h5close(f);
+%! fail ("h5open (f, 'r+', 'SWMR', true)", "SWMR");
+%! assert (h5info(f,'/D1').Dataspace.Size, [1 0]);
+%! delete (f);
+
+%!test
+%! # files in memory, and their file images
+%! f = "mem://h5test";
+%! x = int32([1 2 3; 4 5 6]);
+%! h5create(f,'/G1/D1',size(x),'Datatype','int32');
+%! h5write(f,'/G1/D1',x);
+%! h5writeatt(f,'/G1','a',1.5);
+%! assert (h5read(f,'/G1/D1'), x);
+%! assert (h5info(f,'/G1/D1').Dataspace.Size, [2 3]);
+%! [~, files] = h5filecache ();
+%! assert (any (strcmp (files, f)));
+%! bytes = h5serialize(f);
+%! assert (class (bytes), "uint8");
+%! assert (bytes(1:8), uint8([137 72 68 70 13 10 26 10]));
+%! h5close(f);
+%! fail ("h5read (f, '/G1/D1')", "does not exist");
+%! # a writable copy of the image
+%! g = h5deserialize(bytes);
+%! assert (strncmp (g, "mem://", 6));
+%! assert (h5read(g,'/G1/D1'), x);
+%! assert (h5readatt(g,'/G1','a'), 1.5);
+%! h5write(g,'/G1/D1',-x);
+%! assert (h5read(g,'/G1/D1'), -x);
+%! # the image is the file as stored on disk
+%! d = tempname ();
+%! fid = fopen(d,'w');
+%! fwrite(fid,h5serialize(g));
+%! fclose(fid);
+%! h5close(g);
+%! assert (h5read(d,'/G1/D1'), -x);
+%! h = h5deserialize(h5serialize(d),"mem://copy");
+%! assert (h, "mem://copy");
+%! assert (h5readatt(h,'/G1','a'), 1.5);
+%! h5close(h);
+%! delete (d);
+
+%!error <uint8> h5deserialize (1:10)
+%!error <mem://> h5deserialize (uint8 (1:10), "image")
+%!error <h5deserialize> h5deserialize (uint8 (1:10))
+
+%!test
+%! # files read into memory with the core driver
+%! f = tempname ();
+%! h5create(f,'/D1',[1 10]);
+%! h5write(f,'/D1',1:10);
+%! h5close(f);
+%! h5open(f,'r','Core',true);
+%! assert (h5read(f,'/D1'), 1:10);
+%! h5close(f);
+%! # and written back on h5close
+%! h5open(f,'r+','Core',true);
+%! h5write(f,'/D1',11:20);
+%! assert (h5read(f,'/D1'), 11:20);
+%! h5close(f);
+%! assert (h5read(f,'/D1'), 11:20);
+%! fail ("h5open (f, 'r+', 'SWMR', true, 'Core', true)", "cannot be combined");
+%! delete (f);